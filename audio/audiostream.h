@@ -97,6 +97,16 @@ public:
 	 * By default, this maps to endOfData().
 	 */
 	virtual bool endOfStream() const { return endOfData(); }
+
+	/**
+	 * Check whether readBuffer() may be called from a worker thread of the
+	 * mixer, while other streams are read at the same time.
+	 *
+	 * This is only the case for streams that never call back into engine
+	 * code and do not share any state with other streams, so it is false
+	 * by default.
+	 */
+	virtual bool isThreadSafe() const { return false; }
 };
 
 /**
@@ -177,6 +187,7 @@ public:
 
 	bool isStereo() const { return _parent->isStereo(); }
 	int getRate() const { return _parent->getRate(); }
+	bool isThreadSafe() const { return _parent->isThreadSafe(); }
 
 	uint getCompleteIterations() const { return _completeIterations; }
 	void setRemainingIterations(uint loops) { _loops = _completeIterations + loops; }
@@ -310,6 +321,7 @@ public:
 
 	bool isStereo() const { return _parent->isStereo(); }
 	int getRate() const { return _parent->getRate(); }
+	bool isThreadSafe() const { return _parent->isThreadSafe(); }
 
 	uint getCompleteIterations() const { return _completeIterations; }
 	void setRemainingIterations(uint loops) { _loops = _completeIterations + loops; }
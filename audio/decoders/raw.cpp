@@ -40,7 +40,9 @@ template<int bytesPerSample, bool isUnsigned, bool isLE>
 class RawStream : public SeekableAudioStream {
 public:
 	RawStream(int rate, bool stereo, DisposeAfterUse::Flag disposeStream, Common::SeekableReadStream *stream)
-		: _rate(rate), _isStereo(stereo), _playtime(0, rate), _stream(stream, disposeStream), _endOfData(false), _buffer(nullptr) {
+		: _rate(rate), _isStereo(stereo), _playtime(0, rate), _stream(stream, disposeStream), _endOfData(false), _buffer(nullptr),
+		  // Data in memory can be read from any thread, files and sub streams might be shared
+		  _threadSafe(dynamic_cast<Common::MemoryReadStream *>(stream) != nullptr) {
 		// Setup our buffer for readBuffer
 		_buffer = new byte[kSampleBufferLength * bytesPerSample];
 		assert(_buffer);
@@ -60,6 +62,7 @@ public:
 
 	int getRate() const override         { return _rate; }
 	Timestamp getLength() const override { return _playtime; }
+	bool isThreadSafe() const override   { return _threadSafe; }
 
 	bool seek(const Timestamp &where) override;
 private:
@@ -70,6 +73,7 @@ private:
 	bool _endOfData;                                           ///< Whether the stream end has been reached
 
 	byte *_buffer;                                             ///< Buffer used in readBuffer
+	const bool _threadSafe;                                    ///< Whether the data is read from memory
 	enum {
 		/**
 		 * How many samples we can buffer at once.
@@ -21,6 +21,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -42,7 +43,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality);
 	~Channel();
 
 	/**
@@ -68,6 +69,12 @@ public:
 	 */
 	bool isPermanent() const { return _permanent; }
 
+	/**
+	 * Queries whether the channel can be mixed on a worker thread, see
+	 * AudioStream::isThreadSafe.
+	 */
+	bool isThreadSafe() const { return _stream->isThreadSafe(); }
+
 	/**
 	 * Returns the id of the channel.
 	 */
@@ -197,17 +204,42 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _stateMutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _resamplerQuality(kResamplerLinear), _parallelMixing(false), _scratchBuffers(nullptr), _scratchSize(0), _threadPool(nullptr), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
 
 	assert(sampleRate > 0);
 
+	if (ConfMan.get("audio_resampler", Common::ConfigManager::kApplicationDomain) == "sinc")
+		_resamplerQuality = kResamplerSinc;
+
+	// Parallel mixing is opt-in since it costs a summing pass. Only streams
+	// flagged as thread safe are mixed on the workers, everything else (like
+	// emulated MIDI, which locks the mixer) stays on the mixing thread
+	if (ConfMan.hasKey("audio_parallel_mixing", Common::ConfigManager::kApplicationDomain))
+		_parallelMixing = ConfMan.getBool("audio_parallel_mixing", Common::ConfigManager::kApplicationDomain);
+
+	if (_parallelMixing) {
+		// The buffers are allocated here, the mixing thread must not wait
+		// for the allocator
+		_scratchSize = (_outBufSize ? _outBufSize : (uint)DEFAULT_SCRATCH_FRAMES) * (_stereo ? 2 : 1);
+		_scratchBuffers = new int16[NUM_CHANNELS * _scratchSize];
+		_threadPool = new Common::ThreadPool();
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = nullptr;
 }
 
 MixerImpl::~MixerImpl() {
+	// Make sure channels still waiting in the command queue are freed too
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	reclaimChannels();
+
+	delete[] _scratchBuffers;
+	delete _threadPool;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -231,7 +263,7 @@ uint MixerImpl::getOutputBufSize() const {
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == nullptr) {
+		if (!_channelStates[i].active) {
 			index = i;
 			break;
 		}
@@ -242,17 +274,137 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
 	chan->setHandle(chanHandle);
 	_handleSeed++;
+
+	ChannelState &state = _channelStates[index];
+	state.active = true;
+	state.handle = chanHandle._val;
+	state.id = chan->getId();
+	state.type = chan->getType();
+	state.permanent = chan->isPermanent();
+	state.volume = chan->getVolume();
+	state.balance = chan->getBalance();
+	state.rate = chan->getRate();
+	state.streamRate = state.rate;
+
+	queueCommand(Command::kInsert, chanHandle._val, 0, chan);
+
 	if (handle)
 		*handle = chanHandle;
 }
 
+int MixerImpl::findChannelState(SoundHandle handle) {
+	reclaimChannels();
+
+	const int index = handle._val % NUM_CHANNELS;
+	if (!_channelStates[index].active || _channelStates[index].handle != handle._val)
+		return -1;
+
+	return index;
+}
+
+void MixerImpl::queueCommand(Command::Type type, uint32 handle, int32 value, Channel *channel) {
+	Command cmd;
+	cmd.type = type;
+	cmd.handle = handle;
+	cmd.channel = channel;
+	cmd.value = value;
+
+	while (!_commands.push(cmd)) {
+		// The mixing thread is not keeping up (or not running at all), so
+		// apply the pending commands here. Note that _mutex must always
+		// be locked before _stateMutex.
+		_stateMutex.unlock();
+		{
+			Common::StackLock lock(_mutex);
+			processCommands();
+		}
+		_stateMutex.lock();
+	}
+}
+
+void MixerImpl::processCommands() {
+	Command cmd;
+	while (_commands.pop(cmd)) {
+		const int index = cmd.handle % NUM_CHANNELS;
+
+		if (cmd.type == Command::kInsert) {
+			// The slot is needed right away, so the previous channel cannot
+			// wait for the next pass if the retire queue is full
+			if (_channels[index] && !retireChannel(index))
+				delete _channels[index];
+			_channels[index] = cmd.channel;
+			continue;
+		}
+
+		if (cmd.type == Command::kUpdateVolumes) {
+			for (int i = 0; i != NUM_CHANNELS; ++i) {
+				if (_channels[i] && _channels[i]->getType() == (SoundType)cmd.value)
+					_channels[i]->notifyGlobalVolChange();
+			}
+			continue;
+		}
+
+		// Ignore commands for sounds that already terminated
+		Channel *chan = _channels[index];
+		if (!chan || chan->getHandle()._val != cmd.handle)
+			continue;
+
+		switch (cmd.type) {
+		case Command::kSetVolume:
+			chan->setVolume(cmd.value);
+			break;
+		case Command::kSetBalance:
+			chan->setBalance(cmd.value);
+			break;
+		case Command::kSetRate:
+			chan->setRate(cmd.value);
+			break;
+		case Command::kResetRate:
+			chan->resetRate();
+			break;
+		case Command::kPause:
+			chan->pause(cmd.value != 0);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+bool MixerImpl::retireChannel(int index) {
+	// The retire queue can hold twice the number of slots, so it can only
+	// overflow when the engine side did not touch the mixer for a long time.
+	// Keep the channel around until the next pass in that case.
+	if (!_retiredChannels.push(_channels[index]))
+		return false;
+
+	_channels[index] = nullptr;
+	return true;
+}
+
+void MixerImpl::reclaimChannels() {
+	Channel *chan;
+	while (_retiredChannels.pop(chan)) {
+		const uint32 handle = chan->getHandle()._val;
+		ChannelState &state = _channelStates[handle % NUM_CHANNELS];
+		if (state.active && state.handle == handle)
+			state.active = false;
+
+		delete chan;
+	}
+}
+
+void MixerImpl::deleteChannel(int index) {
+	delete _channels[index];
+	_channels[index] = nullptr;
+	_channelStates[index].active = false;
+}
+
 void MixerImpl::playStream(
 			SoundType type,
 			SoundHandle *handle,
@@ -261,7 +413,7 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
 	if (stream == nullptr) {
 		warning("stream is 0");
@@ -271,10 +423,12 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	reclaimChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != nullptr && _channels[i]->getId() == id) {
+			if (_channelStates[i].active && _channelStates[i].id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -292,7 +446,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -320,13 +474,18 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 		len >>= 1;
 	}
 
+	// apply the channel operations queued since the last pass
+	processCommands();
+
+	if (_parallelMixing && len * (_stereo ? 2 : 1) <= _scratchSize)
+		return mixChannelsParallel(buf, len);
+
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
+				retireChannel(i);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
 
@@ -338,46 +497,102 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	return res;
 }
 
+int MixerImpl::mixChannelsParallel(int16 *buf, uint len) {
+	const uint numSamples = len * (_stereo ? 2 : 1);
+
+	uint numJobs = 0, numParallelJobs = 0;
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_channels[i]) {
+			if (_channels[i]->isFinished()) {
+				retireChannel(i);
+			} else if (!_channels[i]->isPaused()) {
+				MixJob &job = _mixJobs[numJobs];
+				job.channel = _channels[i];
+				job.buffer = _scratchBuffers + numJobs * _scratchSize;
+				job.len = len;
+				job.result = 0;
+				memset(job.buffer, 0, numSamples * sizeof(int16));
+				if (job.channel->isThreadSafe())
+					_parallelJobs[numParallelJobs++] = &job;
+				else
+					runMixJob(job);
+				numJobs++;
+			}
+		}
+
+	runMixJobs(_parallelJobs, numParallelJobs);
+
+	// sum up the channels, in the same order as the serial mixing does
+	int res = 0;
+	for (uint i = 0; i < numJobs; i++) {
+		const int16 *in = _mixJobs[i].buffer;
+		const uint count = _mixJobs[i].result * (_stereo ? 2 : 1);
+		for (uint j = 0; j < count; j++)
+			buf[j] = (int16)CLIP<int32>(buf[j] + in[j], -32768, 32767);
+
+		if (_mixJobs[i].result > res)
+			res = _mixJobs[i].result;
+	}
+
+	return res;
+}
+
+void MixerImpl::runMixJobs(MixJob **jobs, uint numJobs) {
+	_threadPool->parallelFor(numJobs, [jobs](uint i) { runMixJob(*jobs[i]); });
+}
+
+void MixerImpl::runMixJob(MixJob &job) {
+	job.result = job.channel->mix(job.buffer, job.len);
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	Common::StackLock stateLock(_stateMutex);
+
+	processCommands();
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		if (_channels[i] != nullptr && !_channels[i]->isPermanent())
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock stateLock(_stateMutex);
+
+	processCommands();
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		if (_channels[i] != nullptr && _channels[i]->getId() == id)
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock stateLock(_stateMutex);
+
+	processCommands();
+	reclaimChannels();
 
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	deleteChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_stateMutex);
 	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	queueCommand(Command::kUpdateVolumes, 0, type);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -386,67 +601,77 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelStates[index].volume = volume;
+	queueCommand(Command::kSetVolume, handle._val, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelStates[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelStates[index].balance = balance;
+	queueCommand(Command::kSetBalance, handle._val, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelStates[index].balance;
 }
 
 void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setRate(rate);
+	_channelStates[index].rate = rate;
+	queueCommand(Command::kSetRate, handle._val, rate);
 }
 
 uint32 MixerImpl::getChannelRate(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return 0;
-	
-	return _channels[index]->getRate();
+
+	return _channelStates[index].rate;
 }
 
 void MixerImpl::resetChannelRate(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
-	
-	_channels[index]->resetRate();
+
+	_channelStates[index].rate = _channelStates[index].streamRate;
+	queueCommand(Command::kResetRate, handle._val);
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -456,6 +681,10 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
+	// The elapsed time is tracked by the mixing thread, so make sure the
+	// channel has been inserted already
+	processCommands();
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return Timestamp(0, _sampleRate);
@@ -466,6 +695,10 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 void MixerImpl::loopChannel(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
+	// Replacing the stream allocates memory, so do it right here instead
+	// of queuing it for the mixing thread
+	processCommands();
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
@@ -474,71 +707,81 @@ void MixerImpl::loopChannel(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
+
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr) {
-			_channels[i]->pause(paused);
-		}
+		if (_channelStates[i].active)
+			queueCommand(Command::kPause, _channelStates[i].handle, paused);
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
+
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+		if (_channelStates[i].active && _channelStates[i].id == id) {
+			queueCommand(Command::kPause, _channelStates[i].handle, paused);
 			return;
 		}
 	}
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannelState(handle) == -1)
 		return;
 
-	_channels[index]->pause(paused);
+	queueCommand(Command::kPause, handle._val, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_channelStates[i].active && _channelStates[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannelState(handle);
+	if (index == -1)
+		return 0;
+
+	return _channelStates[index].id;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannelState(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
+
+	reclaimChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channelStates[i].active && _channelStates[i].type == type)
 			return true;
 	return false;
 }
@@ -552,13 +795,10 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 	_soundTypeSettings[type].volume = volume;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	queueCommand(Command::kUpdateVolumes, 0, type);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -573,7 +813,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
@@ -582,7 +822,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
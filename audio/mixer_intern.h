@@ -23,11 +23,16 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
+#include "common/threadpool.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
+class Channel;
+
 /**
  * @defgroup audio_mixer_intern Mixer implementation
  * @ingroup audio
@@ -36,9 +41,67 @@ namespace Audio {
  * @{
  */
 
+/**
+ * Fixed size, lock-free ring buffer for exactly one producer and one
+ * consumer thread.
+ *
+ * The producer only ever writes _tail and the consumer only ever writes
+ * _head, so no lock is required as long as each side is serialized.
+ * If several threads may act as producer (or consumer), they have to be
+ * serialized by the caller.
+ */
+template<typename T, uint N>
+class MixerRingBuffer {
+public:
+	MixerRingBuffer() : _head(0), _tail(0) {}
+
+	/**
+	 * Append an item. Must only be called by the producer.
+	 *
+	 * @return false if the buffer is full, true otherwise.
+	 */
+	bool push(const T &item) {
+		const uint32 tail = _tail;
+		if (tail - Common::atomicLoadAcquire(_head) == N)
+			return false;
+
+		_items[tail % N] = item;
+		Common::atomicStoreRelease(_tail, tail + 1);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest item. Must only be called by the consumer.
+	 *
+	 * @return false if the buffer is empty, true otherwise.
+	 */
+	bool pop(T &item) {
+		const uint32 head = _head;
+		if (Common::atomicLoadAcquire(_tail) == head)
+			return false;
+
+		item = _items[head % N];
+		Common::atomicStoreRelease(_head, head + 1);
+		return true;
+	}
+
+private:
+	T _items[N];
+	volatile uint32 _head;
+	volatile uint32 _tail;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
+ * Channel operations issued by the engine (playStream, setChannelVolume,
+ * pauseHandle, ...) do not block on the mixing thread: they are queued in
+ * a lock-free command ring and applied at the start of the next mixing pass.
+ * Channels that finished playing are handed back through a second ring and
+ * deleted on the engine side, so mixCallback() never frees memory.
+ * Stopping a sound still synchronizes with the mixing thread, since callers
+ * rely on the stream not being accessed anymore once stopHandle() returns.
+ *
  * Backends are responsible for allocating (and later releasing) an instance
  * of this class, which engines can access via OSystem::getMixer().
  *
@@ -58,14 +121,97 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		NUM_COMMANDS = 256,
+		/** Scratch buffer size for parallel mixing if the backend does not tell its buffer size. */
+		DEFAULT_SCRATCH_FRAMES = 4096
+	};
+
+	/**
+	 * A channel operation queued by the engine side, which is applied by
+	 * the mixing thread.
+	 */
+	struct Command {
+		enum Type {
+			kInsert,
+			kSetVolume,
+			kSetBalance,
+			kSetRate,
+			kResetRate,
+			kPause,
+			kUpdateVolumes
+		};
+
+		Type type;
+		uint32 handle;
+		Channel *channel;
+		int32 value;
+	};
+
+	/**
+	 * The engine side view of a channel slot. Only accessed while holding
+	 * _stateMutex, so queries never have to wait for the mixing thread.
+	 */
+	struct ChannelState {
+		ChannelState() : active(false), handle(0), id(-1), type(kPlainSoundType), permanent(false), volume(0), balance(0), rate(0), streamRate(0) {}
+
+		bool active;
+		uint32 handle;
+		int id;
+		SoundType type;
+		bool permanent;
+		byte volume;
+		int8 balance;
+		uint32 rate;
+		uint32 streamRate;
+	};
+
+	/**
+	 * Mixing a single channel into its own scratch buffer. Jobs for thread
+	 * safe streams do not share any state, so they can run concurrently.
+	 */
+	struct MixJob {
+		Channel *channel;
+		int16 *buffer;
+		uint len;
+		int result;
 	};
 
+	/** Held by the mixing thread for the whole mixing pass. */
 	Common::Mutex _mutex;
 
+	/**
+	 * Serializes the engine side (engine and timer threads). It is never
+	 * taken by the mixing thread itself. When both are needed, _mutex has
+	 * to be locked first.
+	 */
+	Common::Mutex _stateMutex;
+
+	/** Commands from the engine side to the mixing thread. */
+	MixerRingBuffer<Command, NUM_COMMANDS> _commands;
+	/** Finished channels from the mixing thread, to be deleted by the engine side. */
+	MixerRingBuffer<Channel *, NUM_CHANNELS * 2> _retiredChannels;
+
+	ChannelState _channelStates[NUM_CHANNELS];
+
 	const uint _sampleRate;
 	const bool _stereo;
 	const uint _outBufSize;
+	/** Resampler used for new channels, see the "audio_resampler" setting. */
+	ResamplerQuality _resamplerQuality;
+	/** Whether channels are mixed separately and summed, see the "audio_parallel_mixing" setting. */
+	bool _parallelMixing;
+	/**
+	 * Per channel scratch buffers for parallel mixing, _scratchSize samples
+	 * each. Larger passes are mixed serially.
+	 */
+	int16 *_scratchBuffers;
+	uint _scratchSize;
+	MixJob _mixJobs[NUM_CHANNELS];
+	/** The jobs of _mixJobs which may run on the workers. */
+	MixJob *_parallelJobs[NUM_CHANNELS];
+	/** Workers running the mix jobs, only created for parallel mixing. */
+	Common::ThreadPool *_threadPool;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -139,6 +285,48 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Reclaim retired channels and look up the slot of an active handle.
+	 * Requires _stateMutex.
+	 *
+	 * @return the slot index, or -1 if the handle is not active anymore.
+	 */
+	int findChannelState(SoundHandle handle);
+
+	/**
+	 * Queue a command for the mixing thread. Requires _stateMutex, which
+	 * might be released temporarily when the queue is full.
+	 */
+	void queueCommand(Command::Type type, uint32 handle, int32 value = 0, Channel *channel = nullptr);
+
+	/** Apply all queued commands. Requires _mutex. */
+	void processCommands();
+
+	/**
+	 * Mix the active channels into separate scratch buffers and sum those
+	 * into the output. Requires _mutex, and len must fit in the buffers.
+	 *
+	 * @return the largest number of frames mixed by a channel.
+	 */
+	int mixChannelsParallel(int16 *buf, uint len);
+
+	/** Run the given mix jobs, possibly concurrently, and wait for them to finish. */
+	void runMixJobs(MixJob **jobs, uint numJobs);
+	static void runMixJob(MixJob &job);
+
+	/**
+	 * Hand the channel in the given slot over to the engine side. Requires _mutex.
+	 *
+	 * @return false if the retire queue is full, in which case the channel stays in its slot.
+	 */
+	bool retireChannel(int index);
+
+	/** Delete channels retired by the mixing thread. Requires _stateMutex. */
+	void reclaimChannels();
+
+	/** Delete the channel in the given slot right away. Requires _mutex and _stateMutex. */
+	void deleteChannel(int index);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
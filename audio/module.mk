@@ -23,6 +23,7 @@ MODULE_OBJS := \
 	mt32gm.o \
 	musicplugin.o \
 	null.o \
+	pcm_cache.o \
 	rate.o \
 	timestamp.o \
 	decoders/3do.o \
@@ -112,5 +113,18 @@ MODULE_OBJS += \
 	rwopl3.o
 endif
 
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	rate_neon.o
+endif
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	rate_sse2.o
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	rate_avx2.o
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/pcm_cache.h"
+#include "audio/audiostream.h"
+
+#include "common/atomic.h"
+#include "common/textconsole.h"
+
+namespace Audio {
+
+enum {
+	/** Buffer size for clips of unknown length, which is grown as needed */
+	kInitialClipSamples = 16 * 1024
+};
+
+/**
+ * A decoded clip, shared by the cache and all streams playing it.
+ *
+ * Streams are deleted by whichever thread finishes with them, so the
+ * reference count is updated atomically.
+ */
+struct PCMCacheBuffer {
+	PCMCacheBuffer(int16 *data_, uint32 numSamples_, int rate_, bool stereo_) :
+		data(data_), numSamples(numSamples_), rate(rate_), stereo(stereo_), refCount(1) {}
+
+	~PCMCacheBuffer() {
+		free(data);
+	}
+
+	void incRef() {
+		Common::atomicIncrement(refCount);
+	}
+
+	void decRef() {
+		const int32 count = Common::atomicDecrement(refCount);
+		if (count == 0)
+			delete this;
+	}
+
+	uint32 size() const { return numSamples * sizeof(int16); }
+
+	int16 *const data;
+	const uint32 numSamples;
+	const int rate;
+	const bool stereo;
+	volatile int32 refCount;
+};
+
+/**
+ * Plays a clip from its cached buffer.
+ */
+class PCMCacheStream : public SeekableAudioStream {
+public:
+	PCMCacheStream(PCMCacheBuffer *buffer) : _buffer(buffer), _pos(0) {
+		_buffer->incRef();
+	}
+
+	~PCMCacheStream() {
+		_buffer->decRef();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const uint32 count = MIN<uint32>(numSamples, _buffer->numSamples - _pos);
+		memcpy(buffer, _buffer->data + _pos, count * sizeof(int16));
+		_pos += count;
+		return count;
+	}
+
+	bool isStereo() const override { return _buffer->stereo; }
+	int getRate() const override { return _buffer->rate; }
+	bool endOfData() const override { return _pos >= _buffer->numSamples; }
+
+	bool seek(const Timestamp &where) override {
+		const uint32 pos = convertTimeToStreamPos(where, getRate(), isStereo()).totalNumberOfFrames();
+		if (pos > _buffer->numSamples) {
+			_pos = _buffer->numSamples;
+			return false;
+		}
+
+		_pos = pos;
+		return true;
+	}
+
+	Timestamp getLength() const override {
+		return Timestamp(0, _buffer->numSamples / (_buffer->stereo ? 2 : 1), _buffer->rate);
+	}
+
+	bool isThreadSafe() const override { return true; }
+
+private:
+	PCMCacheBuffer *_buffer;
+	uint32 _pos;
+};
+
+PCMCache::PCMCache(uint32 memoryBudget, uint32 maxClipSize) :
+	_memoryBudget(memoryBudget), _maxClipSize(MIN(maxClipSize, memoryBudget)), _memoryUsage(0), _hits(0), _misses(0) {
+}
+
+PCMCache::~PCMCache() {
+	clear();
+}
+
+SeekableAudioStream *PCMCache::getStream(const Common::String &key) {
+	EntryMap::iterator entry = _entries.find(key);
+	if (entry == _entries.end()) {
+		_misses++;
+		return nullptr;
+	}
+
+	_hits++;
+
+	// Move the clip to the front of the LRU list
+	_lru.erase(entry->_value.lruPos);
+	_lru.push_front(key);
+	entry->_value.lruPos = _lru.begin();
+
+	return new PCMCacheStream(entry->_value.buffer);
+}
+
+SeekableAudioStream *PCMCache::addStream(const Common::String &key, SeekableAudioStream *stream) {
+	assert(stream);
+
+	// Stereo clips are read in whole frames
+	const uint32 frameSize = stream->isStereo() ? 2 : 1;
+	const uint32 maxSamples = _maxClipSize / sizeof(int16) / frameSize * frameSize;
+
+	// The length is only a hint, some decoders do not know it or deliver
+	// less. Still, clips announced as too long are rejected before decoding.
+	const uint32 lengthSamples = stream->getLength().totalNumberOfFrames() * frameSize;
+	if (lengthSamples > maxSamples)
+		return stream;
+
+	uint32 capacity = lengthSamples ? lengthSamples : MIN<uint32>((uint32)kInitialClipSamples, maxSamples);
+	int16 *data = (int16 *)malloc(MAX<uint32>(capacity, 1) * sizeof(int16));
+	if (!data) {
+		warning("PCMCache::addStream: Could not allocate %d bytes for '%s'", capacity * (int)sizeof(int16), key.c_str());
+		return stream;
+	}
+
+	uint32 numSamples = 0;
+	while (!stream->endOfData()) {
+		if (numSamples == capacity) {
+			if (capacity >= maxSamples)
+				break;
+
+			capacity = MIN<uint32>(MAX<uint32>(capacity * 2, frameSize), maxSamples);
+			int16 *newData = (int16 *)realloc(data, capacity * sizeof(int16));
+			if (!newData)
+				break;
+			data = newData;
+		}
+
+		const int count = stream->readBuffer(data + numSamples, capacity - numSamples);
+		if (count <= 0)
+			break;
+		numSamples += count;
+	}
+
+	// The clip is too long, or the decoder failed. Hand the stream back
+	// for normal playback.
+	if (!stream->endOfData()) {
+		free(data);
+		if (!stream->rewind())
+			warning("PCMCache::addStream: Could not rewind '%s'", key.c_str());
+		return stream;
+	}
+
+	// Only keep the memory actually used, which is what the budget is charged
+	if (numSamples < capacity) {
+		int16 *newData = (int16 *)realloc(data, MAX<uint32>(numSamples, 1) * sizeof(int16));
+		if (newData)
+			data = newData;
+	}
+
+	PCMCacheBuffer *buffer = new PCMCacheBuffer(data, numSamples, stream->getRate(), stream->isStereo());
+	delete stream;
+
+	EntryMap::iterator old = _entries.find(key);
+	if (old != _entries.end())
+		removeEntry(old);
+
+	evict(buffer->size());
+
+	_lru.push_front(key);
+	Entry &entry = _entries[key];
+	entry.buffer = buffer;
+	entry.lruPos = _lru.begin();
+	_memoryUsage += buffer->size();
+
+	return new PCMCacheStream(buffer);
+}
+
+void PCMCache::clear() {
+	while (!_entries.empty())
+		removeEntry(_entries.begin());
+}
+
+void PCMCache::evict(uint32 neededSize) {
+	while (!_lru.empty() && _memoryUsage + neededSize > _memoryBudget)
+		removeEntry(_entries.find(_lru.back()));
+}
+
+void PCMCache::removeEntry(EntryMap::iterator entry) {
+	assert(entry != _entries.end());
+
+	_memoryUsage -= entry->_value.buffer->size();
+	_lru.erase(entry->_value.lruPos);
+	entry->_value.buffer->decRef();
+	_entries.erase(entry);
+}
+
+} // End of namespace Audio
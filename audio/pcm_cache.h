@@ -0,0 +1,125 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_PCM_CACHE_H
+#define AUDIO_PCM_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
+#include "common/str.h"
+
+namespace Audio {
+/**
+ * @defgroup audio_pcm_cache PCM cache
+ * @ingroup audio
+ *
+ * @brief Cache of decoded short sounds.
+ * @{
+ */
+
+class SeekableAudioStream;
+struct PCMCacheBuffer;
+
+/**
+ * A cache of fully decoded sounds, meant for short compressed effects
+ * which are played over and over again (footsteps, clicks, ...).
+ *
+ * Each clip is decoded once into a PCM buffer. Every playback then gets
+ * a lightweight stream reading from that buffer, instead of a new decoder.
+ * When the cached clips exceed the memory budget, the least recently
+ * played ones are dropped. Buffers still being played are kept alive by
+ * their streams, so eviction never affects running sounds.
+ *
+ * The cache itself has to be used from a single thread, typically the
+ * engine thread. The streams it returns can be played and deleted from
+ * any thread, including the mixer.
+ */
+class PCMCache {
+public:
+	/**
+	 * @param memoryBudget  Maximum size of all cached clips, in bytes.
+	 * @param maxClipSize   Clips whose decoded size exceeds this many bytes are not cached.
+	 */
+	PCMCache(uint32 memoryBudget = 4 * 1024 * 1024, uint32 maxClipSize = 256 * 1024);
+	~PCMCache();
+
+	/**
+	 * Get a stream for a cached clip.
+	 *
+	 * @param key  Identifier of the clip's source, e.g. the resource name and number.
+	 *
+	 * @return A new stream playing the clip, or nullptr if the clip is not cached.
+	 */
+	SeekableAudioStream *getStream(const Common::String &key);
+
+	/**
+	 * Decode a clip into the cache.
+	 *
+	 * The stream is decoded from its start to its end. Clips which are too
+	 * long to be cached, or which fail to decode, are returned rewound.
+	 *
+	 * @param key     Identifier of the clip's source.
+	 * @param stream  The decoder for the clip, which is taken over by the cache.
+	 *
+	 * @return A stream playing the clip.
+	 */
+	SeekableAudioStream *addStream(const Common::String &key, SeekableAudioStream *stream);
+
+	/** Check whether a clip is cached, without touching its LRU state. */
+	bool contains(const Common::String &key) const { return _entries.contains(key); }
+
+	/** Drop all cached clips. Streams still being played stay valid. */
+	void clear();
+
+	/** Size of all cached clips, in bytes. */
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+
+private:
+	typedef Common::List<Common::String> LRUList;
+
+	struct Entry {
+		PCMCacheBuffer *buffer;
+		LRUList::iterator lruPos;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void evict(uint32 neededSize);
+	void removeEntry(EntryMap::iterator entry);
+
+	const uint32 _memoryBudget;
+	const uint32 _maxClipSize;
+	uint32 _memoryUsage;
+	uint32 _hits, _misses;
+
+	EntryMap _entries;
+	/** Keys of the cached clips, the most recently used first. */
+	LRUList _lru;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
@@ -29,21 +29,47 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/mixer.h"
+#include "common/singleton.h"
+#include "common/system.h"
 #include "common/util.h"
 
 namespace Audio {
+class SincFilterTables;
+}
 
-/**
- * The default fractional type in frac.h (with 16 fractional bits) limits
- * the rate conversion code to 65536Hz audio: we need to able to handle
- * 96kHz audio, so we use fewer fractional bits in this code.
- */
-enum {
-	FRAC_BITS_LOW = 15,
-	FRAC_ONE_LOW = (1L << FRAC_BITS_LOW),
-	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
-};
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterTables);
+}
+
+namespace Audio {
+
+void setupRateKernelsGeneric(RateKernels &kernels) {
+	SETUP_RATE_MIX_KERNELS(kernels, mixGeneric);
+	kernels.interpolate = interpolateGeneric;
+	kernels.dotProduct = dotProductGeneric;
+}
+
+void setupRateKernels(RateKernels &kernels) {
+	setupRateKernelsGeneric(kernels);
+
+	// The vectorized kernels only deal with signed output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+		setupRateKernelsNEON(kernels);
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+		setupRateKernelsSSE2(kernels);
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+		setupRateKernelsAVX2(kernels);
+#endif
+#endif
+}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
 class RateConverter_Impl : public RateConverter {
@@ -76,6 +102,18 @@ private:
 	/** Current sample(s) in the input stream (left/right channel) */
 	st_sample_t _inCurL, _inCurR;
 
+	/** Block of resampled frames, waiting to be mixed into the output */
+	st_sample_t _mixBuffer[512];
+
+	/** Interpolation inputs for the frames in _mixBuffer */
+	st_sample_t _interpLast[512];
+	st_sample_t _interpCur[512];
+	uint16 _interpFrac[512];
+
+	/** Kernels doing the actual sample processing */
+	RateKernels::MixFunc _mix;
+	RateKernels::InterpolateFunc _interpolate;
+
 	int copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
 	int simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
 	int interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
@@ -112,30 +150,19 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStr
 				return (outBuffer - outStart) / (outStereo ? 2 : 1);
 		}
 
-		// Mix the data into the output buffer
-		st_sample_t inL, inR;
-		inL = *_bufferPos++;
-		inR = (inStereo ? *_bufferPos++ : inL);
-		_bufferSize -= (inStereo ? 2 : 1);
-
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// Output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// Output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+		// Mix as many frames as both buffers allow in one go
+		const uint numFrames = MIN<uint>((outEnd - outBuffer) / (outStereo ? 2 : 1), _bufferSize / (inStereo ? 2 : 1));
+		if (numFrames == 0) {
+			// Drop an incomplete stereo frame
+			_bufferSize = 0;
+			continue;
+		}
 
-			outBuffer += 2;
-		} else {
-			// Output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
+		_mix(outBuffer, _bufferPos, numFrames, volL, volR);
 
-			outBuffer += 1;
-		}
+		_bufferPos += numFrames * (inStereo ? 2 : 1);
+		_bufferSize -= numFrames * (inStereo ? 2 : 1);
+		outBuffer += numFrames * (outStereo ? 2 : 1);
 	}
 
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
@@ -152,50 +179,51 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
 
 	while (outBuffer < outEnd) {
-		// Read enough input samples so that _outPos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (_bufferSize == 0) {
-				_bufferPos = _buffer;
-				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
-
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
-			}
-
-			_bufferSize -= (inStereo ? 2 : 1);
-			_outPos--;
-
-			if (_outPos >= 0) {
-				_bufferPos += (inStereo ? 2 : 1);
-			}
-		} while (_outPos >= 0);
-
-		st_sample_t inL, inR;
-		inL = *_bufferPos++;
-		inR = (inStereo ? *_bufferPos++ : inL);
-
-		// Increment output position
-		_outPos += outPos_inc;
-
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+		// Collect a block of frames in the mix buffer
+		const uint maxFrames = MIN<uint>((outEnd - outBuffer) / (outStereo ? 2 : 1), ARRAYSIZE(_mixBuffer) / 2);
+		st_sample_t *mixPos = _mixBuffer;
+		uint numFrames = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// Read enough input samples so that _outPos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (_bufferSize == 0) {
+					_bufferPos = _buffer;
+					_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+
+					if (_bufferSize <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+
+				_bufferSize -= (inStereo ? 2 : 1);
+				_outPos--;
+
+				if (_outPos >= 0) {
+					_bufferPos += (inStereo ? 2 : 1);
+				}
+			} while (_outPos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*mixPos++ = *_bufferPos++;
+			if (inStereo)
+				*mixPos++ = *_bufferPos++;
 
-		if (outStereo) {
-			// output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+			// Increment output position
+			_outPos += outPos_inc;
+			numFrames++;
+		}
 
-			outBuffer += 2;
-		} else {
-			// output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
+		_mix(outBuffer, _mixBuffer, numFrames, volL, volR);
+		outBuffer += numFrames * (outStereo ? 2 : 1);
 
-			outBuffer += 1;
-		}
+		if (endOfInput)
+			break;
 	}
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
 }
@@ -210,61 +238,70 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
 
 	while (outBuffer < outEnd) {
-		// Read enough input samples so that _outPosFrac < 0
-		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
-			// Check if we have to refill the buffer
-			if (_bufferSize == 0) {
-				_bufferPos = _buffer;
-				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
-
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
-			}
-
-			_bufferSize -= (inStereo ? 2 : 1);
-			_inLastL = _inCurL;
-			_inCurL = *_bufferPos++;
-
-			if (inStereo) {
-				_inLastR = _inCurR;
-				_inCurR = *_bufferPos++;
+		// Collect the interpolation inputs for a block of frames
+		const uint maxFrames = MIN<uint>((outEnd - outBuffer) / (outStereo ? 2 : 1), ARRAYSIZE(_mixBuffer) / 2);
+		uint numFrames = 0;
+		uint numSamplesQueued = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// Read enough input samples so that _outPosFrac < 0
+			while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
+				// Check if we have to refill the buffer
+				if (_bufferSize == 0) {
+					_bufferPos = _buffer;
+					_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+
+					if (_bufferSize <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+
+				_bufferSize -= (inStereo ? 2 : 1);
+				_inLastL = _inCurL;
+				_inCurL = *_bufferPos++;
+
+				if (inStereo) {
+					_inLastR = _inCurR;
+					_inCurR = *_bufferPos++;
+				}
+
+				_outPosFrac -= FRAC_ONE_LOW;
 			}
 
-			_outPosFrac -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the _outPos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && outBuffer < outEnd) {
-			// Interpolate
-			st_sample_t inL, inR;
-			inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			inR = (inStereo ?
-						(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						inL);
+			if (endOfInput)
+				break;
 
-			st_sample_t outL, outR;
-			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-			if (outStereo) {
-				// Output left channel
-				clampedAdd(outBuffer[reverseStereo    ], outL);
+			// Loop as long as the _outPos trails behind, and as long as there is
+			// still space in the block.
+			while (_outPosFrac < (frac_t)FRAC_ONE_LOW && numFrames < maxFrames) {
+				_interpLast[numSamplesQueued] = _inLastL;
+				_interpCur[numSamplesQueued] = _inCurL;
+				_interpFrac[numSamplesQueued] = _outPosFrac;
+				numSamplesQueued++;
 
-				// Output right channel
-				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+				if (inStereo) {
+					_interpLast[numSamplesQueued] = _inLastR;
+					_interpCur[numSamplesQueued] = _inCurR;
+					_interpFrac[numSamplesQueued] = _outPosFrac;
+					numSamplesQueued++;
+				}
 
-				outBuffer += 2;
-			} else {
-				// Output mono channel
-				clampedAdd(outBuffer[0], (outL + outR) / 2);
+				numFrames++;
 
-				outBuffer += 1;
+				// Increment output position
+				_outPosFrac += outPos_inc;
 			}
-
-			// Increment output position
-			_outPosFrac += outPos_inc;
 		}
+
+		// Interpolate and mix the whole block
+		_interpolate(_mixBuffer, _interpLast, _interpCur, _interpFrac, numSamplesQueued);
+		_mix(outBuffer, _mixBuffer, numFrames, volL, volR);
+		outBuffer += numFrames * (outStereo ? 2 : 1);
+
+		if (endOfInput)
+			break;
 	}
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
 }
@@ -280,7 +317,13 @@ RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_ra
 	_inCurL(0),
 	_inCurR(0),
 	_bufferSize(0),
-	_bufferPos(nullptr) {}
+	_bufferPos(nullptr) {
+
+	RateKernels kernels;
+	setupRateKernels(kernels);
+	_mix = kernels.mix[inStereo][outStereo][reverseStereo];
+	_interpolate = kernels.interpolate;
+}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
@@ -297,7 +340,287 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream
 	}
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+#pragma mark -
+#pragma mark --- Windowed-sinc resampler ---
+#pragma mark -
+
+enum {
+	/** The fractional input position is rounded to one of this many filter phases */
+	SINC_PHASE_BITS = 8,
+	SINC_PHASES = (1 << SINC_PHASE_BITS),
+
+	/** Filter length when upsampling; downsampling uses multiples of this */
+	SINC_TAPS = 16,
+	SINC_MAX_TAPS = 64,
+
+	/** Precision of the filter coefficients */
+	SINC_COEF_BITS = 14,
+
+	/** Size of the per channel input history */
+	SINC_HISTORY_SIZE = 1024
+};
+
+/**
+ * Holds the polyphase tables of the windowed-sinc resampler. There is one
+ * table per filter length, shared by all converters.
+ *
+ * All the tables are built along with the singleton, which the first
+ * converter creates on the engine side. A rate change on the mixing thread
+ * can switch a converter to another length, so the tables have to be
+ * read-only by then.
+ */
+class SincFilterTables : public Common::Singleton<SincFilterTables> {
+public:
+	SincFilterTables() {
+		for (int i = 0; i < ARRAYSIZE(_tables); ++i) {
+			const uint numTaps = (i + 1) * SINC_TAPS;
+			_tables[i] = new int16[SINC_PHASES * numTaps];
+			buildTable(_tables[i], numTaps);
+		}
+	}
+
+	~SincFilterTables() {
+		for (int i = 0; i < ARRAYSIZE(_tables); ++i)
+			delete[] _tables[i];
+	}
+
+	/**
+	 * Get the filter table for the given length, holding SINC_PHASES rows
+	 * of @p numTaps coefficients each.
+	 */
+	const int16 *getTable(uint numTaps) const {
+		assert(numTaps % SINC_TAPS == 0 && numTaps <= SINC_MAX_TAPS);
+		return _tables[numTaps / SINC_TAPS - 1];
+	}
+
+private:
+	/**
+	 * Compute the table of a Blackman windowed sinc low-pass filter. Longer
+	 * filters are used for downsampling, so their cutoff is lowered in the
+	 * same proportion.
+	 */
+	static void buildTable(int16 *table, uint numTaps) {
+		// Leave some room for the transition band below the Nyquist frequency
+		const double cutoff = 0.45 * SINC_TAPS / numTaps;
+		const double halfWidth = numTaps / 2;
+		double coefs[SINC_MAX_TAPS];
+
+		for (uint phase = 0; phase < SINC_PHASES; ++phase) {
+			const double offset = (double)phase / SINC_PHASES;
+			double sum = 0.0;
+
+			for (uint i = 0; i < numTaps; ++i) {
+				// Distance of the tap from the interpolated position
+				const double t = (double)i - (halfWidth - 1) - offset;
+				const double x = t / halfWidth;
+				const double window = 0.42 + 0.5 * cos(M_PI * x) + 0.08 * cos(2 * M_PI * x);
+				const double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2 * M_PI * cutoff * t) / (M_PI * t);
+
+				coefs[i] = sinc * window;
+				sum += coefs[i];
+			}
+
+			// Normalize every phase to unity gain, putting the rounding
+			// error into the tap closest to the interpolated position
+			int16 *row = table + phase * numTaps;
+			int total = 0;
+			for (uint i = 0; i < numTaps; ++i) {
+				row[i] = (int16)floor(coefs[i] / sum * (1 << SINC_COEF_BITS) + 0.5);
+				total += row[i];
+			}
+			row[numTaps / 2 - 1 + (phase >= SINC_PHASES / 2 ? 1 : 0)] += (1 << SINC_COEF_BITS) - total;
+		}
+	}
+
+	int16 *_tables[SINC_MAX_TAPS / SINC_TAPS];
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+private:
+	/** Input and output rates */
+	st_rate_t _inRate, _outRate;
+
+	/** The intermediate input cache */
+	st_sample_t _buffer[512];
+
+	/** Deinterleaved input samples (left/right channel) around the current position */
+	st_sample_t _history[2][SINC_HISTORY_SIZE];
+
+	/** Number of valid samples in the history */
+	uint _historySize;
+
+	/** Index of the input sample at or right before the current position */
+	uint _historyPos;
+
+	/** Fractional part of the current position */
+	frac_t _posFrac;
+
+	/** The filter matching the current rates */
+	const int16 *_filter;
+	uint _numTaps;
+
+	/** Block of resampled frames, waiting to be mixed into the output */
+	st_sample_t _mixBuffer[512];
+
+	RateKernels::MixFunc _mix;
+	RateKernels::DotProductFunc _dotProduct;
+
+	void updateFilter();
+	bool fillHistory(AudioStream &input);
+
+public:
+	SincRateConverter(st_rate_t inputRate, st_rate_t outputRate);
+	virtual ~SincRateConverter() {}
+
+	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
+
+	void setInputRate(st_rate_t inputRate) override { _inRate = inputRate; updateFilter(); }
+	void setOutputRate(st_rate_t outputRate) override { _outRate = outputRate; updateFilter(); }
+
+	st_rate_t getInputRate() const override { return _inRate; }
+	st_rate_t getOutputRate() const override { return _outRate; }
+
+	bool needsDraining() const override { return _historyPos + _numTaps / 2 < _historySize; }
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+SincRateConverter<inStereo, outStereo, reverseStereo>::SincRateConverter(st_rate_t inputRate, st_rate_t outputRate) :
+	_inRate(inputRate),
+	_outRate(outputRate),
+	_posFrac(0),
+	_filter(nullptr),
+	_numTaps(0) {
+
+	RateKernels kernels;
+	setupRateKernels(kernels);
+	_mix = kernels.mix[inStereo][outStereo][reverseStereo];
+	_dotProduct = kernels.dotProduct;
+
+	// Start with silence in the left half of the filter window, so that the
+	// first output frame is centered on the first input frame
+	memset(_history, 0, sizeof(_history));
+	_historySize = SINC_MAX_TAPS / 2;
+	_historyPos = SINC_MAX_TAPS / 2;
+
+	updateFilter();
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void SincRateConverter<inStereo, outStereo, reverseStereo>::updateFilter() {
+	// When downsampling, the filter is stretched to cut off at the
+	// output's Nyquist frequency instead of the input's
+	uint numTaps = SINC_TAPS;
+	while (numTaps < SINC_MAX_TAPS && (uint64)numTaps * _outRate < (uint64)SINC_TAPS * _inRate)
+		numTaps += SINC_TAPS;
+
+	if (numTaps != _numTaps) {
+		_filter = SincFilterTables::instance().getTable(numTaps);
+		_numTaps = numTaps;
+	}
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+bool SincRateConverter<inStereo, outStereo, reverseStereo>::fillHistory(AudioStream &input) {
+	const int numSamples = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+	if (numSamples <= 0)
+		return false;
+
+	// Drop the samples which left the filter window
+	if (_historySize + ARRAYSIZE(_buffer) > SINC_HISTORY_SIZE) {
+		const uint keepFrom = MIN<uint>(_historyPos - (SINC_MAX_TAPS / 2 - 1), _historySize);
+		for (int channel = 0; channel < (inStereo ? 2 : 1); ++channel)
+			memmove(_history[channel], _history[channel] + keepFrom, (_historySize - keepFrom) * sizeof(st_sample_t));
+		_historySize -= keepFrom;
+		_historyPos -= keepFrom;
+	}
+
+	// Deinterleave the input into the history
+	const st_sample_t *in = _buffer;
+	for (int i = 0; i < numSamples; i += (inStereo ? 2 : 1)) {
+		_history[0][_historySize] = *in++;
+		if (inStereo)
+			_history[1][_historySize] = *in++;
+		_historySize++;
+	}
+
+	return true;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int SincRateConverter<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	assert(input.isStereo() == inStereo);
+
+	// How much to increment _posFrac by
+	const frac_t posInc = (_inRate << FRAC_BITS_LOW) / _outRate;
+
+	st_sample_t *outStart, *outEnd;
+	outStart = outBuffer;
+	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+
+	while (outBuffer < outEnd) {
+		const uint maxFrames = MIN<uint>((outEnd - outBuffer) / (outStereo ? 2 : 1), ARRAYSIZE(_mixBuffer) / 2);
+		st_sample_t *mixPos = _mixBuffer;
+		uint numFrames = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// Make sure the whole filter window is available
+			while (_historyPos + _numTaps / 2 >= _historySize) {
+				if (!fillHistory(input)) {
+					endOfInput = true;
+					break;
+				}
+			}
+
+			if (endOfInput)
+				break;
+
+			const int16 *taps = _filter + (_posFrac >> (FRAC_BITS_LOW - SINC_PHASE_BITS)) * _numTaps;
+			const uint start = _historyPos - (_numTaps / 2 - 1);
+
+			const int32 left = _dotProduct(_history[0] + start, taps, _numTaps) >> SINC_COEF_BITS;
+			*mixPos++ = (st_sample_t)CLIP<int32>(left, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			if (inStereo) {
+				const int32 right = _dotProduct(_history[1] + start, taps, _numTaps) >> SINC_COEF_BITS;
+				*mixPos++ = (st_sample_t)CLIP<int32>(right, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			}
+			numFrames++;
+
+			// Increment the position
+			_posFrac += posInc;
+			_historyPos += _posFrac >> FRAC_BITS_LOW;
+			_posFrac &= FRAC_ONE_LOW - 1;
+		}
+
+		_mix(outBuffer, _mixBuffer, numFrames, volL, volR);
+		outBuffer += numFrames * (outStereo ? 2 : 1);
+
+		if (endOfInput)
+			break;
+	}
+
+	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+}
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality) {
+	if (quality == kResamplerSinc && inRate != outRate) {
+		if (inStereo) {
+			if (outStereo) {
+				if (reverseStereo)
+					return new SincRateConverter<true, true, true>(inRate, outRate);
+				else
+					return new SincRateConverter<true, true, false>(inRate, outRate);
+			} else
+				return new SincRateConverter<true, false, false>(inRate, outRate);
+		} else {
+			if (outStereo) {
+				return new SincRateConverter<false, true, false>(inRate, outRate);
+			} else
+				return new SincRateConverter<false, false, false>(inRate, outRate);
+		}
+	}
+
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
@@ -104,7 +104,35 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+/**
+ * Resampling algorithms offered by makeRateConverter().
+ */
+enum ResamplerQuality {
+	/**
+	 * Sample copying, nearest neighbour or linear interpolation,
+	 * depending on the input and output rates. This is the cheapest mode.
+	 */
+	kResamplerLinear,
+
+	/**
+	 * Band-limited polyphase windowed-sinc filter. Avoids the aliasing of
+	 * the linear mode, e.g. when playing 11kHz samples at 48kHz, for
+	 * a moderately higher CPU cost.
+	 */
+	kResamplerSinc
+};
+
+/**
+ * Create a rate converter.
+ *
+ * @param inRate        Sample rate of the input stream.
+ * @param outRate       Sample rate of the output.
+ * @param inStereo      Whether the input stream is stereo.
+ * @param outStereo     Whether the output is stereo.
+ * @param reverseStereo Whether to swap the left and right channels.
+ * @param quality       Resampling algorithm to use.
+ */
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality = kResamplerLinear);
 
 /** @} */
 } // End of namespace Audio
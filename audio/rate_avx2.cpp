@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/rate_intern.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Audio {
+
+/**
+ * Compute (in * vol) / kMaxMixerVolume for sixteen samples as 32-bit values,
+ * rounding towards zero like the integer division in mixGeneric does.
+ * The results are split per 128-bit lane, like the unpack instructions do.
+ */
+static FORCEINLINE void scaleAVX2(__m256i in, __m256i vol, __m256i &lo, __m256i &hi) {
+	const __m256i prodLo = _mm256_mullo_epi16(in, vol);
+	const __m256i prodHi = _mm256_mulhi_epi16(in, vol);
+	lo = _mm256_unpacklo_epi16(prodLo, prodHi);
+	hi = _mm256_unpackhi_epi16(prodLo, prodHi);
+	lo = _mm256_srai_epi32(_mm256_add_epi32(lo, _mm256_srli_epi32(_mm256_srai_epi32(lo, 31), 24)), 8);
+	hi = _mm256_srai_epi32(_mm256_add_epi32(hi, _mm256_srli_epi32(_mm256_srai_epi32(hi, 31), 24)), 8);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+static void mixAVX2(st_sample_t *out, const st_sample_t *in, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	// For reversed stereo output the input samples are swapped below, so
+	// the volumes have to be swapped as well
+	const bool swap = outStereo && reverseStereo;
+	const __m256i vol = swap ? _mm256_set1_epi32((int32)(volR | (volL << 16)))
+	                         : _mm256_set1_epi32((int32)(volL | (volR << 16)));
+
+	uint i = 0;
+	for (; i + 8 <= numFrames; i += 8) {
+		// Load eight frames as L, R, L, R, ...
+		__m256i samples;
+		if (inStereo) {
+			samples = _mm256_loadu_si256((const __m256i *)in);
+			in += 16;
+		} else {
+			const __m128i mono = _mm_loadu_si128((const __m128i *)in);
+			samples = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(mono, mono)), _mm_unpackhi_epi16(mono, mono), 1);
+			in += 8;
+		}
+
+		if (inStereo && swap) {
+			samples = _mm256_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+			samples = _mm256_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+
+		__m256i lo, hi;
+		scaleAVX2(samples, vol, lo, hi);
+
+		if (outStereo) {
+			const __m256i result = _mm256_packs_epi32(lo, hi);
+			_mm256_storeu_si256((__m256i *)out, _mm256_adds_epi16(_mm256_loadu_si256((const __m256i *)out), result));
+			out += 16;
+		} else {
+			const __m256i left = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(lo), _mm256_castsi256_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+			const __m256i right = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(lo), _mm256_castsi256_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+
+			// Average both channels, again rounding towards zero
+			__m256i sum = _mm256_add_epi32(left, right);
+			sum = _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_srli_epi32(sum, 31)), 1);
+
+			// Packing works per lane, so gather both halves afterwards
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(sum, sum), _MM_SHUFFLE(3, 1, 2, 0));
+			const __m128i result = _mm256_castsi256_si128(packed);
+			_mm_storeu_si128((__m128i *)out, _mm_adds_epi16(_mm_loadu_si128((const __m128i *)out), result));
+			out += 8;
+		}
+	}
+
+	mixGeneric<inStereo, outStereo, reverseStereo>(out, in, numFrames - i, volL, volR);
+}
+
+static void interpolateAVX2(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	const __m256i weightMax = _mm256_set1_epi16(FRAC_ONE_LOW - 1);
+	const __m256i half = _mm256_set1_epi32(FRAC_HALF_LOW);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i l = _mm256_loadu_si256((const __m256i *)(last + i));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(cur + i));
+		const __m256i f = _mm256_loadu_si256((const __m256i *)(frac + i));
+		const __m256i w = _mm256_sub_epi16(weightMax, f);
+
+		// See interpolateSSE2 for the weight split
+		__m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(l, c), _mm256_unpacklo_epi16(w, f));
+		__m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(l, c), _mm256_unpackhi_epi16(w, f));
+		lo = _mm256_add_epi32(lo, _mm256_add_epi32(_mm256_srai_epi32(_mm256_unpacklo_epi16(l, l), 16), half));
+		hi = _mm256_add_epi32(hi, _mm256_add_epi32(_mm256_srai_epi32(_mm256_unpackhi_epi16(l, l), 16), half));
+		lo = _mm256_srai_epi32(lo, FRAC_BITS_LOW);
+		hi = _mm256_srai_epi32(hi, FRAC_BITS_LOW);
+
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_packs_epi32(lo, hi));
+	}
+
+	interpolateGeneric(out + i, last + i, cur + i, frac + i, count - i);
+}
+
+static int32 dotProductAVX2(const st_sample_t *samples, const int16 *taps, uint count) {
+	__m256i sum = _mm256_setzero_si256();
+	for (uint i = 0; i < count; i += 16) {
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(samples + i));
+		const __m256i t = _mm256_loadu_si256((const __m256i *)(taps + i));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(s, t));
+	}
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+void setupRateKernelsAVX2(RateKernels &kernels) {
+	SETUP_RATE_MIX_KERNELS(kernels, mixAVX2);
+	kernels.interpolate = interpolateAVX2;
+	kernels.dotProduct = dotProductAVX2;
+}
+
+} // End of namespace Audio
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
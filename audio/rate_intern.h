@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_RATE_INTERN_H
+#define AUDIO_RATE_INTERN_H
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * The default fractional type in frac.h (with 16 fractional bits) limits
+ * the rate conversion code to 65536Hz audio: we need to able to handle
+ * 96kHz audio, so we use fewer fractional bits in this code.
+ */
+enum {
+	FRAC_BITS_LOW = 15,
+	FRAC_ONE_LOW = (1L << FRAC_BITS_LOW),
+	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
+};
+
+/**
+ * The inner loops of the rate converters.
+ *
+ * The converters take care of reading the input stream and of stepping
+ * through it, while the actual sample processing is done in blocks by
+ * these kernels. Besides the generic C++ versions, there are SSE2, AVX2
+ * and NEON versions, which are picked at runtime. All of them have to
+ * produce bit-identical results.
+ */
+struct RateKernels {
+	/**
+	 * Scale a block of frames by the channel volumes and add it to the
+	 * output buffer, clamping the result.
+	 *
+	 * @param out       Output buffer, holding @p numFrames (stereo or mono) frames.
+	 * @param in        Input buffer, holding @p numFrames (stereo or mono) frames.
+	 * @param numFrames Number of frames to process.
+	 * @param volL      Volume for the left channel.
+	 * @param volR      Volume for the right channel.
+	 */
+	typedef void (*MixFunc)(st_sample_t *out, const st_sample_t *in, uint numFrames, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Linearly interpolate a block of samples, computing
+	 * last + (((cur - last) * frac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)
+	 * for each of them.
+	 *
+	 * @param out   Output buffer, holding @p count samples.
+	 * @param last  Previous input samples.
+	 * @param cur   Current input samples.
+	 * @param frac  Fractional positions, in the range [0, FRAC_ONE_LOW).
+	 * @param count Number of samples to process.
+	 */
+	typedef void (*InterpolateFunc)(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count);
+
+	/**
+	 * Compute the dot product of a block of samples with filter taps, as
+	 * used by the windowed-sinc resampler.
+	 *
+	 * @param samples Input samples.
+	 * @param taps    Filter coefficients.
+	 * @param count   Number of samples, must be a multiple of 16.
+	 */
+	typedef int32 (*DotProductFunc)(const st_sample_t *samples, const int16 *taps, uint count);
+
+	/** Mixing kernels, indexed by [inStereo][outStereo][reverseStereo]. */
+	MixFunc mix[2][2][2];
+	InterpolateFunc interpolate;
+	DotProductFunc dotProduct;
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void mixGeneric(st_sample_t *out, const st_sample_t *in, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	for (uint i = 0; i < numFrames; ++i) {
+		st_sample_t inL, inR;
+		inL = *in++;
+		inR = (inStereo ? *in++ : inL);
+
+		st_sample_t outL, outR;
+		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
+		if (outStereo) {
+			// Output left channel
+			clampedAdd(out[reverseStereo    ], outL);
+
+			// Output right channel
+			clampedAdd(out[reverseStereo ^ 1], outR);
+
+			out += 2;
+		} else {
+			// Output mono channel
+			clampedAdd(out[0], (outL + outR) / 2);
+
+			out += 1;
+		}
+	}
+}
+
+inline void interpolateGeneric(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	for (uint i = 0; i < count; ++i)
+		out[i] = (st_sample_t)(last[i] + (((cur[i] - last[i]) * (int)frac[i] + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+}
+
+inline int32 dotProductGeneric(const st_sample_t *samples, const int16 *taps, uint count) {
+	int32 sum = 0;
+	for (uint i = 0; i < count; ++i)
+		sum += samples[i] * taps[i];
+	return sum;
+}
+
+/** Fill all mixing kernels from a template taking <inStereo, outStereo, reverseStereo>. */
+#define SETUP_RATE_MIX_KERNELS(kernels, func) \
+	do { \
+		(kernels).mix[0][0][0] = func<false, false, false>; \
+		(kernels).mix[0][0][1] = func<false, false, true>; \
+		(kernels).mix[0][1][0] = func<false, true, false>; \
+		(kernels).mix[0][1][1] = func<false, true, true>; \
+		(kernels).mix[1][0][0] = func<true, false, false>; \
+		(kernels).mix[1][0][1] = func<true, false, true>; \
+		(kernels).mix[1][1][0] = func<true, true, false>; \
+		(kernels).mix[1][1][1] = func<true, true, true>; \
+	} while (0)
+
+/** Fill in the generic kernels. */
+void setupRateKernelsGeneric(RateKernels &kernels);
+#ifdef SCUMMVM_NEON
+void setupRateKernelsNEON(RateKernels &kernels);
+#endif
+#ifdef SCUMMVM_SSE2
+void setupRateKernelsSSE2(RateKernels &kernels);
+#endif
+#ifdef SCUMMVM_AVX2
+void setupRateKernelsAVX2(RateKernels &kernels);
+#endif
+
+/** Fill in the fastest kernels supported by the CPU. */
+void setupRateKernels(RateKernels &kernels);
+
+} // End of namespace Audio
+
+#endif
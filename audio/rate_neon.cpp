@@ -0,0 +1,155 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "audio/rate_intern.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Audio {
+
+/**
+ * Divide by kMaxMixerVolume (256), rounding towards zero like the integer
+ * division in mixGeneric does.
+ */
+static FORCEINLINE int32x4_t divideByVolumeNEON(int32x4_t x) {
+	const uint32x4_t bias = vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(x, 31)), 24);
+	return vshrq_n_s32(vaddq_s32(x, vreinterpretq_s32_u32(bias)), 8);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+static void mixNEON(st_sample_t *out, const st_sample_t *in, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	// For reversed stereo output the input samples are swapped below, so
+	// the volumes have to be swapped as well
+	const bool swap = outStereo && reverseStereo;
+	const int16x4_t vol = vreinterpret_s16_s32(vdup_n_s32((int32)(swap ? (volR | (volL << 16)) : (volL | (volR << 16)))));
+
+	uint i = 0;
+	for (; i + 4 <= numFrames; i += 4) {
+		// Load four frames as L, R, L, R, ...
+		int16x8_t samples;
+		if (inStereo) {
+			samples = vld1q_s16(in);
+			in += 8;
+		} else {
+			const int16x4_t mono = vld1_s16(in);
+			const int16x4x2_t zipped = vzip_s16(mono, mono);
+			samples = vcombine_s16(zipped.val[0], zipped.val[1]);
+			in += 4;
+		}
+
+		if (inStereo && swap)
+			samples = vrev32q_s16(samples);
+
+		const int32x4_t lo = divideByVolumeNEON(vmull_s16(vget_low_s16(samples), vol));
+		const int32x4_t hi = divideByVolumeNEON(vmull_s16(vget_high_s16(samples), vol));
+
+		if (outStereo) {
+			const int16x8_t result = vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+			vst1q_s16(out, vqaddq_s16(vld1q_s16(out), result));
+			out += 8;
+		} else {
+			const int32x4x2_t channels = vuzpq_s32(lo, hi);
+
+			// Average both channels, again rounding towards zero
+			int32x4_t sum = vaddq_s32(channels.val[0], channels.val[1]);
+			sum = vshrq_n_s32(vaddq_s32(sum, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(sum), 31))), 1);
+
+			vst1_s16(out, vqadd_s16(vld1_s16(out), vmovn_s32(sum)));
+			out += 4;
+		}
+	}
+
+	mixGeneric<inStereo, outStereo, reverseStereo>(out, in, numFrames - i, volL, volR);
+}
+
+static void interpolateNEON(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	const int16x8_t weightMax = vdupq_n_s16(FRAC_ONE_LOW - 1);
+	const int32x4_t half = vdupq_n_s32(FRAC_HALF_LOW);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const int16x8_t l = vld1q_s16(last + i);
+		const int16x8_t c = vld1q_s16(cur + i);
+		const int16x8_t f = vreinterpretq_s16_u16(vld1q_u16(frac + i));
+		const int16x8_t w = vsubq_s16(weightMax, f);
+
+		// last * (FRAC_ONE_LOW - frac) + cur * frac equals the generic
+		// formula shifted by FRAC_BITS_LOW. The weight of last is split up
+		// into (FRAC_ONE_LOW - 1 - frac) + 1, so that it fits into 16 bits.
+		int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(l), vget_low_s16(w)), vget_low_s16(c), vget_low_s16(f));
+		int32x4_t hi = vmlal_s16(vmull_s16(vget_high_s16(l), vget_high_s16(w)), vget_high_s16(c), vget_high_s16(f));
+		lo = vaddq_s32(lo, vaddq_s32(vmovl_s16(vget_low_s16(l)), half));
+		hi = vaddq_s32(hi, vaddq_s32(vmovl_s16(vget_high_s16(l)), half));
+
+		vst1q_s16(out + i, vcombine_s16(vshrn_n_s32(lo, FRAC_BITS_LOW), vshrn_n_s32(hi, FRAC_BITS_LOW)));
+	}
+
+	interpolateGeneric(out + i, last + i, cur + i, frac + i, count - i);
+}
+
+static int32 dotProductNEON(const st_sample_t *samples, const int16 *taps, uint count) {
+	int32x4_t sum = vdupq_n_s32(0);
+	for (uint i = 0; i < count; i += 8) {
+		const int16x8_t s = vld1q_s16(samples + i);
+		const int16x8_t t = vld1q_s16(taps + i);
+		sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(t));
+		sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(t));
+	}
+
+	int32x2_t sum2 = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	sum2 = vpadd_s32(sum2, sum2);
+	return vget_lane_s32(sum2, 0);
+}
+
+void setupRateKernelsNEON(RateKernels &kernels) {
+	SETUP_RATE_MIX_KERNELS(kernels, mixNEON);
+	kernels.interpolate = interpolateNEON;
+	kernels.dotProduct = dotProductNEON;
+}
+
+} // End of namespace Audio
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,161 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/rate_intern.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Audio {
+
+/**
+ * Compute (in * vol) / kMaxMixerVolume for eight samples as 32-bit values,
+ * rounding towards zero like the integer division in mixGeneric does.
+ * kMaxMixerVolume is 256, so the division is done by shifting.
+ */
+static FORCEINLINE void scaleSSE2(__m128i in, __m128i vol, __m128i &lo, __m128i &hi) {
+	const __m128i prodLo = _mm_mullo_epi16(in, vol);
+	const __m128i prodHi = _mm_mulhi_epi16(in, vol);
+	lo = _mm_unpacklo_epi16(prodLo, prodHi);
+	hi = _mm_unpackhi_epi16(prodLo, prodHi);
+	lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_srli_epi32(_mm_srai_epi32(lo, 31), 24)), 8);
+	hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_srli_epi32(_mm_srai_epi32(hi, 31), 24)), 8);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+static void mixSSE2(st_sample_t *out, const st_sample_t *in, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	// For reversed stereo output the input samples are swapped below, so
+	// the volumes have to be swapped as well
+	const bool swap = outStereo && reverseStereo;
+	const __m128i vol = swap ? _mm_setr_epi16(volR, volL, volR, volL, volR, volL, volR, volL)
+	                         : _mm_setr_epi16(volL, volR, volL, volR, volL, volR, volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= numFrames; i += 4) {
+		// Load four frames as L, R, L, R, ...
+		__m128i samples;
+		if (inStereo) {
+			samples = _mm_loadu_si128((const __m128i *)in);
+			in += 8;
+		} else {
+			samples = _mm_loadl_epi64((const __m128i *)in);
+			samples = _mm_unpacklo_epi16(samples, samples);
+			in += 4;
+		}
+
+		if (inStereo && swap) {
+			samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+			samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+
+		__m128i lo, hi;
+		scaleSSE2(samples, vol, lo, hi);
+
+		if (outStereo) {
+			const __m128i result = _mm_packs_epi32(lo, hi);
+			_mm_storeu_si128((__m128i *)out, _mm_adds_epi16(_mm_loadu_si128((const __m128i *)out), result));
+			out += 8;
+		} else {
+			const __m128i left = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+			const __m128i right = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+
+			// Average both channels, again rounding towards zero
+			__m128i sum = _mm_add_epi32(left, right);
+			sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_srli_epi32(sum, 31)), 1);
+
+			const __m128i result = _mm_packs_epi32(sum, sum);
+			_mm_storel_epi64((__m128i *)out, _mm_adds_epi16(_mm_loadl_epi64((const __m128i *)out), result));
+			out += 4;
+		}
+	}
+
+	mixGeneric<inStereo, outStereo, reverseStereo>(out, in, numFrames - i, volL, volR);
+}
+
+static void interpolateSSE2(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	const __m128i weightMax = _mm_set1_epi16(FRAC_ONE_LOW - 1);
+	const __m128i half = _mm_set1_epi32(FRAC_HALF_LOW);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i l = _mm_loadu_si128((const __m128i *)(last + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(cur + i));
+		const __m128i f = _mm_loadu_si128((const __m128i *)(frac + i));
+		const __m128i w = _mm_sub_epi16(weightMax, f);
+
+		// last * (FRAC_ONE_LOW - frac) + cur * frac equals the generic
+		// formula shifted by FRAC_BITS_LOW. The weight of last is split up
+		// into (FRAC_ONE_LOW - 1 - frac) + 1, so that it fits into 16 bits.
+		__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(l, c), _mm_unpacklo_epi16(w, f));
+		__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(l, c), _mm_unpackhi_epi16(w, f));
+		lo = _mm_add_epi32(lo, _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(l, l), 16), half));
+		hi = _mm_add_epi32(hi, _mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(l, l), 16), half));
+		lo = _mm_srai_epi32(lo, FRAC_BITS_LOW);
+		hi = _mm_srai_epi32(hi, FRAC_BITS_LOW);
+
+		_mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+	}
+
+	interpolateGeneric(out + i, last + i, cur + i, frac + i, count - i);
+}
+
+static int32 dotProductSSE2(const st_sample_t *samples, const int16 *taps, uint count) {
+	__m128i sum = _mm_setzero_si128();
+	for (uint i = 0; i < count; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		const __m128i t = _mm_loadu_si128((const __m128i *)(taps + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, t));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+void setupRateKernelsSSE2(RateKernels &kernels) {
+	SETUP_RATE_MIX_KERNELS(kernels, mixSSE2);
+	kernels.interpolate = interpolateSSE2;
+	kernels.dotProduct = dotProductSSE2;
+}
+
+} // End of namespace Audio
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
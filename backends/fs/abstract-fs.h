@@ -172,6 +172,14 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size of the file referred by this node, and the time of
+	 * its last modification. The time is only meant to be compared to other
+	 * times returned by this method, to find out whether the file changed.
+	 *
+	 * @return bool true if the information is available, false otherwise.
+	 */
+	virtual bool getFileStatus(int64 &size, int64 &modificationTime) const;
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -182,6 +190,19 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, mapping the file into memory if the backend
+	 * supports it. A mapped file which is truncated or fails to be read
+	 * crashes the process rather than causing a read error, so this is only
+	 * meant for game data.
+	 *
+	 * The default implementation returns createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream();
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to an alternate
 	 * stream of the file referred by this node. This assumes that the node
@@ -25,6 +25,12 @@
 
 #include <sys/stat.h>
 
+#ifdef HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 PosixIoStream::PosixIoStream(void *handle) :
 		StdioStream(handle) {
 }
@@ -44,3 +50,39 @@ int64 PosixIoStream::size() const {
 
 	return st.st_size;
 }
+
+#ifdef HAS_MMAP
+PosixMappedStream *PosixMappedStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	// MemoryReadStream only handles 32-bit sizes
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+	    st.st_size < kMinMappedSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return nullptr;
+	}
+
+	const uint32 size = st.st_size;
+	void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return nullptr;
+
+	return new PosixMappedStream(mapping, size);
+}
+
+PosixMappedStream::PosixMappedStream(void *mapping, uint32 size) :
+		Common::MemoryReadStream((const byte *)mapping, size, DisposeAfterUse::NO),
+		_mapping(mapping), _mappingSize(size) {
+}
+
+PosixMappedStream::~PosixMappedStream() {
+	munmap(_mapping, _mappingSize);
+}
+#endif
@@ -23,6 +23,7 @@
 #define BACKENDS_FS_POSIX_POSIXIOSTREAM_H
 
 #include "backends/fs/stdiostream.h"
+#include "common/memstream.h"
 
 /**
  * A file input / output stream using POSIX interfaces
@@ -39,4 +40,37 @@ public:
 	int64 size() const override;
 };
 
+#ifdef HAS_MMAP
+/**
+ * A read-only file stream which maps the whole file into memory. The
+ * contents are read in place through getData(), without copying them into
+ * a buffer first.
+ *
+ * The file must not be truncated while it is mapped.
+ */
+class PosixMappedStream final : public Common::MemoryReadStream {
+public:
+	/**
+	 * Files smaller than this are cheaper to read than to map, and are
+	 * left to PosixIoStream.
+	 */
+	static const uint32 kMinMappedSize = 64 * 1024;
+
+	/**
+	 * Map the file at the given path. Returns nullptr if the file is not a
+	 * regular file, is too small or too large to be mapped, or if mapping
+	 * it fails.
+	 */
+	static PosixMappedStream *makeFromPath(const Common::String &path);
+	~PosixMappedStream() override;
+
+private:
+	PosixMappedStream(void *mapping, uint32 size);
+
+	void *_mapping;
+	uint32 _mappingSize;
+};
+#endif
+
+
 #endif
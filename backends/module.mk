@@ -191,6 +191,7 @@ MODULE_OBJS += \
 	mixer/sdl/sdl-mixer.o \
 	mixer/null/null-mixer.o \
 	mutex/sdl/sdl-mutex.o \
+	threads/sdl/sdl-threads.o \
 	timer/sdl/sdl-timer.o
 
 ifndef RISCOS
@@ -413,6 +414,12 @@ endif
 ifeq ($(BACKEND),null)
 MODULE_OBJS += \
 	mixer/null/null-mixer.o
+
+ifdef POSIX
+MODULE_OBJS += \
+	mutex/pthread/pthread-mutex.o \
+	threads/pthread/pthread-threads.o
+endif
 endif
 
 ifdef MIYOO
@@ -49,6 +49,10 @@ typedef void (*sighandler_t)(int);
 #if defined(USE_NULL_DRIVER)
 #include "backends/modular-backend.h"
 #include "backends/mutex/null/null-mutex.h"
+#ifdef POSIX
+#include "backends/mutex/pthread/pthread-mutex.h"
+#include "backends/threads/pthread/pthread-threads.h"
+#endif
 #include "base/main.h"
 
 #ifndef NULL_DRIVER_USE_FOR_TEST
@@ -82,9 +86,19 @@ public:
 
 	virtual void initBackend();
 
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// There is no graphics manager to ask when running the unit tests
+	virtual bool hasFeature(Feature f) { return false; }
+#endif
+
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual Common::MutexInternal *createMutex();
+#ifdef POSIX
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *arg), void *arg);
+	virtual Common::SemaphoreInternal *createSemaphore();
+	virtual int getCpuCount();
+#endif
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
@@ -187,9 +201,28 @@ bool OSystem_NULL::pollEvent(Common::Event &event) {
 }
 
 Common::MutexInternal *OSystem_NULL::createMutex() {
+#ifdef POSIX
+	// Jobs of a Common::ThreadPool run on real threads
+	return createPthreadMutexInternal();
+#else
 	return new NullMutexInternal();
+#endif
 }
 
+#ifdef POSIX
+Common::ThreadInternal *OSystem_NULL::createThread(void (*proc)(void *arg), void *arg) {
+	return createPthreadThread(proc, arg);
+}
+
+Common::SemaphoreInternal *OSystem_NULL::createSemaphore() {
+	return createPthreadSemaphore();
+}
+
+int OSystem_NULL::getCpuCount() {
+	return getPthreadCpuCount();
+}
+#endif
+
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #ifdef POSIX
 	timeval curTime;
@@ -45,6 +45,7 @@
 #include "backends/events/default/default-events.h"
 #include "backends/keymapper/hardware-input.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
+#include "backends/threads/sdl/sdl-threads.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #ifdef USE_OPENGL
@@ -761,6 +762,18 @@ Common::MutexInternal *OSystem_SDL::createMutex() {
 	return createSdlMutexInternal();
 }
 
+Common::ThreadInternal *OSystem_SDL::createThread(void (*proc)(void *arg), void *arg) {
+	return createSdlThread(proc, arg);
+}
+
+Common::SemaphoreInternal *OSystem_SDL::createSemaphore() {
+	return createSdlSemaphore();
+}
+
+int OSystem_SDL::getCpuCount() {
+	return getSdlCpuCount();
+}
+
 uint32 OSystem_SDL::getMillis(bool skipRecord) {
 	uint32 millis = SDL_GetTicks();
 
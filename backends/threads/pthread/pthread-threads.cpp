@@ -0,0 +1,138 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "backends/threads/pthread/pthread-threads.h"
+#include "common/textconsole.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * pthreads thread implementation
+ */
+class PthreadThreadInternal final : public Common::ThreadInternal {
+public:
+	PthreadThreadInternal(pthread_t thread) : _thread(thread) {}
+
+	void join() override;
+
+private:
+	pthread_t _thread;
+};
+
+void PthreadThreadInternal::join() {
+	if (pthread_join(_thread, nullptr) != 0)
+		warning("pthread_join() failed");
+}
+
+/**
+ * Semaphore built from a mutex and a condition variable, since unnamed POSIX
+ * semaphores are not available everywhere
+ */
+class PthreadSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	PthreadSemaphoreInternal();
+	~PthreadSemaphoreInternal() override;
+
+	void wait() override;
+	void post() override;
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _count;
+};
+
+PthreadSemaphoreInternal::PthreadSemaphoreInternal() : _count(0) {
+	if (pthread_mutex_init(&_mutex, nullptr) != 0)
+		warning("pthread_mutex_init() failed");
+	if (pthread_cond_init(&_cond, nullptr) != 0)
+		warning("pthread_cond_init() failed");
+}
+
+PthreadSemaphoreInternal::~PthreadSemaphoreInternal() {
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void PthreadSemaphoreInternal::wait() {
+	pthread_mutex_lock(&_mutex);
+	while (_count == 0)
+		pthread_cond_wait(&_cond, &_mutex);
+	_count--;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadSemaphoreInternal::post() {
+	pthread_mutex_lock(&_mutex);
+	_count++;
+	pthread_cond_signal(&_cond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+namespace {
+
+struct ThreadStart {
+	Common::ThreadProc proc;
+	void *arg;
+};
+
+void *threadEntry(void *arg) {
+	ThreadStart start = *(ThreadStart *)arg;
+	delete (ThreadStart *)arg;
+
+	start.proc(start.arg);
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
+Common::ThreadInternal *createPthreadThread(Common::ThreadProc proc, void *arg) {
+	ThreadStart *start = new ThreadStart();
+	start->proc = proc;
+	start->arg = arg;
+
+	pthread_t thread;
+	if (pthread_create(&thread, nullptr, threadEntry, start) != 0) {
+		warning("pthread_create() failed");
+		delete start;
+		return nullptr;
+	}
+
+	return new PthreadThreadInternal(thread);
+}
+
+Common::SemaphoreInternal *createPthreadSemaphore() {
+	return new PthreadSemaphoreInternal();
+}
+
+int getPthreadCpuCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 0)
+		return count;
+#endif
+	return 1;
+}
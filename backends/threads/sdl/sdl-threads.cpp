@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/threads/sdl/sdl-threads.h"
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/textconsole.h"
+
+/**
+ * SDL thread implementation
+ */
+class SdlThreadInternal final : public Common::ThreadInternal {
+public:
+	SdlThreadInternal(SDL_Thread *thread) : _thread(thread) {}
+
+	void join() override { SDL_WaitThread(_thread, nullptr); }
+
+private:
+	SDL_Thread *_thread;
+};
+
+/**
+ * SDL semaphore implementation
+ */
+class SdlSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	SdlSemaphoreInternal(SDL_sem *sem) : _sem(sem) {}
+	~SdlSemaphoreInternal() override { SDL_DestroySemaphore(_sem); }
+
+	void wait() override { SDL_SemWait(_sem); }
+	void post() override { SDL_SemPost(_sem); }
+
+private:
+	SDL_sem *_sem;
+};
+
+namespace {
+
+struct ThreadStart {
+	Common::ThreadProc proc;
+	void *arg;
+};
+
+int SDLCALL threadEntry(void *arg) {
+	ThreadStart start = *(ThreadStart *)arg;
+	delete (ThreadStart *)arg;
+
+	start.proc(start.arg);
+	return 0;
+}
+
+} // End of anonymous namespace
+
+Common::ThreadInternal *createSdlThread(Common::ThreadProc proc, void *arg) {
+	ThreadStart *start = new ThreadStart();
+	start->proc = proc;
+	start->arg = arg;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	SDL_Thread *thread = SDL_CreateThread(threadEntry, "ScummVM worker", start);
+#else
+	SDL_Thread *thread = SDL_CreateThread(threadEntry, start);
+#endif
+	if (!thread) {
+		warning("SDL_CreateThread() failed: %s", SDL_GetError());
+		delete start;
+		return nullptr;
+	}
+
+	return new SdlThreadInternal(thread);
+}
+
+Common::SemaphoreInternal *createSdlSemaphore() {
+	SDL_sem *sem = SDL_CreateSemaphore(0);
+	if (!sem)
+		return nullptr;
+
+	return new SdlSemaphoreInternal(sem);
+}
+
+int getSdlCpuCount() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return SDL_GetCPUCount();
+#else
+	return 1;
+#endif
+}
+
+#endif
@@ -708,6 +708,9 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 	// Close all archives that were opened during detection
 	ADCacheMan.clearArchives();
 
+	// Mass add runs this for every directory, don't write the cache each time
+	ADCacheMan.savePersistentCache(false);
+
 	return DetectionResults(candidates);
 }
 
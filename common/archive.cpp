@@ -25,6 +25,7 @@
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/memstream.h"
+#include "common/threadpool.h"
 #include "common/punycode.h"
 #include "common/debug.h"
 
@@ -176,6 +177,11 @@ char Archive::getPathSeparator() const {
 	return '/';
 }
 
+MemcachingCaseInsensitiveArchive::MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize, uint32 maxCacheSize)
+	: _maxStronglyCachedSize(maxStronglyCachedSize), _maxCacheSize(maxCacheSize), _cacheSize(0),
+	  _hits(0), _misses(0), _bytesRead(0) {
+}
+
 SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMember(const Path &path) const {
 	return createReadStreamForMemberImpl(path, false, Common::AltStreamType::Invalid);
 }
@@ -197,7 +203,7 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 
 	bool isNew = false;
 	if (!_cache.contains(cacheKey)) {
-		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
+		SharedArchiveContents readResult = readContents(cacheKey);
 		if (readResult._bypass)
 			return readResult._bypass;
 		_cache[cacheKey] = readResult;
@@ -214,7 +220,7 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	// Check whether the entry is still valid as WeakPtr might have expired.
 	if (!entry->makeStrong()) {
 		// If it's expired, recreate the entry.
-		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
+		SharedArchiveContents readResult = readContents(cacheKey);
 		if (readResult._bypass)
 			return readResult._bypass;
 		_cache[cacheKey] = readResult;
@@ -227,18 +233,75 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	if (entry->isFileMissing())
 		return nullptr;
 
+	if (!isNew) {
+		_hits++;
+		touch(cacheKey);
+	}
+
 	// Now we have a valid contents reference. Make stream for it.
 	Common::MemoryReadStream *memStream = new Common::MemoryReadStream(entry->getContents(), entry->getSize());
 
-	// If the entry was just created and it's too big for strong caching,
-	// mark the copy in cache as weak
-	if (isNew && entry->getSize() > _maxStronglyCachedSize) {
-		entry->makeWeak();
+	// If the entry is too big for strong caching, keep it strong only as
+	// long as it fits into the cache budget. This includes evicted entries
+	// which were brought back by a stream still using them.
+	if (entry->getSize() > _maxStronglyCachedSize && !_lruPos.contains(cacheKey)) {
+		addToLRU(cacheKey, *entry);
 	}
 
 	return memStream;
 }
 
+void MemcachingCaseInsensitiveArchive::setMaxCacheSize(uint32 maxCacheSize) {
+	_maxCacheSize = maxCacheSize;
+	evict();
+}
+
+SharedArchiveContents MemcachingCaseInsensitiveArchive::readContents(const CacheKey &cacheKey) const {
+	SharedArchiveContents readResult;
+	if (cacheKey.altStreamType != AltStreamType::Invalid)
+		readResult = readContentsForPathAltStream(cacheKey.path, cacheKey.altStreamType);
+	else
+		readResult = readContentsForPath(cacheKey.path);
+
+	_misses++;
+	_bytesRead += readResult.getSize();
+	return readResult;
+}
+
+void MemcachingCaseInsensitiveArchive::touch(const CacheKey &cacheKey) const {
+	if (!_lruPos.contains(cacheKey))
+		return;
+
+	LRUList::iterator &pos = _lruPos[cacheKey];
+	_lru.erase(pos);
+	_lru.push_front(cacheKey);
+	pos = _lru.begin();
+}
+
+void MemcachingCaseInsensitiveArchive::addToLRU(const CacheKey &cacheKey, SharedArchiveContents &entry) const {
+	if (entry.getSize() > _maxCacheSize) {
+		entry.makeWeak();
+		return;
+	}
+
+	_lru.push_front(cacheKey);
+	_lruPos[cacheKey] = _lru.begin();
+	_cacheSize += entry.getSize();
+	evict();
+}
+
+void MemcachingCaseInsensitiveArchive::evict() const {
+	while (_cacheSize > _maxCacheSize && !_lru.empty()) {
+		const CacheKey cacheKey = _lru.back();
+		_lru.pop_back();
+		_lruPos.erase(cacheKey);
+
+		SharedArchiveContents &entry = _cache[cacheKey];
+		_cacheSize -= entry.getSize();
+		entry.makeWeak();
+	}
+}
+
 SharedArchiveContents MemcachingCaseInsensitiveArchive::readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const {
 	return SharedArchiveContents();
 }
@@ -553,10 +616,49 @@ SeekableReadStream *SearchSet::createReadStreamForMemberNext(const Path &path, c
 	return nullptr;
 }
 
-SearchManager::SearchManager() {
+void SearchSet::prefetchMember(const Path &path) const {
+	if (path.empty())
+		return;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(path)) {
+			it->_arc->prefetchMember(path);
+			return;
+		}
+	}
+}
+
+SearchManager::SearchManager() : _prefetchPool(nullptr) {
 	clear(); // Force a reset
 }
 
+SearchManager::~SearchManager() {
+	// Wait for the pending reads
+	delete _prefetchPool;
+}
+
+void SearchManager::prefetchStream(SeekableReadStream *stream) {
+	if (!stream)
+		return;
+
+	// Reading is limited by the storage, so one thread is enough
+	if (!_prefetchPool)
+		_prefetchPool = new ThreadPool(1);
+
+	if (!_prefetchPool->getNumThreads()) {
+		delete stream;
+		return;
+	}
+
+	_prefetchPool->submit([stream]() {
+		byte buffer[4096];
+		while (stream->read(buffer, sizeof(buffer)) == sizeof(buffer))
+			;
+		delete stream;
+	});
+}
+
 void SearchManager::clear() {
 	SearchSet::clear();
 
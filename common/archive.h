@@ -46,6 +46,7 @@ namespace Common {
 class ArchiveMember;
 class FSNode;
 class SeekableReadStream;
+class ThreadPool;
 
 enum class AltStreamType {
 	Invalid,
@@ -202,6 +203,14 @@ public:
 		return createReadStreamForMember(path);
 	}
 
+	/**
+	 * Hint that the member with the specified name will be opened soon, so
+	 * that it can be brought into memory ahead of time. This returns
+	 * without waiting for the data, and does nothing if the member does
+	 * not exist or the archive cannot read ahead.
+	 */
+	virtual void prefetchMember(const Path &path) const {}
+
 	/**
 	 * Dump all files from the archive to the given directory
 	 */
@@ -265,10 +274,21 @@ private:
 
 /**
  * An archive that caches the resulting contents.
+ *
+ * Members no larger than the strongly cached size stay in memory for the
+ * lifetime of the archive. Archives which pass a cache budget also keep
+ * larger ones in memory after they are closed as long as they fit into it,
+ * the least recently opened ones being dropped first. Dropped members remain
+ * available while streams to them are still open.
  */
 class MemcachingCaseInsensitiveArchive : public Archive {
 public:
-	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512) : _maxStronglyCachedSize(maxStronglyCachedSize) {}
+	/**
+	 * @param maxStronglyCachedSize  Members up to this many bytes are always kept.
+	 * @param maxCacheSize           Budget in bytes for keeping the larger members,
+	 *                               none are kept by default.
+	 */
+	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512, uint32 maxCacheSize = 0);
 	SeekableReadStream *createReadStreamForMember(const Path &path) const;
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, Common::AltStreamType altStreamType) const;
 
@@ -279,6 +299,23 @@ public:
 	virtual SharedArchiveContents readContentsForPath(const Path &translatedPath) const = 0;
 	virtual SharedArchiveContents readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const;
 
+	/**
+	 * Change the budget for keeping the larger members, dropping the least
+	 * recently used ones if they do not fit anymore.
+	 */
+	void setMaxCacheSize(uint32 maxCacheSize);
+	uint32 getMaxCacheSize() const { return _maxCacheSize; }
+
+	/** Size of the larger members currently kept, in bytes. */
+	uint32 getCacheSize() const { return _cacheSize; }
+
+	/** Number of members opened without reading them from the archive. */
+	uint32 getCacheHits() const { return _hits; }
+	/** Number of members read from the archive. */
+	uint32 getCacheMisses() const { return _misses; }
+	/** Total size of the members read from the archive, in bytes. */
+	uint64 getBytesRead() const { return _bytesRead; }
+
 private:
 	struct CacheKey {
 		CacheKey();
@@ -295,10 +332,23 @@ private:
 		uint operator()(const CacheKey &x) const;
 	};
 
+	typedef List<CacheKey> LRUList;
+
 	SeekableReadStream *createReadStreamForMemberImpl(const Path &path, bool isAltStream, Common::AltStreamType altStreamType) const;
+	SharedArchiveContents readContents(const CacheKey &cacheKey) const;
+	void touch(const CacheKey &cacheKey) const;
+	void addToLRU(const CacheKey &cacheKey, SharedArchiveContents &entry) const;
+	void evict() const;
 
 	mutable HashMap<CacheKey, SharedArchiveContents, CacheKey_Hash, CacheKey_EqualTo> _cache;
+	/** Keys of the larger members kept in memory, the most recently used first. */
+	mutable LRUList _lru;
+	mutable HashMap<CacheKey, LRUList::iterator, CacheKey_Hash, CacheKey_EqualTo> _lruPos;
 	uint32 _maxStronglyCachedSize;
+	uint32 _maxCacheSize;
+	mutable uint32 _cacheSize;
+	mutable uint32 _hits, _misses;
+	mutable uint64 _bytesRead;
 };
 
 /**
@@ -450,6 +500,12 @@ public:
 	 */
 	SeekableReadStream *createReadStreamForMemberNext(const Path &path, const Archive *starting) const override;
 
+	/**
+	 * Implement prefetchMember from the Archive base class, using the same
+	 * policy as createReadStreamForMember.
+	 */
+	void prefetchMember(const Path &path) const override;
+
 	/**
 	 * Ignore clashes when adding directories. For more details, see the corresponding parameter
 	 * in @ref FSDirectory documentation.
@@ -467,9 +523,22 @@ public:
 	 */
 	virtual void clear();
 
+	/**
+	 * Read the stream to its end on a background thread and delete it
+	 * afterwards, so that the following reads of the same file are served
+	 * by the OS cache. This is meant for implementing
+	 * Archive::prefetchMember(), and the stream must not share any state
+	 * with other streams. Without thread support, the stream is just
+	 * deleted.
+	 */
+	void prefetchStream(SeekableReadStream *stream);
+
 private:
 	friend class Singleton<SingletonBaseType>;
 	SearchManager();
+	~SearchManager();
+
+	ThreadPool *_prefetchPool;
 };
 
 /** Shortcut for accessing the Search Manager. */
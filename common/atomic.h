@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+// For intrin.h on MSVC
+#include "common/intrinsics.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic operations
+ * @ingroup common
+ *
+ * @brief Operations on 32-bit values shared between threads without a lock.
+ *
+ * @{
+ */
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+inline uint32 atomicLoadAcquire(const volatile uint32 &value) {
+	return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+inline void atomicStoreRelease(volatile uint32 &value, uint32 newValue) {
+	__atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+}
+
+inline int32 atomicIncrement(volatile int32 &value) {
+	return __atomic_add_fetch(&value, 1, __ATOMIC_RELAXED);
+}
+
+inline int32 atomicDecrement(volatile int32 &value) {
+	return __atomic_sub_fetch(&value, 1, __ATOMIC_ACQ_REL);
+}
+
+#elif defined(__GNUC__)
+
+// The legacy builtins are full barriers
+inline uint32 atomicLoadAcquire(const volatile uint32 &value) {
+	const uint32 result = value;
+	__sync_synchronize();
+	return result;
+}
+
+inline void atomicStoreRelease(volatile uint32 &value, uint32 newValue) {
+	__sync_synchronize();
+	value = newValue;
+}
+
+inline int32 atomicIncrement(volatile int32 &value) {
+	return __sync_add_and_fetch(&value, 1);
+}
+
+inline int32 atomicDecrement(volatile int32 &value) {
+	return __sync_sub_and_fetch(&value, 1);
+}
+
+#elif defined(_MSC_VER)
+
+inline uint32 atomicLoadAcquire(const volatile uint32 &value) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)&value, 0, 0);
+}
+
+inline void atomicStoreRelease(volatile uint32 &value, uint32 newValue) {
+	_InterlockedExchange((volatile long *)&value, (long)newValue);
+}
+
+inline int32 atomicIncrement(volatile int32 &value) {
+	return _InterlockedIncrement((volatile long *)&value);
+}
+
+inline int32 atomicDecrement(volatile int32 &value) {
+	return _InterlockedDecrement((volatile long *)&value);
+}
+
+#else
+#error "Atomic operations are not implemented for this compiler"
+#endif
+
+/** @} */
+
+} // End of namespace Common
+
+#endif // COMMON_ATOMIC_H
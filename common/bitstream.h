@@ -41,6 +41,161 @@ namespace Common {
  * @{
  */
 
+/**
+ * A cut-down version of MemoryReadStream specifically for use with BitStream.
+ * It removes the virtual call overhead for reading bytes from a memory buffer,
+ * and allows directly inlining this access.
+ *
+ * The code duplication with MemoryReadStream is not ideal.
+ * It might be possible to avoid this by making this a final subclass of
+ * MemoryReadStream, but that is a C++11 feature.
+ */
+class BitStreamMemoryStream {
+private:
+	const byte * const _ptrOrig;
+	const byte *_ptr;
+	const uint32 _size;
+	uint32 _pos;
+	DisposeAfterUse::Flag _disposeMemory;
+	bool _eos;
+/** @overload */
+public:
+	BitStreamMemoryStream(const byte *dataPtr, uint32 dataSize, DisposeAfterUse::Flag disposeMemory = DisposeAfterUse::NO) :
+		_ptrOrig(dataPtr),
+		_ptr(dataPtr),
+		_size(dataSize),
+		_pos(0),
+		_disposeMemory(disposeMemory),
+		_eos(false) {}
+
+	~BitStreamMemoryStream() {
+		if (_disposeMemory)
+			free(const_cast<byte *>(_ptrOrig));
+	}
+
+	bool eos() const {
+		return _eos;
+	}
+
+	bool err() const {
+		return false;
+	}
+
+	uint32 pos() const {
+		return _pos;
+	}
+
+	uint32 size() const {
+		return _size;
+	}
+
+	bool seek(uint32 offset) {
+		assert(offset <= _size);
+
+		_eos = false;
+		_pos = offset;
+		_ptr = _ptrOrig + _pos;
+		return true;
+	}
+
+	byte readByte() {
+		if (_pos >= _size) {
+			_eos = true;
+			return 0;
+		}
+
+		_pos++;
+		return *_ptr++;
+	}
+
+	uint16 readUint16LE() {
+		if (_pos + 2 > _size) {
+			_eos = true;
+			if (_pos < _size) {
+				_pos++;
+				return *_ptr++;
+			} else {
+				return 0;
+			}
+		}
+
+		uint16 val = READ_LE_UINT16(_ptr);
+
+		_pos += 2;
+		_ptr += 2;
+
+		return val;
+	}
+
+	uint16 readUint16BE() {
+		if (_pos + 2 > _size) {
+			_eos = true;
+			if (_pos < _size) {
+				_pos++;
+				return (*_ptr++) << 8;
+			} else {
+				return 0;
+			}
+		}
+
+		uint16 val = READ_BE_UINT16(_ptr);
+
+		_pos += 2;
+		_ptr += 2;
+
+		return val;
+	}
+
+	uint32 readUint32LE() {
+		if (_pos + 4 > _size) {
+			uint32 val = readByte();
+			val |= (uint32)readByte() << 8;
+			val |= (uint32)readByte() << 16;
+			val |= (uint32)readByte() << 24;
+
+			return val;
+		}
+
+		uint32 val = READ_LE_UINT32(_ptr);
+
+		_pos += 4;
+		_ptr += 4;
+
+		return val;
+	}
+
+	uint32 readUint32BE() {
+		if (_pos + 4 > _size) {
+			uint32 val = (uint32)readByte() << 24;
+			val |= (uint32)readByte() << 16;
+			val |= (uint32)readByte() << 8;
+			val |= (uint32)readByte();
+
+			return val;
+		}
+
+		uint32 val = READ_BE_UINT32(_ptr);
+
+		_pos += 4;
+		_ptr += 4;
+
+		return val;
+	}
+
+	/** Return the data at the current position, to read it directly. */
+	const byte *getPtr() const {
+		return _ptr;
+	}
+
+	/** Skip @p n bytes which were read through getPtr(). */
+	void skipRead(uint32 n) {
+		assert(_pos + n <= _size);
+
+		_pos += n;
+		_ptr += n;
+	}
+};
+
 /**
  * A template implementing a bit stream for different data memory layouts.
  *
@@ -84,8 +239,51 @@ private:
 		return 0;
 	}
 
+	/**
+	 * Whether whole 64-bit loads from memory can fill the container. The
+	 * bytes then have to be in the order the bits are handed out, which is
+	 * not the case when the byte order of the values differs from the bit
+	 * order.
+	 */
+	static const bool kDirectFill = (sizeof(CONTAINER) == 8) && ((valueBits == 8) || (isLE != MSB2LSB));
+
+	/** Fill the container with as many values as fit, loading them all at once. */
+	template<class S>
+	FORCEINLINE bool fillContainerDirect(S *) {
+		return false;
+	}
+
+	FORCEINLINE bool fillContainerDirect(BitStreamMemoryStream *stream) {
+		if (!kDirectFill || stream->pos() + 8 > stream->size())
+			return false;
+
+		const uint bits = ((64 - _bitsLeft) / valueBits) * valueBits;
+		if (MSB2LSB) {
+			uint64 data = READ_BE_UINT64(stream->getPtr());
+			data = (data >> (64 - bits)) << (64 - bits);
+			_bitContainer |= data >> _bitsLeft;
+		} else {
+			uint64 data = READ_LE_UINT64(stream->getPtr());
+			if (bits < 64)
+				data &= (((uint64)1) << bits) - 1;
+			_bitContainer |= data << _bitsLeft;
+		}
+
+		_bitsLeft += bits;
+		stream->skipRead(bits / 8);
+		return true;
+	}
+
 	/** Fill the container with at least @p min bits. */
 	FORCEINLINE void fillContainer(size_t min) {
+		if (_bitsLeft >= min)
+			return;
+
+		// Refilling from memory adds at least valueBits bits, and min is
+		// never above the container size minus that
+		if (fillContainerDirect(_stream))
+			return;
+
 		while (_bitsLeft < min) {
 
 			CONTAINER data;
@@ -249,6 +447,37 @@ public:
 		return b;
 	}
 
+	/**
+	 * Fill the bit container with as many data values as fit into it.
+	 *
+	 * Afterwards at least sizeof(CONTAINER) * 8 - valueBits + 1 bits, which
+	 * are 33 bits or more with a 64-bit container, can be read with the
+	 * unchecked getters below. This lets callers refill once for several
+	 * reads.
+	 */
+	void refill() {
+		fillContainer(sizeof(CONTAINER) * 8 - valueBits + 1);
+	}
+
+	/** Read @p n bits without refilling the container first. @see refill() */
+	uint32 peekBitsFast(size_t n) const {
+		return getNBits(_bitContainer, n);
+	}
+
+	/** Read @p n bits without refilling the container first. @see refill() */
+	uint32 getBitsFast(size_t n) {
+		const uint32 b = getNBits(_bitContainer, n);
+
+		skipBits(n);
+
+		return b;
+	}
+
+	/** Skip @p n bits without refilling the container first. @see refill() */
+	void skipFast(size_t n) {
+		skipBits(n);
+	}
+
 	/**
 	 * Add a bit to the value x, making it an n+1-bit value.
 	 *
@@ -323,151 +552,6 @@ public:
 	}
 };
 
-
-
-/**
- * A cut-down version of MemoryReadStream specifically for use with BitStream.
- * It removes the virtual call overhead for reading bytes from a memory buffer,
- * and allows directly inlining this access.
- *
- * The code duplication with MemoryReadStream is not ideal.
- * It might be possible to avoid this by making this a final subclass of
- * MemoryReadStream, but that is a C++11 feature.
- */
-class BitStreamMemoryStream {
-private:
-	const byte * const _ptrOrig;
-	const byte *_ptr;
-	const uint32 _size;
-	uint32 _pos;
-	DisposeAfterUse::Flag _disposeMemory;
-	bool _eos;
-/** @overload */
-public:
-	BitStreamMemoryStream(const byte *dataPtr, uint32 dataSize, DisposeAfterUse::Flag disposeMemory = DisposeAfterUse::NO) :
-		_ptrOrig(dataPtr),
-		_ptr(dataPtr),
-		_size(dataSize),
-		_pos(0),
-		_disposeMemory(disposeMemory),
-		_eos(false) {}
-
-	~BitStreamMemoryStream() {
-		if (_disposeMemory)
-			free(const_cast<byte *>(_ptrOrig));
-	}
-
-	bool eos() const {
-		return _eos;
-	}
-
-	bool err() const {
-		return false;
-	}
-
-	uint32 pos() const {
-		return _pos;
-	}
-
-	uint32 size() const {
-		return _size;
-	}
-
-	bool seek(uint32 offset) {
-		assert(offset <= _size);
-
-		_eos = false;
-		_pos = offset;
-		_ptr = _ptrOrig + _pos;
-		return true;
-	}
-
-	byte readByte() {
-		if (_pos >= _size) {
-			_eos = true;
-			return 0;
-		}
-
-		_pos++;
-		return *_ptr++;
-	}
-
-	uint16 readUint16LE() {
-		if (_pos + 2 > _size) {
-			_eos = true;
-			if (_pos < _size) {
-				_pos++;
-				return *_ptr++;
-			} else {
-				return 0;
-			}
-		}
-
-		uint16 val = READ_LE_UINT16(_ptr);
-
-		_pos += 2;
-		_ptr += 2;
-
-		return val;
-	}
-
-	uint16 readUint16BE() {
-		if (_pos + 2 > _size) {
-			_eos = true;
-			if (_pos < _size) {
-				_pos++;
-				return (*_ptr++) << 8;
-			} else {
-				return 0;
-			}
-		}
-
-		uint16 val = READ_LE_UINT16(_ptr);
-
-		_pos += 2;
-		_ptr += 2;
-
-		return val;
-	}
-
-	uint32 readUint32LE() {
-		if (_pos + 4 > _size) {
-			uint32 val = readByte();
-			val |= (uint32)readByte() << 8;
-			val |= (uint32)readByte() << 16;
-			val |= (uint32)readByte() << 24;
-
-			return val;
-		}
-
-		uint32 val = READ_LE_UINT32(_ptr);
-
-		_pos += 4;
-		_ptr += 4;
-
-		return val;
-	}
-
-	uint32 readUint32BE() {
-		if (_pos + 4 > _size) {
-			uint32 val = (uint32)readByte() << 24;
-			val |= (uint32)readByte() << 16;
-			val |= (uint32)readByte() << 8;
-			val |= (uint32)readByte();
-
-			return val;
-		}
-
-		uint32 val = READ_BE_UINT32(_ptr);
-
-		_pos += 4;
-		_ptr += 4;
-
-		return val;
-	}
-
-};
-
 /**
  * @name Typedefs for various memory layouts
  * @{
@@ -54,6 +54,11 @@ inline uint32 REVERSEBITS(uint32 x) {
 /**
  * Huffman bit stream decoding.
  *
+ * Codes are looked up in a table indexed by the next bits of the stream.
+ * Codes longer than the table is wide continue in smaller tables, one level
+ * per table width. Entries of codes short enough to leave room for a second
+ * code in the same bits also hold that code, which lets getSymbols() decode
+ * two symbols with a single lookup.
  */
 template<class BITSTREAM>
 class Huffman {
@@ -65,40 +70,60 @@ public:
 	 *  @param codes     The actual codes.
 	 *  @param lengths   Lengths of the individual codes.
 	 *  @param symbols   The symbols. If 0, assume they are identical to the code indices.
+	 *  @param tableBits Width of the first level lookup table. It is reduced to maxLength if that is smaller.
 	 */
-	Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols = nullptr);
+	Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols = nullptr, uint8 tableBits = 9);
 
 	/** Return the next symbol in the bit stream. */
 	uint32 getSymbol(BITSTREAM &bits) const;
 
+	/** Read the next @p count symbols from the bit stream into @p dst. */
+	template<typename T>
+	void getSymbols(BITSTREAM &bits, T *dst, uint32 count) const;
+
 private:
-	struct Symbol {
+	/** A code, with its first bit as the most significant one. */
+	struct Code {
 		uint32 code;
+		uint8  length;
 		uint32 symbol;
 
-		Symbol(uint32 c, uint32 s) : code(c), symbol(s) {}
+		Code(uint32 c, uint8 l, uint32 s) : code(c), length(l), symbol(s) {}
 	};
 
-	typedef List<Symbol> CodeList;
-	typedef Array<CodeList> CodeLists;
-
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	static const int8 kInvalidLength = 127;
 
-	/** Prefix lookup table used to speed up the decoding of short codes. */
-	struct PrefixEntry {
+	struct TableEntry {
+		/** The symbol, or the offset of the next level table. */
 		uint32 symbol;
-		uint8  length;
-
-		PrefixEntry() : length(0xFF) {}
+		/** The symbol of a second code which fits into the bits of the first level. */
+		uint32 nextSymbol;
+		/** Length of the code, the negated width of the next level table, or kInvalidLength. */
+		int8   length;
+		/** Length of both codes, 0 if there is no second code. */
+		uint8  pairLength;
+
+		TableEntry() : symbol(0), nextSymbol(0), length(kInvalidLength), pairLength(0) {}
 	};
 
-	static const uint8 _prefixTableBits = 8;
-	PrefixEntry _prefixTable[1 << _prefixTableBits];
+	/** All the lookup tables, the first level one at the start. */
+	Array<TableEntry> _table;
+	uint8 _tableBits;
+
+	/** Turn the first @p bits bits of a code into an index in the stream's bit order. */
+	static uint32 tableIndex(uint32 code, uint8 bits) {
+		return BITSTREAM::isMSB2LSB() ? code : REVERSEBITS(code) >> (32 - bits);
+	}
+
+	void buildTable(uint32 offset, uint8 bits, const Array<Code> &codes);
+	void buildPairs();
+
+	/** Find the entry of the next code, skipping the bits of all but the last table. */
+	const TableEntry &findEntry(BITSTREAM &bits) const;
 };
 
 template <class BITSTREAM>
-Huffman<BITSTREAM>::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) {
+Huffman<BITSTREAM>::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols, uint8 tableBits) {
 	assert(codeCount > 0);
 
 	assert(codes);
@@ -109,63 +134,140 @@ Huffman<BITSTREAM>::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *cod
 			maxLength = MAX(maxLength, lengths[i]);
 
 	assert(maxLength <= 32);
+	assert(tableBits > 0 && tableBits <= 16);
+
+	_tableBits = CLIP<uint8>(maxLength, 1, tableBits);
 
-	// Codes that do not fit in the prefix table are stored in the _codes array.
-	_codes.resize(MAX(maxLength - _prefixTableBits, 0));
+	Array<Code> allCodes;
+	allCodes.reserve(codeCount);
+	for (uint32 i = 0; i < codeCount; i++) {
+		const uint8 length = lengths[i];
 
-	for (uint i = 0; i < codeCount; i++) {
-		uint8 length = lengths[i];
+		// Bring the code into MSB to LSB order, which is the order of its bits
+		// in a stream read LSB first
+		uint32 code = codes[i];
+		if (!BITSTREAM::isMSB2LSB())
+			code = length ? REVERSEBITS(code) >> (32 - length) : 0;
 
 		// The symbol. If none was specified, assume it is identical to the code index.
-		uint32 symbol = symbols ? symbols[i] : i;
-
-		if (length <= _prefixTableBits) {
-			// Short codes go in the prefix lookup table. Set all the entries in the table
-			// with an index starting with the code to the symbol value.
-			uint32 startIndex;
-			if (BITSTREAM::isMSB2LSB()) {
-				startIndex = codes[i] << (_prefixTableBits - length);
-			} else {
-				startIndex = REVERSEBITS(codes[i]) >> (32 - _prefixTableBits);
-			}
+		allCodes.push_back(Code(code, length, symbols ? symbols[i] : i));
+	}
 
-			uint32 endIndex = startIndex | ((1 << (_prefixTableBits - length)) - 1);
+	_table.resize(1 << _tableBits);
+	buildTable(0, _tableBits, allCodes);
+	buildPairs();
+}
+
+template <class BITSTREAM>
+void Huffman<BITSTREAM>::buildTable(uint32 offset, uint8 bits, const Array<Code> &codes) {
+	Array<Array<Code> > longCodes;
+
+	for (uint i = 0; i < codes.size(); i++) {
+		const Code &code = codes[i];
+
+		if (code.length <= bits) {
+			// Set all the entries with an index starting with the code
+			const uint32 startIndex = code.code << (bits - code.length);
+			const uint32 endIndex = startIndex | ((1 << (bits - code.length)) - 1);
 
 			for (uint32 j = startIndex; j <= endIndex; j++) {
-				uint32 index = BITSTREAM::isMSB2LSB() ? j : REVERSEBITS(j) >> (32 - _prefixTableBits);
-				_prefixTable[index].symbol = symbol;
-				_prefixTable[index].length = length;
+				TableEntry &entry = _table[offset + tableIndex(j, bits)];
+				entry.symbol = code.symbol;
+				entry.length = code.length;
 			}
 		} else {
-			// Put the code and symbol into the correct list for the length.
-			_codes[lengths[i] - 1 - _prefixTableBits].push_back(Symbol(codes[i], symbol));
+			// Longer codes go into the next level table of their prefix
+			if (longCodes.empty())
+				longCodes.resize(1 << bits);
+
+			const uint8 length = code.length - bits;
+			longCodes[code.code >> length].push_back(Code(code.code & ((1 << length) - 1), length, code.symbol));
 		}
 	}
+
+	for (uint32 prefix = 0; prefix < longCodes.size(); prefix++) {
+		const Array<Code> &subCodes = longCodes[prefix];
+		if (subCodes.empty())
+			continue;
+
+		uint8 subBits = 0;
+		for (uint i = 0; i < subCodes.size(); i++)
+			subBits = MAX(subBits, subCodes[i].length);
+		subBits = MIN(subBits, _tableBits);
+
+		const uint32 subOffset = _table.size();
+		_table.resize(subOffset + (1 << subBits));
+
+		TableEntry &entry = _table[offset + tableIndex(prefix, bits)];
+		entry.symbol = subOffset;
+		entry.length = -(int8)subBits;
+
+		buildTable(subOffset, subBits, subCodes);
+	}
 }
 
 template <class BITSTREAM>
-uint32 Huffman<BITSTREAM>::getSymbol(BITSTREAM &bits) const {
-	uint32 code = bits.peekBits(_prefixTableBits);
+void Huffman<BITSTREAM>::buildPairs() {
+	const uint32 mask = (1 << _tableBits) - 1;
+
+	for (uint32 i = 0; i <= mask; i++) {
+		TableEntry &entry = _table[tableIndex(i, _tableBits)];
+		if (entry.length <= 0 || entry.length >= _tableBits)
+			continue;
+
+		// The bits after the code start the next one, which has to be
+		// complete within them
+		const TableEntry &next = _table[tableIndex((i << entry.length) & mask, _tableBits)];
+		if (next.length > 0 && next.length <= _tableBits - entry.length) {
+			entry.nextSymbol = next.symbol;
+			entry.pairLength = entry.length + next.length;
+		}
+	}
+}
 
-	uint8 length = _prefixTable[code].length;
+template <class BITSTREAM>
+const typename Huffman<BITSTREAM>::TableEntry &Huffman<BITSTREAM>::findEntry(BITSTREAM &bits) const {
+	uint32 tableBits = _tableBits;
+	const TableEntry *entry = &_table[bits.peekBits(tableBits)];
+
+	while (entry->length < 0) {
+		bits.skip(tableBits);
+		tableBits = -entry->length;
+		entry = &_table[entry->symbol + bits.peekBits(tableBits)];
+	}
 
-	if (length != 0xFF) {
-		bits.skip(length);
-		return _prefixTable[code].symbol;
-	} else {
-		bits.skip(_prefixTableBits);
+	if (entry->length == kInvalidLength)
+		error("Unknown Huffman code");
 
-		for (uint32 i = 0; i < _codes.size(); i++) {
-			bits.addBit(code, i + _prefixTableBits);
+	return *entry;
+}
 
-			for (typename CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-				if (code == cCode->code)
-					return cCode->symbol;
+template <class BITSTREAM>
+uint32 Huffman<BITSTREAM>::getSymbol(BITSTREAM &bits) const {
+	const TableEntry &entry = findEntry(bits);
+	bits.skip(entry.length);
+	return entry.symbol;
+}
+
+template <class BITSTREAM>
+template<typename T>
+void Huffman<BITSTREAM>::getSymbols(BITSTREAM &bits, T *dst, uint32 count) const {
+	while (count >= 2) {
+		const TableEntry &entry = _table[bits.peekBits(_tableBits)];
+
+		if (entry.pairLength) {
+			*dst++ = entry.symbol;
+			*dst++ = entry.nextSymbol;
+			bits.skip(entry.pairLength);
+			count -= 2;
+		} else {
+			*dst++ = getSymbol(bits);
+			count--;
 		}
 	}
 
-	error("Unknown Huffman code");
-	return 0;
+	if (count)
+		*dst = getSymbol(bits);
 }
 
 /** @} */
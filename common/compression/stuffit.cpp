@@ -101,7 +101,8 @@ private:
 	Common::SharedArchiveContents readContentsForPathFork(const Common::Path &translatedPath, bool isResFork) const;
 };
 
-StuffItArchive::StuffItArchive() : Common::MemcachingCaseInsensitiveArchive(), _flattenTree(false) {
+// Members are decompressed on every open, so keep the recently used ones around
+StuffItArchive::StuffItArchive() : Common::MemcachingCaseInsensitiveArchive(512, 4 * 1024 * 1024), _flattenTree(false) {
 	_stream = nullptr;
 }
 
@@ -95,6 +95,9 @@ typedef Byte Bytef;
 #include "common/compression/deflate.h"
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/substream.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -325,6 +328,8 @@ typedef Common::HashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCa
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* owner of _stream, shared with streamed files */
+	Common::SharedPtr<Common::Mutex> _streamMutex;		/* guards the position of _stream */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -459,6 +464,8 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 	int err = UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef.reset(stream);
+	us->_streamMutex.reset(new Common::Mutex());
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos == 0)
@@ -510,7 +517,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		err = UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -600,7 +606,7 @@ int unzClose(unzFile file) {
 		return UNZ_PARAMERROR;
 	s = (unz_s *)file;
 
-	delete s->_stream;
+	// Files opened with unzOpenCurrentFileStream keep the stream alive
 	delete s;
 	return UNZ_OK;
 }
@@ -1018,11 +1024,144 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
 }
 
+namespace Common {
+
+/**
+ * The data of a file in the zipfile. Keeps the stream of the zipfile alive,
+ * and locks it for each read, as other files may be read at the same time.
+ */
+class ZipFileReadStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _zipStream;
+	SharedPtr<Mutex> _mutex;
+
+public:
+	ZipFileReadStream(const SharedPtr<SeekableReadStream> &zipStream, const SharedPtr<Mutex> &mutex, uint32 begin, uint32 end) :
+		SafeSeekableSubReadStream(zipStream.get(), begin, end, DisposeAfterUse::NO), _zipStream(zipStream), _mutex(mutex) {
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		StackLock lock(*_mutex);
+		return SafeSeekableSubReadStream::read(dataPtr, dataSize);
+	}
+};
+
+/**
+ * Checks the CRC of the data of a file in the zipfile while it is read.
+ * The data is checked once it has been read up to its end, as long as it
+ * was read in order, and a mismatch is reported through err().
+ */
+class ZipCRCReadStream : public SeekableReadStream {
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _expectedCRC;
+	uint32 _crc;
+	uint32 _checkedSize; ///< Size of the data from the start of the file covered by _crc
+	bool _crcError;
+#ifndef USE_ZLIB
+	CRC32 _crcTable;
+#endif
+
+public:
+	ZipCRCReadStream(SeekableReadStream *parentStream, uint32 expectedCRC) :
+		_parentStream(parentStream, DisposeAfterUse::YES), _expectedCRC(expectedCRC), _checkedSize(0), _crcError(false) {
+#ifndef USE_ZLIB
+		_crc = _crcTable.getInitRemainder();
+#else
+		_crc = crc32(0, nullptr, 0);
+#endif
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		const int64 start = _parentStream->pos();
+		const uint32 count = _parentStream->read(dataPtr, dataSize);
+
+		// Only the part which continues the checked data can be added
+		if (start <= _checkedSize && start + count > _checkedSize) {
+			const byte *data = (const byte *)dataPtr + (_checkedSize - start);
+			const uint32 size = start + count - _checkedSize;
+#ifndef USE_ZLIB
+			for (uint32 i = 0; i < size; i++)
+				_crc = _crcTable.processByte(data[i], _crc);
+#else
+			_crc = crc32(_crc, data, size);
+#endif
+			_checkedSize += size;
+
+			if (_checkedSize == _parentStream->size()) {
+#ifndef USE_ZLIB
+				const uint32 crc = _crcTable.finalize(_crc);
+#else
+				const uint32 crc = _crc;
+#endif
+				if (crc != _expectedCRC) {
+					warning("CRC32 mismatch: %08x, %08x", crc, _expectedCRC);
+					_crcError = true;
+				}
+			}
+		}
+
+		return count;
+	}
+
+	bool err() const override { return _crcError || _parentStream->err(); }
+	void clearErr() override { _parentStream->clearErr(); }
+	bool eos() const override { return _parentStream->eos(); }
+
+	int64 pos() const override { return _parentStream->pos(); }
+	int64 size() const override { return _parentStream->size(); }
+	bool seek(int64 offset, int whence = SEEK_SET) override { return _parentStream->seek(offset, whence); }
+};
+
+} // End of namespace Common
+
+/*
+  Open the current file in the zipfile as a stream, which decompresses the
+  data as it is read instead of decompressing the whole file at once.
+  The CRC of the data is checked once it has been read to its end.
+*/
+Common::SeekableReadStream *unzOpenCurrentFileStream(unzFile file) {
+	uInt iSizeVar;
+	unz_s *s;
+	uLong offset_local_extrafield;  /* offset of the local extra field */
+	uInt  size_local_extrafield;    /* size of the local extra field */
+
+	if (file == nullptr)
+		return nullptr;
+	s = (unz_s *)file;
+	if (!s->current_file_ok)
+		return nullptr;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+		return nullptr;
+
+	const uint32 begin = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+	Common::SeekableReadStream *stream = new Common::ZipFileReadStream(s->_streamRef, s->_streamMutex,
+		begin, begin + s->cur_file_info.compressed_size);
+
+	switch (s->cur_file_info.compression_method) {
+	case 0: // Store
+		return new Common::ZipCRCReadStream(stream, s->cur_file_info.crc);
+	case Z_DEFLATED:
+		stream = Common::wrapDeflateReadStream(stream, DisposeAfterUse::YES, s->cur_file_info.uncompressed_size);
+		return stream ? new Common::ZipCRCReadStream(stream, s->cur_file_info.crc) : nullptr;
+	default:
+		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
+		delete stream;
+		return nullptr;
+	}
+}
+
 
 namespace Common {
 
 
 class ZipArchive : public MemcachingCaseInsensitiveArchive {
+	/**
+	 * Files at least this large are decompressed as they are read instead of
+	 * being held in memory as a whole.
+	 */
+	static const uint32 kStreamingThreshold = 1024 * 1024;
+
 	unzFile _zipFile;
 #ifndef USE_ZLIB
 	Common::CRC32 _crc;
@@ -1071,11 +1210,18 @@ ZipArchive::~ZipArchive() {
 	unzClose(_zipFile);
 }
 
+// The current file of the zipfile is shared, and streamed files may be read
+// from other threads, so the lock is held from locating the file on.
+
 bool ZipArchive::hasFile(const Path &path) const {
+	StackLock lock(*((const unz_s *)_zipFile)->_streamMutex);
+
 	return (unzLocateFile(_zipFile, path, 2) == UNZ_OK);
 }
 
 bool ZipArchive::isPathDirectory(const Path &path) const {
+	StackLock lock(*((const unz_s *)_zipFile)->_streamMutex);
+
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return false;
 
@@ -1107,8 +1253,19 @@ const ArchiveMemberPtr ZipArchive::getMember(const Path &path) const {
 }
 
 Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path &path) const {
+	StackLock lock(*((const unz_s *)_zipFile)->_streamMutex);
+
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return Common::SharedArchiveContents();
+
+	// Keep large files out of the cache, so that opening them neither
+	// stalls nor needs the whole file in memory
+	if (((const unz_s *)_zipFile)->cur_file_info.uncompressed_size >= kStreamingThreshold) {
+		SeekableReadStream *stream = unzOpenCurrentFileStream(_zipFile);
+		if (stream)
+			return Common::SharedArchiveContents::bypass(stream);
+	}
+
 #ifndef USE_ZLIB
 	return unzOpenCurrentFile(_zipFile, _crc);
 #else
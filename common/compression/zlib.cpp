@@ -31,8 +31,14 @@
 #error Version 1.2.0.4 or newer of zlib is required for this code
 #endif
 
+// Restarting decompression in the middle of a stream needs inflateGetDictionary
+#if ZLIB_VERNUM >= 0x1271
+#define GZIP_USE_CHECKPOINTS
+#endif
+
 #include "common/compression/deflate.h"
 
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -91,23 +97,91 @@ static bool _shownBackwardSeekingWarning = false;
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * While decompressing, the state needed to restart decompression is saved
+ * roughly every CHECKPOINT_SPACING bytes of output, so that seeking back, or
+ * forward into an area which was already decompressed once, does not have to
+ * start over from the beginning of the stream.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,
+		CHECKPOINT_SPACING = 1024 * 1024
 	};
 
+#ifdef GZIP_USE_CHECKPOINTS
+	struct Checkpoint {
+		uint32 pos;					// Position in the decompressed data
+		uint64 parentPos;			// Position of the next compressed byte in the wrapped stream
+		int bits;					// Number of bits of the previous byte still to be decoded
+		Array<byte> window;			// The last WINDOWSIZE decompressed bytes
+	};
+#endif
+
 	byte	_buf[BUFSIZE];
 
 	DisposablePtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
 	int _zlibErr;
+	int _windowBits;
 	uint64 _parentPos;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
 
+#ifdef GZIP_USE_CHECKPOINTS
+	Array<Checkpoint> _checkpoints;
+
+	void addCheckpoint(uint32 pos) {
+		Checkpoint checkpoint;
+		checkpoint.pos = pos;
+		checkpoint.parentPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.window.resize(WINDOWSIZE);
+
+		uInt windowSize = WINDOWSIZE;
+		if (inflateGetDictionary(&_stream, checkpoint.window.data(), &windowSize) != Z_OK)
+			return;
+		checkpoint.window.resize(windowSize);
+
+		_checkpoints.push_back(checkpoint);
+	}
+
+	bool restoreCheckpoint(const Checkpoint &checkpoint) {
+		// The compressed data continues in the middle of a deflate stream,
+		// whatever the header of the whole stream was
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+
+		if (checkpoint.bits) {
+			_wrapped->seek(checkpoint.parentPos - 1, SEEK_SET);
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, partial >> (8 - checkpoint.bits));
+		} else {
+			_wrapped->seek(checkpoint.parentPos, SEEK_SET);
+		}
+		if (_zlibErr == Z_OK)
+			_zlibErr = inflateSetDictionary(&_stream, checkpoint.window.data(), checkpoint.window.size());
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_pos = checkpoint.pos;
+		return true;
+	}
+
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		const Checkpoint *found = nullptr;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].pos <= pos; i++)
+			found = &_checkpoints[i];
+		return found;
+	}
+#endif
+
 public:
 
 	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream() {
@@ -137,7 +211,8 @@ public:
 		// the compressed file. This feature was added in zlib 1.2.0.4,
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_windowBits = MAX_WBITS + 32;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -157,7 +232,8 @@ public:
 		_pos = 0;
 		_eos = false;
 
-		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		_windowBits = -MAX_WBITS;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -194,7 +270,17 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
+#ifdef GZIP_USE_CHECKPOINTS
+			// Stop at the end of each block, which is where decompression can be restarted
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+
+			const uint32 outPos = _pos + dataSize - _stream.avail_out;
+			const uint32 lastCheckpoint = _checkpoints.empty() ? 0 : _checkpoints.back().pos;
+			if (_zlibErr == Z_OK && (_stream.data_type & 192) == 128 && outPos >= lastCheckpoint + CHECKPOINT_SPACING)
+				addCheckpoint(outPos);
+#else
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+#endif
 		}
 
 		// Update the position counter
@@ -234,6 +320,15 @@ public:
 
 		assert(newPos >= 0);
 
+#ifdef GZIP_USE_CHECKPOINTS
+		// Continue from the closest checkpoint, if it is past the current position
+		const Checkpoint *checkpoint = findCheckpoint(newPos);
+		if (checkpoint && (checkpoint->pos > _pos || (uint32)newPos < _pos)) {
+			if (!restoreCheckpoint(*checkpoint))
+				return false;
+		}
+#endif
+
 		if ((uint32)newPos < _pos) {
 			// To search backward, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
@@ -251,7 +346,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(_parentPos, SEEK_SET);
+#ifdef GZIP_USE_CHECKPOINTS
+			// Restoring a checkpoint may have switched to headerless mode
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false; // FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -23,6 +23,7 @@
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/memstream.h"
 #include "common/textconsole.h"
 #include "common/system.h"
 #include "backends/fs/fs-factory.h"
@@ -73,6 +74,21 @@ bool File::open(const FSNode &node) {
 	return open(stream, node.getPath().toString(Common::Path::kNativeSeparator));
 }
 
+bool File::openMapped(const FSNode &node) {
+	assert(!_handle);
+
+	if (!node.exists()) {
+		warning("File::openMapped: node does not exist");
+		return false;
+	} else if (node.isDirectory()) {
+		warning("File::openMapped: '%s' is a directory", node.getPath().toString(Common::Path::kNativeSeparator).c_str());
+		return false;
+	}
+
+	SeekableReadStream *stream = node.createMappedReadStream();
+	return open(stream, node.getPath().toString(Common::Path::kNativeSeparator));
+}
+
 bool File::open(SeekableReadStream *stream, const String &name) {
 	assert(!_handle);
 
@@ -107,6 +123,11 @@ bool File::isOpen() const {
 	return _handle != nullptr;
 }
 
+const byte *File::getData() const {
+	const MemoryReadStream *stream = dynamic_cast<const MemoryReadStream *>(_handle);
+	return stream ? stream->getData() : nullptr;
+}
+
 bool File::err() const {
 	assert(_handle);
 	return _handle->err();
@@ -95,6 +95,20 @@ public:
 	 */
 	virtual bool open(const FSNode &node);
 
+	/**
+	 * Try to open the file corresponding to the given node, mapping it into
+	 * memory if the backend supports it, so that getData() can be used.
+	 * Otherwise, this is the same as open(const FSNode &).
+	 *
+	 * Only use this for game data. A mapped file which gets truncated, or
+	 * cannot be read, crashes the process instead of causing a read error.
+	 * @note Must not be called if this file already is open (i.e. if isOpen returns true).
+	 *
+	 * @param   node        The node to consider.
+	 * @return	True if the file was opened successfully, false otherwise.
+	 */
+	bool openMapped(const FSNode &node);
+
 	/**
 	 * Try to 'open' the given stream. That is, wrap around it, and if the stream
 	 * is a NULL pointer, gracefully treat this as if opening failed.
@@ -125,6 +139,15 @@ public:
 	 */
 	const char *getName() const { return _name.c_str(); }
 
+	/**
+	 * Return the whole contents of the file if they are already in memory,
+	 * for example because the file was opened with openMapped() or was
+	 * cached by an archive. The data stays valid until the file is closed.
+	 *
+	 * @return The file contents, or nullptr if they have to be read.
+	 */
+	const byte *getData() const;
+
 	bool err() const override;	/*!< Implement abstract Stream method. */
 	void clearErr() override;	/*!< Implement abstract Stream method. */
 	bool eos() const override;	/*!< Implement abstract SeekableReadStream method. */
@@ -233,6 +233,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStatus(int64 &size, int64 &modificationTime) const {
+	return _realNode && _realNode->getFileStatus(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -248,6 +252,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createMappedReadStream() const {
+	if (_realNode == nullptr)
+		return nullptr;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createMappedReadStream: '%s' does not exist", getName().c_str());
+		return nullptr;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createMappedReadStream: '%s' is a directory", getName().c_str());
+		return nullptr;
+	}
+
+	return _realNode->createMappedReadStream();
+}
+
 SeekableReadStream *FSNode::createReadStreamForAltStream(AltStreamType altStreamType) const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -407,6 +426,17 @@ SeekableReadStream *FSDirectory::createReadStreamForMemberAltStream(const Path &
 	return stream;
 }
 
+void FSDirectory::prefetchMember(const Path &path) const {
+	if (path.empty() || !_node.isDirectory())
+		return;
+
+	FSNode *node = lookupCache(_fileCache, path);
+	if (!node)
+		return;
+
+	SearchMan.prefetchStream(node->createReadStream());
+}
+
 FSDirectory *FSDirectory::getSubDirectory(const Path &name, int depth, bool flat, bool ignoreClashes) {
 	return getSubDirectory(Path(), name, depth, flat, ignoreClashes);
 }
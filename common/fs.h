@@ -252,6 +252,17 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size of the file referred by this node, and the time of
+	 * its last modification. The time is only meant to be compared to other
+	 * times returned by this method, to find out whether the file changed.
+	 *
+	 * Not all backends provide this information.
+	 *
+	 * @return True if the information is available, false otherwise.
+	 */
+	bool getFileStatus(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -261,6 +272,20 @@ public:
 	 */
 	SeekableReadStream *createReadStream() const override;
 
+	/**
+	 * Create a SeekableReadStream instance corresponding to the file
+	 * referred by this node, which maps the file into memory if the backend
+	 * supports it. Its contents can then be accessed in place through
+	 * File::getData().
+	 *
+	 * Truncating a mapped file, or failing to read it, crashes instead of
+	 * causing a read error. This is meant for game data only, never for
+	 * saved games or other files which ScummVM writes.
+	 *
+	 * @return Pointer to the stream object, nullptr in case of a failure.
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to an alternate stream
 	 * of the file referred by this node. This assumes that the node actually
@@ -448,6 +473,12 @@ public:
 	 * for success.
 	 */
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, AltStreamType altStreamType) const override;
+
+	/**
+	 * Open the specified file and read it through on a background thread,
+	 * which brings it into the OS cache.
+	 */
+	void prefetchMember(const Path &path) const override;
 };
 
 /** @} */
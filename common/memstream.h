@@ -93,6 +93,12 @@ public:
 	int64 size() const { return _size; }
 
 	bool seek(int64 offs, int whence = SEEK_SET);
+
+	/**
+	 * Return the memory block the stream reads from, which allows parsing
+	 * it in place. It stays valid for the lifetime of the stream.
+	 */
+	const byte *getData() const { return _ptrOrig.get(); }
 };
 
 
@@ -56,6 +56,8 @@ namespace Common {
 class EventManager;
 class MutexInternal;
 struct Rect;
+class SemaphoreInternal;
+class ThreadInternal;
 class SaveFileManager;
 class SearchSet;
 class String;
@@ -1618,6 +1620,41 @@ public:
 
 	/** @} */
 
+	/**
+	 * @defgroup common_system_threads Worker threads
+	 * @ingroup common_system
+	 * @{
+	 *
+	 * Backends can provide threads for Common::ThreadPool, which runs
+	 * independent jobs such as decoding or mixing in the background. The
+	 * default implementation reports that there are no threads, in which
+	 * case the jobs run on the calling thread.
+	 *
+	 * Backends implementing these must also return real mutexes from
+	 * createMutex().
+	 */
+
+	/**
+	 * Create and start a new thread running the given procedure.
+	 *
+	 * @return The new thread, or nullptr if threads are not supported.
+	 */
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *arg), void *arg) { return nullptr; }
+
+	/**
+	 * Create a new semaphore with a count of zero.
+	 *
+	 * @return The new semaphore, or nullptr if threads are not supported.
+	 */
+	virtual Common::SemaphoreInternal *createSemaphore() { return nullptr; }
+
+	/**
+	 * Return the number of CPU cores available to run threads on.
+	 */
+	virtual int getCpuCount() { return 1; }
+
+	/** @} */
+
 
 
 	/** @defgroup common_system_sound Sound
@@ -0,0 +1,70 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_thread Threads
+ * @ingroup common
+ *
+ * @brief Backend interfaces for worker threads.
+ *
+ * Engines and the rest of the common code do not create threads directly,
+ * they queue jobs on a Common::ThreadPool instead.
+ * @{
+ */
+
+/** Entry point of a thread created with OSystem::createThread(). */
+typedef void (*ThreadProc)(void *arg);
+
+/** A thread created by the backend. */
+class ThreadInternal {
+public:
+	/** The thread must have been joined before it is destroyed. */
+	virtual ~ThreadInternal() {}
+
+	/** Wait until the thread procedure has returned. */
+	virtual void join() = 0;
+};
+
+/** A counting semaphore, which threads use to wait for each other. */
+class SemaphoreInternal {
+public:
+	virtual ~SemaphoreInternal() {}
+
+	/** Wait until the count is positive, then decrement it. */
+	virtual void wait() = 0;
+
+	/** Increment the count, waking up one waiting thread. */
+	virtual void post() = 0;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,262 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/threadpool.h"
+#include "common/system.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(int numThreads) : _workSignal(nullptr), _quit(false),
+	_loopFunc(nullptr), _loopContext(nullptr), _loopCount(0), _loopNext(0), _loopHelpers(0), _loopRunning(0),
+	_loopActive(false), _loopWaiting(false), _loopDone(nullptr) {
+	if (numThreads < 0)
+		numThreads = g_system->getCpuCount() - 1;
+	if (numThreads <= 0)
+		return;
+
+	_workSignal = g_system->createSemaphore();
+	_loopDone = g_system->createSemaphore();
+	if (!_workSignal || !_loopDone) {
+		delete _workSignal;
+		delete _loopDone;
+		_workSignal = _loopDone = nullptr;
+		return;
+	}
+
+	for (int i = 0; i < numThreads; i++) {
+		ThreadInternal *thread = g_system->createThread(workerProc, this);
+		if (!thread)
+			break;
+		_threads.push_back(thread);
+	}
+
+	if (_threads.empty()) {
+		delete _workSignal;
+		delete _loopDone;
+		_workSignal = _loopDone = nullptr;
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		StackLock lock(_mutex);
+		_quit = true;
+	}
+
+	// The workers empty the queue before they stop
+	for (uint i = 0; i < _threads.size(); i++)
+		_workSignal->post();
+
+	for (uint i = 0; i < _threads.size(); i++) {
+		_threads[i]->join();
+		delete _threads[i];
+	}
+
+	delete _workSignal;
+	delete _loopDone;
+}
+
+void ThreadPool::workerProc(void *arg) {
+	((ThreadPool *)arg)->runWorker();
+}
+
+void ThreadPool::runWorker() {
+	for (;;) {
+		_workSignal->wait();
+
+		// A wake up may have been meant for a loop or a job which is already
+		// done, while the one meant for us was taken by another thread. So
+		// only go back to sleep once there is nothing left to do.
+		for (;;) {
+			ThreadPoolTask *task = nullptr;
+			{
+				StackLock lock(_mutex);
+
+				if (_loopHelpers > 0) {
+					_loopHelpers--;
+					_loopRunning++;
+				} else if (!_queue.empty()) {
+					task = _queue.front();
+					_queue.pop_front();
+				} else if (_quit) {
+					return;
+				} else {
+					break;
+				}
+			}
+
+			if (task) {
+				execute(task);
+				release(task);
+				continue;
+			}
+
+			runLoop();
+
+			StackLock lock(_mutex);
+			if (--_loopRunning == 0 && _loopWaiting)
+				_loopDone->post();
+		}
+	}
+}
+
+bool ThreadPool::beginLoop(uint count, LoopFunc func, const void *context) {
+	if (_threads.empty())
+		return false;
+
+	uint numHelpers;
+	{
+		StackLock lock(_mutex);
+		if (_loopActive)
+			return false;
+
+		numHelpers = MIN<uint>(count - 1, _threads.size());
+
+		_loopFunc = func;
+		_loopContext = context;
+		_loopCount = count;
+		_loopNext = 0;
+		_loopHelpers = numHelpers;
+		_loopRunning = 0;
+		_loopActive = true;
+		_loopWaiting = false;
+	}
+
+	for (uint i = 0; i < numHelpers; i++)
+		_workSignal->post();
+
+	return true;
+}
+
+void ThreadPool::runLoop() {
+	for (;;) {
+		LoopFunc func;
+		const void *context;
+		uint i;
+		{
+			StackLock lock(_mutex);
+			if (_loopNext >= _loopCount)
+				return;
+			func = _loopFunc;
+			context = _loopContext;
+			i = _loopNext++;
+		}
+		func(context, i);
+	}
+}
+
+void ThreadPool::endLoop() {
+	bool wait;
+	{
+		StackLock lock(_mutex);
+		// Workers which did not get to the loop in time are not needed anymore
+		_loopHelpers = 0;
+		wait = _loopRunning > 0;
+		_loopWaiting = wait;
+	}
+
+	if (wait)
+		_loopDone->wait();
+
+	StackLock lock(_mutex);
+	_loopWaiting = false;
+	_loopActive = false;
+}
+
+void ThreadPool::enqueue(ThreadPoolTask *task) {
+	if (_threads.empty()) {
+		execute(task);
+		return;
+	}
+
+	{
+		StackLock lock(_mutex);
+		task->_refCount++;
+		_queue.push_back(task);
+	}
+
+	_workSignal->post();
+}
+
+void ThreadPool::execute(ThreadPoolTask *task) {
+	task->run();
+
+	StackLock lock(_mutex);
+	task->_done = true;
+	if (task->_doneSignal)
+		task->_doneSignal->post();
+}
+
+void ThreadPool::wait(ThreadPoolTask *task) {
+	bool queued = false;
+	{
+		StackLock lock(_mutex);
+		if (task->_done)
+			return;
+
+		for (List<ThreadPoolTask *>::iterator it = _queue.begin(); it != _queue.end(); ++it) {
+			if (*it == task) {
+				_queue.erase(it);
+				queued = true;
+				break;
+			}
+		}
+
+		if (!queued && !task->_doneSignal)
+			task->_doneSignal = g_system->createSemaphore();
+	}
+
+	if (queued) {
+		// No worker has picked the job up yet, so run it here rather than
+		// waiting for one to become free
+		execute(task);
+		release(task);
+		return;
+	}
+
+	// Pass the signal on to any other thread waiting for the same job
+	task->_doneSignal->wait();
+	task->_doneSignal->post();
+}
+
+bool ThreadPool::isDone(ThreadPoolTask *task) {
+	StackLock lock(_mutex);
+	return task->_done;
+}
+
+void ThreadPool::retain(ThreadPoolTask *task) {
+	StackLock lock(_mutex);
+	task->_refCount++;
+}
+
+void ThreadPool::release(ThreadPoolTask *task) {
+	bool last;
+	{
+		StackLock lock(_mutex);
+		last = --task->_refCount == 0;
+	}
+
+	if (last)
+		delete task;
+}
+
+} // End of namespace Common
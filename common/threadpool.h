@@ -0,0 +1,289 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+#include "common/thread.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_threadpool Thread pool
+ * @ingroup common
+ *
+ * @brief Running independent jobs on worker threads.
+ *
+ * @{
+ */
+
+class ThreadPool;
+
+/**
+ * Shared state of a job queued on a ThreadPool. All its fields are
+ * protected by the mutex of the pool.
+ */
+class ThreadPoolTask {
+public:
+	ThreadPoolTask() : _refCount(1), _done(false), _doneSignal(nullptr) {}
+	virtual ~ThreadPoolTask() { delete _doneSignal; }
+
+	virtual void run() = 0;
+
+private:
+	friend class ThreadPool;
+
+	int _refCount;
+	bool _done;
+	SemaphoreInternal *_doneSignal;
+};
+
+template<class T>
+class ThreadPoolResultTask : public ThreadPoolTask {
+public:
+	static T getResult(ThreadPoolTask *task) { return static_cast<ThreadPoolResultTask *>(task)->_result; }
+
+protected:
+	T _result;
+};
+
+template<>
+class ThreadPoolResultTask<void> : public ThreadPoolTask {
+public:
+	static void getResult(ThreadPoolTask *task) {}
+};
+
+template<class T, class Func>
+class ThreadPoolFuncTask : public ThreadPoolResultTask<T> {
+public:
+	ThreadPoolFuncTask(const Func &func) : _func(func) {}
+	void run() override { this->_result = _func(); }
+
+private:
+	Func _func;
+};
+
+template<class Func>
+class ThreadPoolFuncTask<void, Func> : public ThreadPoolResultTask<void> {
+public:
+	ThreadPoolFuncTask(const Func &func) : _func(func) {}
+	void run() override { _func(); }
+
+private:
+	Func _func;
+};
+
+/**
+ * Handle to the result of a job queued with ThreadPool::submit(). It must
+ * not outlive the pool.
+ */
+template<class T>
+class Future {
+public:
+	Future() : _pool(nullptr), _task(nullptr) {}
+	Future(const Future &other);
+	~Future();
+	Future &operator=(const Future &other);
+
+	/** Return true if the future refers to a job. */
+	bool isValid() const { return _task != nullptr; }
+
+	/** Return true if the job has finished, without waiting for it. */
+	bool isReady() const;
+
+	/**
+	 * Wait for the job to finish. If no worker has started it yet, it runs
+	 * on the calling thread.
+	 */
+	void wait() const;
+
+	/** Wait for the job to finish, and return its result. */
+	T get() const {
+		wait();
+		return ThreadPoolResultTask<T>::getResult(_task);
+	}
+
+private:
+	friend class ThreadPool;
+
+	Future(ThreadPool *pool, ThreadPoolTask *task) : _pool(pool), _task(task) {}
+
+	ThreadPool *_pool;
+	ThreadPoolTask *_task;
+};
+
+/**
+ * A set of worker threads running queued jobs.
+ *
+ * The threads are provided by the backend through OSystem::createThread().
+ * If it cannot create any, the pool has no workers and runs every job on the
+ * calling thread as soon as it is submitted, in submission order. Callers do
+ * not need to handle that case separately.
+ *
+ * Jobs run concurrently with each other and with the submitting thread, so
+ * any data they share has to be protected by a mutex.
+ */
+class ThreadPool : NonCopyable {
+public:
+	/**
+	 * Start the worker threads. By default, there is one less than there
+	 * are CPU cores, since the thread waiting for the jobs helps running
+	 * them.
+	 */
+	explicit ThreadPool(int numThreads = -1);
+
+	/** Finish all the queued jobs, then stop the worker threads. */
+	~ThreadPool();
+
+	/** Return the number of worker threads, which may be zero. */
+	uint getNumThreads() const { return _threads.size(); }
+
+	/**
+	 * Queue a job calling the given function object, which is copied.
+	 *
+	 * @return A future for the value returned by the function.
+	 */
+	template<class Func>
+	auto submit(const Func &func) -> Future<decltype(func())> {
+		typedef decltype(func()) Result;
+		ThreadPoolTask *task = new ThreadPoolFuncTask<Result, Func>(func);
+		enqueue(task);
+		return Future<Result>(this, task);
+	}
+
+	/**
+	 * Call func(i) for every i from 0 to count - 1, and return once all the
+	 * calls are done. The calls are spread over the worker threads and the
+	 * calling thread, in no particular order.
+	 *
+	 * This does not allocate any memory, so it may be used on threads which
+	 * must not block on the allocator, like the audio thread. Only one loop
+	 * runs on the workers at a time: when called from another loop, or while
+	 * another thread runs one, the calls are all made on the calling thread.
+	 */
+	template<class Func>
+	void parallelFor(uint count, const Func &func) {
+		if (count < 2 || !beginLoop(count, &callLoopFunc<Func>, &func)) {
+			for (uint i = 0; i < count; i++)
+				func(i);
+			return;
+		}
+
+		runLoop();
+		endLoop();
+	}
+
+private:
+	template<class T>
+	friend class Future;
+
+	typedef void (*LoopFunc)(const void *func, uint i);
+
+	template<class Func>
+	static void callLoopFunc(const void *func, uint i) {
+		(*(const Func *)func)(i);
+	}
+
+	static void workerProc(void *arg);
+	void runWorker();
+
+	/**
+	 * Set up the loop state and wake up the workers to help running it.
+	 *
+	 * @return false if the loop has to run serially.
+	 */
+	bool beginLoop(uint count, LoopFunc func, const void *context);
+	/** Run loop iterations until there are none left. */
+	void runLoop();
+	/** Wait for the workers still running loop iterations. */
+	void endLoop();
+
+	void enqueue(ThreadPoolTask *task);
+	void execute(ThreadPoolTask *task);
+	void wait(ThreadPoolTask *task);
+	bool isDone(ThreadPoolTask *task);
+
+	void retain(ThreadPoolTask *task);
+	void release(ThreadPoolTask *task);
+
+	Mutex _mutex;
+	Array<ThreadInternal *> _threads;
+	SemaphoreInternal *_workSignal;
+	List<ThreadPoolTask *> _queue;
+	bool _quit;
+
+	// State of the running parallelFor() loop, protected by _mutex
+	LoopFunc _loopFunc;
+	const void *_loopContext;
+	uint _loopCount;
+	uint _loopNext;
+	uint _loopHelpers; ///< Workers woken up for the loop which have not joined it yet
+	uint _loopRunning; ///< Workers running loop iterations
+	bool _loopActive;
+	bool _loopWaiting;
+	SemaphoreInternal *_loopDone;
+};
+
+template<class T>
+Future<T>::Future(const Future &other) : _pool(other._pool), _task(other._task) {
+	if (_task)
+		_pool->retain(_task);
+}
+
+template<class T>
+Future<T>::~Future() {
+	if (_task)
+		_pool->release(_task);
+}
+
+template<class T>
+Future<T> &Future<T>::operator=(const Future &other) {
+	if (other._task)
+		other._pool->retain(other._task);
+	if (_task)
+		_pool->release(_task);
+
+	_pool = other._pool;
+	_task = other._task;
+	return *this;
+}
+
+template<class T>
+bool Future<T>::isReady() const {
+	return _task && _pool->isDone(_task);
+}
+
+template<class T>
+void Future<T>::wait() const {
+	if (_task)
+		_pool->wait(_task);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
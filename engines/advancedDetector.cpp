@@ -407,6 +407,7 @@ Common::Error AdvancedMetaEngineDetectionBase::identifyGame(DetectedGame &game,
 
 	// Detection is done, no need to keep archives in memory anymore
 	ADCacheMan.clearArchives();
+	ADCacheMan.savePersistentCache();
 
 	if (!agdDesc.desc)
 		return Common::kNoGameDataFoundError;
@@ -468,6 +469,140 @@ namespace Common {
 	DECLARE_SINGLETON(AdvancedDetectorCacheManager);
 }
 
+static const char *const kPersistentCacheFileName = "detection_cache.dat";
+static const uint32 kPersistentCacheVersion = 1;
+static const uint32 kPersistentCacheSaveInterval = 10000;
+
+static Common::FSNode getPersistentCacheNode() {
+	// Kept next to the configuration file rather than with the saved games,
+	// which may be synced to the cloud
+	Common::Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return Common::FSNode(configFile.getParent().appendComponent(kPersistentCacheFileName));
+}
+
+/** Extract the path of the file from a key, which is surrounded by the MD5 properties and size. */
+static Common::Path getPersistentKeyPath(const Common::String &key) {
+	const size_t start = key.findFirstOf(':');
+	const size_t end = key.findLastOf(':');
+	if (start == Common::String::npos || end <= start)
+		return Common::Path();
+
+	return Common::Path(key.substr(start + 1, end - start - 1), '/');
+}
+
+bool AdvancedDetectorCacheManager::getPersistentProperties(const Common::String &key, const Common::FSNode &node, FileProperties &fileProps) {
+	loadPersistentCache();
+
+	const PersistentHashMap::const_iterator entry = persistentHashMap.find(key);
+	if (entry == persistentHashMap.end())
+		return false;
+
+	int64 fileSize, modificationTime;
+	if (!node.getFileStatus(fileSize, modificationTime))
+		return false;
+
+	if (fileSize != entry->_value.fileSize || modificationTime != entry->_value.modificationTime)
+		return false;
+
+	fileProps = entry->_value.props;
+	return true;
+}
+
+void AdvancedDetectorCacheManager::setPersistentProperties(const Common::String &key, const Common::FSNode &node, const FileProperties &fileProps) {
+	PersistentEntry entry;
+	if (!node.getFileStatus(entry.fileSize, entry.modificationTime))
+		return;
+
+	loadPersistentCache();
+
+	entry.props = fileProps;
+	persistentHashMap.setVal(key, entry);
+	persistentDirty = true;
+}
+
+void AdvancedDetectorCacheManager::loadPersistentCache() {
+	if (persistentLoaded)
+		return;
+	persistentLoaded = true;
+
+	const Common::FSNode node = getPersistentCacheNode();
+	if (!node.exists())
+		return;
+
+	Common::File file;
+	if (!file.open(node))
+		return;
+
+	if (file.readUint32BE() != MKTAG('A', 'D', 'C', 'F') || file.readUint32LE() != kPersistentCacheVersion)
+		return;
+
+	const uint32 count = file.readUint32LE();
+	for (uint32 i = 0; i < count && !file.eos() && !file.err(); i++) {
+		Common::String key = file.readString();
+
+		PersistentEntry entry;
+		entry.fileSize = file.readSint64LE();
+		entry.modificationTime = file.readSint64LE();
+		entry.props.size = file.readSint64LE();
+		entry.props.md5prop = (MD5Properties)file.readUint32LE();
+		entry.props.md5 = file.readString();
+
+		if (file.eos() || file.err())
+			break;
+
+		// Forget the files which are gone, so that the cache does not grow
+		// forever
+		const Common::Path path = getPersistentKeyPath(key);
+		if (path.empty() || !Common::FSNode(path).exists()) {
+			persistentDirty = true;
+			continue;
+		}
+
+		persistentHashMap.setVal(key, entry);
+	}
+}
+
+void AdvancedDetectorCacheManager::savePersistentCache(bool force) {
+	if (!persistentDirty)
+		return;
+
+	const uint32 time = g_system->getMillis();
+	if (!force && persistentSaveTime && time - persistentSaveTime < kPersistentCacheSaveInterval)
+		return;
+
+	Common::DumpFile file;
+	if (!file.open(getPersistentCacheNode())) {
+		warning("Could not write the detection cache");
+		return;
+	}
+
+	file.writeUint32BE(MKTAG('A', 'D', 'C', 'F'));
+	file.writeUint32LE(kPersistentCacheVersion);
+	file.writeUint32LE(persistentHashMap.size());
+	for (PersistentHashMap::const_iterator entry = persistentHashMap.begin(); entry != persistentHashMap.end(); ++entry) {
+		file.writeString(entry->_key);
+		file.writeByte(0);
+		file.writeSint64LE(entry->_value.fileSize);
+		file.writeSint64LE(entry->_value.modificationTime);
+		file.writeSint64LE(entry->_value.props.size);
+		file.writeUint32LE(entry->_value.props.md5prop);
+		file.writeString(entry->_value.props.md5);
+		file.writeByte(0);
+	}
+
+	file.finalize();
+	if (file.err()) {
+		warning("Could not write the detection cache");
+		return;
+	}
+
+	persistentDirty = false;
+	persistentSaveTime = MAX<uint32>(time, 1);
+}
+
 
 static MD5Properties gameFileToMD5Props(const ADGameFileDescription *fileEntry, uint32 gameFlags) {
 	MD5Properties ret = kMD5Head;
@@ -545,11 +680,32 @@ bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles,
 		return true;
 	}
 
+	// Plain files are also looked up in the cache kept across runs. Mac forks
+	// and files inside archives are left out, as they don't map to a single
+	// file whose changes can be tracked.
+	Common::String persistentKey;
+	if (!(md5prop & (kMD5MacMask | kMD5Archive)) && allFiles.contains(fname)) {
+		persistentKey = md5PropToCachePrefix(md5prop);
+		persistentKey += ':';
+		persistentKey += allFiles[fname].getPath().toString('/');
+		persistentKey += ':';
+		persistentKey += Common::String::format("%d", _md5Bytes);
+
+		if (ADCacheMan.getPersistentProperties(persistentKey, allFiles[fname], fileProps)) {
+			ADCacheMan.setMD5(hashname, fileProps.md5);
+			ADCacheMan.setSize(hashname, fileProps.size);
+			return true;
+		}
+	}
+
 	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
 
 	if (res) {
 		ADCacheMan.setMD5(hashname, fileProps.md5);
 		ADCacheMan.setSize(hashname, fileProps.size);
+
+		if (!persistentKey.empty())
+			ADCacheMan.setPersistentProperties(persistentKey, allFiles[fname], fileProps);
 	}
 
 	return res;
@@ -731,6 +731,12 @@ private:
 
 /**
  * Singleton Cache Storage for Computed MD5s and Open Archives
+ *
+ * The properties of plain files are also kept in a file across runs, so
+ * that detecting the same games again only has to hash the files that
+ * changed. An entry of that cache is keyed by the absolute path of the file
+ * and the MD5 properties, and only used while the size and modification time
+ * of the file are unchanged.
  */
 class AdvancedDetectorCacheManager : public Common::Singleton<AdvancedDetectorCacheManager> {
 public:
@@ -771,7 +777,23 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	/**
+	 * Look up the properties of a file in the cache kept across runs.
+	 * Only succeeds if the file did not change since they were stored.
+	 */
+	bool getPersistentProperties(const Common::String &key, const Common::FSNode &node, FileProperties &fileProps);
+
+	/** Store the properties of a file in the cache kept across runs. */
+	void setPersistentProperties(const Common::String &key, const Common::FSNode &node, const FileProperties &fileProps);
+
+	/**
+	 * Write the cache kept across runs, if it changed. Unless forced, writes
+	 * are skipped if the last one was less than a few seconds ago, which
+	 * spares writing it for every directory of a mass add.
+	 */
+	void savePersistentCache(bool force = true);
+
+	AdvancedDetectorCacheManager() : persistentLoaded(false), persistentDirty(false), persistentSaveTime(0) {
 		clear();
 	}
 
@@ -797,6 +819,20 @@ private:
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+
+	struct PersistentEntry {
+		int64 fileSize;
+		int64 modificationTime;
+		FileProperties props;
+	};
+
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentHashMap;
+	PersistentHashMap persistentHashMap;
+	bool persistentLoaded;
+	bool persistentDirty;
+	uint32 persistentSaveTime;
+
+	void loadPersistentCache();
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
@@ -54,6 +54,7 @@
 #include "sci/video/seq_decoder.h"
 #ifdef ENABLE_SCI32
 #include "common/memstream.h"
+#include "sci/graphics/celobj32.h"
 #include "sci/graphics/frameout.h"
 #include "sci/graphics/paint32.h"
 #include "sci/graphics/palette32.h"
@@ -120,6 +121,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	// Game
 	registerCmd("save_game",			WRAP_METHOD(Console, cmdSaveGame));
 	registerCmd("restore_game",		WRAP_METHOD(Console, cmdRestoreGame));
@@ -150,6 +152,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("vpi",                WRAP_METHOD(Console, cmdVisiblePlaneItemList));	// alias
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	registerCmd("cel_cache",          WRAP_METHOD(Console, cmdCelCache));
 	// Segments
 	registerCmd("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	registerCmd("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -163,6 +166,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_mode",			WRAP_METHOD(Console, cmdGCMode));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -360,6 +364,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
+	debugPrintf(" resource_cache - Shows the resource cache statistics, or sets its size\n");
 	debugPrintf("\n");
 	debugPrintf("Game:\n");
 	debugPrintf(" save_game - Saves the current game state to the hard disk\n");
@@ -386,6 +391,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" visible_plane_items / vpi - Shows a list of all items for a plane in the visible draw list (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
+	debugPrintf(" cel_cache - Shows the cel cache statistics, or sets its size (SCI2+)\n");
 	debugPrintf("\n");
 	debugPrintf("Segments:\n");
 	debugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -398,6 +404,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_mode - Shows or sets how garbage collection is done\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -997,6 +1004,24 @@ bool Console::cmdList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Shows the resource cache statistics, or sets the size of the resource cache\n");
+		debugPrintf("Usage: %s [<size in KB>]\n", argv[0]);
+		return true;
+	}
+
+	ResourceManager *resMan = _engine->getResMan();
+	if (argc == 2)
+		resMan->setMaxMemoryLRU(atoi(argv[1]) * 1024);
+
+	const ResourceCacheStats stats = resMan->getCacheStats();
+	debugPrintf("%d of %d KB used, %d KB locked\n", resMan->getMemoryLRU() / 1024, resMan->getMaxMemoryLRU() / 1024, resMan->getMemoryLocked() / 1024);
+	debugPrintf("%u hits, %u loads (%u of them freed before), %u resources freed\n", stats.hits, stats.loads, stats.reloads, stats.evictions);
+	debugPrintf("%u KB loaded in %u ms\n", stats.bytesLoaded / 1024, stats.loadTime);
+	return true;
+}
+
 bool Console::cmdResourceIntegrityDump(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Dumps integrity data about resources in the current game to disk.\n");
@@ -2289,6 +2314,27 @@ bool Console::cmdSavedBits(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdCelCache(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Shows the cel cache statistics, or sets the size of the cel cache\n");
+		debugPrintf("Usage: %s [<size in KB>]\n", argv[0]);
+		return true;
+	}
+
+#ifdef ENABLE_SCI32
+	if (CelObj::_cache) {
+		if (argc == 2)
+			CelObj::_cache->setMaxSize(atoi(argv[1]) * 1024);
+		CelObj::_cache->printStats(this);
+	} else {
+		debugPrintf("This SCI version does not have a cel cache\n");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdShowSavedBits(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Display saved bits.\n");
@@ -2934,6 +2980,40 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCMode(int argc, const char **argv) {
+	static const char *const modeNames[] = { "full", "incremental", "verify" };
+	IncrementalGC *gc = _engine->_gamestate->_segMan->getIncrementalGC();
+
+	if (argc < 2 || argc > 3) {
+		debugPrintf("Shows or sets how garbage collection is done.\n");
+		debugPrintf("Usage: %s <mode> [<frame budget>]\n", argv[0]);
+		debugPrintf("Modes:\n");
+		debugPrintf(" full - collect everything at once (default)\n");
+		debugPrintf(" incremental - spread the collection over many kernel calls\n");
+		debugPrintf(" verify - incremental, and check the result against a full collection\n");
+		debugPrintf("The frame budget is the number of milliseconds spent collecting per frame.\n");
+		debugPrintf("Current mode: %s, frame budget: %d ms\n", modeNames[gc->getMode()], gc->getFrameBudget());
+		return true;
+	}
+
+	int mode;
+	for (mode = 0; mode < ARRAYSIZE(modeNames); mode++) {
+		if (!scumm_stricmp(argv[1], modeNames[mode]))
+			break;
+	}
+
+	if (mode == ARRAYSIZE(modeNames)) {
+		debugPrintf("Unknown mode: %s\n", argv[1]);
+		return true;
+	}
+
+	gc->setMode((IncrementalGC::Mode)mode);
+	if (argc == 3)
+		gc->setFrameBudget(MAX(atoi(argv[2]), 1));
+
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
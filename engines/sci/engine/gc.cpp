@@ -21,6 +21,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -98,11 +99,9 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void pushRootSet(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -169,7 +168,13 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
 
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+	pushRootSet(s, wm);
+
+	const Common::Array<SegmentObj *> &heap = s->_segMan->getSegments();
 	processWorkList(s->_segMan, wm, heap);
 
 	if (g_sci->_gfxPorts)
@@ -181,6 +186,9 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 void run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
 
+	// A full collection makes the incremental one in progress pointless
+	segMan->getIncrementalGC()->cancel();
+
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
@@ -234,4 +242,171 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+IncrementalGC::IncrementalGC(SegManager *segMan)
+	: _segMan(segMan), _mode(kModeFull), _phase(kPhaseIdle), _frameBudget(2), _frameStartTime(0), _frameTime(0),
+	  _activeRefs(nullptr), _sweepSegment(0) {
+}
+
+IncrementalGC::~IncrementalGC() {
+	cancel();
+}
+
+void IncrementalGC::setMode(Mode mode) {
+	if (mode == kModeFull)
+		cancel();
+	_mode = mode;
+}
+
+void IncrementalGC::cancel() {
+	_segMan->_gcMarking = false;
+	_phase = kPhaseIdle;
+	_wm._worklist.clear();
+	_wm._map.clear();
+	delete _activeRefs;
+	_activeRefs = nullptr;
+}
+
+void IncrementalGC::markReference(reg_t reg) {
+	if (_phase == kPhaseMark)
+		_wm.push(reg);
+}
+
+void IncrementalGC::markAllocation(reg_t addr) {
+	if (_phase == kPhaseMark)
+		_wm.push(addr);
+	else if (_phase == kPhaseSweep)
+		_activeRefs->setVal(addr, true);
+}
+
+void IncrementalGC::step(EngineState *s) {
+	// Kernel calls are far from evenly spread over the frames, so the work
+	// is limited by the time spent in each frame rather than per call
+	const uint32 startTime = g_system->getMillis();
+	if (startTime - _frameStartTime >= 1000 / 60) {
+		_frameStartTime = startTime;
+		_frameTime = 0;
+	}
+
+	if (_frameTime >= _frameBudget)
+		return;
+
+	uint32 elapsed;
+	do {
+		switch (_phase) {
+		case kPhaseIdle:
+			debugC(kDebugLevelGC, "[GC] Starting incremental collection");
+			pushRootSet(s, _wm);
+			_segMan->_gcMarking = true;
+			_phase = kPhaseMark;
+			// fall through
+		case kPhaseMark:
+			mark(kMarkChunkSize);
+			if (_wm._worklist.empty())
+				finishMarking(s);
+			break;
+		case kPhaseSweep:
+			sweep();
+			break;
+		}
+
+		elapsed = g_system->getMillis() - startTime;
+	} while (isRunning() && _frameTime + elapsed < _frameBudget);
+
+	_frameTime += elapsed;
+}
+
+void IncrementalGC::mark(uint budget) {
+	const Common::Array<SegmentObj *> &heap = _segMan->getSegments();
+	const SegmentId stackSegment = _segMan->findSegmentByType(SEG_TYPE_STACK);
+
+	while (!_wm._worklist.empty() && budget--) {
+		const reg_t reg = _wm._worklist.back();
+		_wm._worklist.pop_back();
+
+		// The scripts may have freed the entry since it was found
+		if (reg.getSegment() != stackSegment && reg.getSegment() < heap.size() && heap[reg.getSegment()] &&
+			heap[reg.getSegment()]->isValidOffset(reg.getOffset())) {
+			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+			_wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+		}
+	}
+}
+
+void IncrementalGC::finishMarking(EngineState *s) {
+	// The roots and the entries without a write barrier may have changed
+	// since the collection started, so look at them again
+	pushRootSet(s, _wm);
+
+	const Common::Array<SegmentObj *> &heap = _segMan->getSegments();
+	for (uint seg = 1; seg < heap.size(); seg++) {
+		if (!heap[seg])
+			continue;
+
+		const SegmentType type = heap[seg]->getType();
+#ifdef ENABLE_SCI32
+		if (type != SEG_TYPE_LISTS && type != SEG_TYPE_NODES && type != SEG_TYPE_ARRAY)
+#else
+		if (type != SEG_TYPE_LISTS && type != SEG_TYPE_NODES)
+#endif
+			continue;
+
+		const Common::Array<reg_t> entries = heap[seg]->listAllDeallocatable(seg);
+		for (Common::Array<reg_t>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+			if (_wm._map.contains(*it))
+				_wm.pushArray(heap[seg]->listAllOutgoingReferences(*it));
+		}
+	}
+
+	mark(0xFFFFFFFF);
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(_wm);
+
+	_segMan->_gcMarking = false;
+	_activeRefs = normalizeAddresses(_segMan, _wm._map);
+	_wm._map.clear();
+
+	if (_mode == kModeVerify) {
+		AddrSet *fullRefs = findAllActiveReferences(s);
+		for (AddrSet::const_iterator it = fullRefs->begin(); it != fullRefs->end(); ++it) {
+			if (!_activeRefs->contains(it->_key)) {
+				warning("[GC] Incremental marking missed %04x:%04x", PRINT_REG(it->_key));
+				_activeRefs->setVal(it->_key, true);
+			}
+		}
+		delete fullRefs;
+	}
+
+	_phase = kPhaseSweep;
+	_sweepSegment = 1;
+}
+
+void IncrementalGC::sweep() {
+	const Common::Array<SegmentObj *> &heap = _segMan->getSegments();
+
+	// Sweep the next segment that exists
+	while (_sweepSegment < heap.size() && !heap[_sweepSegment])
+		_sweepSegment++;
+
+	if (_sweepSegment < heap.size()) {
+		SegmentObj *mobj = heap[_sweepSegment];
+		const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(_sweepSegment);
+		for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
+			const reg_t addr = *it;
+			if (!_activeRefs->contains(addr)) {
+				mobj->freeAtAddress(_segMan, addr);
+				debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+			}
+		}
+		_sweepSegment++;
+	}
+
+	if (_sweepSegment >= heap.size()) {
+		debugC(kDebugLevelGC, "[GC] Finished incremental collection");
+		delete _activeRefs;
+		_activeRefs = nullptr;
+		_phase = kPhaseIdle;
+	}
+}
+
 } // End of namespace Sci
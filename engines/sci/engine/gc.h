@@ -62,6 +62,81 @@ struct WorklistManager {
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * Garbage collector which spreads the work of run_gc() over many kernel
+ * calls, so that games with large heaps do not stall on a single frame.
+ *
+ * Marking is done in small steps while the scripts keep running. The
+ * references they store into objects and local variables meanwhile are
+ * reported through SegManager::gcWriteBarrier(), and everything allocated
+ * during a collection is kept. Lists, nodes and arrays are changed in too
+ * many places for a write barrier, so their reachable entries are scanned
+ * once more in the final marking step, together with the root set.
+ * Sweeping is then done one segment per step.
+ */
+class IncrementalGC {
+public:
+	enum Mode {
+		kModeFull,         ///< Collect everything at once with run_gc()
+		kModeIncremental,  ///< Spread the collection over several steps
+		kModeVerify        ///< Incremental, but check the marking against run_gc()
+	};
+
+	IncrementalGC(SegManager *segMan);
+	~IncrementalGC();
+
+	Mode getMode() const { return _mode; }
+	void setMode(Mode mode);
+
+	/**
+	 * Milliseconds spent collecting per frame of the 60 Hz screen update.
+	 * A step uses up what is left of it, and the following steps of the
+	 * same frame do nothing.
+	 */
+	uint getFrameBudget() const { return _frameBudget; }
+	void setFrameBudget(uint frameBudget) { _frameBudget = frameBudget; }
+
+	bool isRunning() const { return _phase != kPhaseIdle; }
+
+	/** Start a new collection, or continue the current one within the frame budget. */
+	void step(EngineState *s);
+
+	/** Drop the current collection, e.g. when the heap is replaced. */
+	void cancel();
+
+	/** Keep a reference which has been stored during marking. */
+	void markReference(reg_t reg);
+
+	/** Keep an address which has been allocated during a collection. */
+	void markAllocation(reg_t addr);
+
+private:
+	enum Phase {
+		kPhaseIdle,
+		kPhaseMark,
+		kPhaseSweep
+	};
+
+	enum {
+		kMarkChunkSize = 100 ///< References scanned between two looks at the clock
+	};
+
+	void mark(uint budget);
+	void finishMarking(EngineState *s);
+	void sweep();
+
+	SegManager *_segMan;
+	Mode _mode;
+	Phase _phase;
+	uint _frameBudget;
+	uint32 _frameStartTime;
+	uint32 _frameTime; ///< Time spent collecting in the current frame
+
+	WorklistManager _wm;
+	AddrSet *_activeRefs; ///< Result of the marking, while sweeping
+	uint _sweepSegment;
+};
+
 
 } // End of namespace Sci
 
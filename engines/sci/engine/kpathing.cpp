@@ -33,6 +33,7 @@
 #include "sci/graphics/frameout.h"
 #endif
 
+#include "common/array.h"
 #include "common/debug-channels.h"
 #include "common/list.h"
 #include "common/system.h"
@@ -116,10 +117,14 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Index in the visibility cache, -1 if the vertex isn't cached
+	int index;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = nullptr;
+		index = -1;
 	}
 };
 
@@ -219,6 +224,22 @@ public:
 	}
 };
 
+// Polygon edge, starting at a vertex, along with its bounding box
+struct Edge {
+	Vertex *vertex;
+	int16 left, top, right, bottom;
+
+	Edge(Vertex *v) : vertex(v) {
+		const Common::Point &p = v->v;
+		const Common::Point &q = CLIST_NEXT(v)->v;
+
+		left = MIN(p.x, q.x);
+		top = MIN(p.y, q.y);
+		right = MAX(p.x, q.x);
+		bottom = MAX(p.y, q.y);
+	}
+};
+
 struct Polygon {
 	// SCI polygon type
 	int type;
@@ -255,6 +276,12 @@ struct PathfindingState {
 	// Total number of vertices
 	int vertices;
 
+	// All polygon edges
+	Common::Array<Edge> edges;
+
+	// Visibility between the polygon vertices, NULL if it can't be used
+	AvoidPathCache *cache;
+
 	// Point to prepend and append to final path
 	Common::Point *_prependPoint;
 	Common::Point *_appendPoint;
@@ -269,6 +296,7 @@ struct PathfindingState {
 		_prependPoint = nullptr;
 		_appendPoint = nullptr;
 		vertices = 0;
+		cache = nullptr;
 	}
 
 	~PathfindingState() {
@@ -698,6 +726,73 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+/**
+ * Determines whether or not a vertex can be seen from another one
+ * @param s		the pathfinding state
+ * @param from	the vertex to look from
+ * @param to	the vertex to look at
+ * @return true if the line (from, to) doesn't cross any polygon
+ */
+static bool is_visible(PathfindingState *s, Vertex *from, Vertex *to) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((to == from) || (inside(to->v, from)) || (inside(from->v, to)))
+		return false;
+
+	const int16 left = MIN(from->v.x, to->v.x);
+	const int16 top = MIN(from->v.y, to->v.y);
+	const int16 right = MAX(from->v.x, to->v.x);
+	const int16 bottom = MAX(from->v.y, to->v.y);
+
+	// Check for intersecting edges
+	for (uint i = 0; i < s->edges.size(); i++) {
+		const Edge &edge = s->edges[i];
+
+		// An edge outside of the bounding box of the line can neither
+		// intersect it nor have its vertex on it
+		if ((edge.right < left) || (edge.left > right) || (edge.bottom < top) || (edge.top > bottom))
+			continue;
+
+		if (between(from->v, to->v, edge.vertex->v)) {
+			// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+			if ((inside(from->v, edge.vertex)) || (inside(to->v, edge.vertex)))
+				return false;
+
+			// This edge won't properly intersect, so we continue
+			continue;
+		}
+
+		if (intersect_proper(from->v, to->v, edge.vertex->v, CLIST_NEXT(edge.vertex)->v))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Returns the cached visibility of the polygon vertices from a polygon
+ * vertex, computing it first if needed.
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex, which must be in the cache
+ * @return the visibility bits, indexed by Vertex::index
+ */
+static const uint32 *visibility_row(PathfindingState *s, Vertex *vertex_cur) {
+	AvoidPathCache *cache = s->cache;
+	uint32 *row = &cache->visible[vertex_cur->index * ((cache->vertices + 31) / 32)];
+
+	if (!cache->computed[vertex_cur->index]) {
+		for (int i = 0; i < s->vertices; i++) {
+			Vertex *vertex = s->vertex_index[i];
+
+			if ((vertex->index >= 0) && is_visible(s, vertex_cur, vertex))
+				row[vertex->index >> 5] |= 1 << (vertex->index & 31);
+		}
+
+		cache->computed[vertex_cur->index] = true;
+	}
+
+	return row;
+}
+
 /**
  * Returns a list of all vertices that are visible from a particular vertex.
  * @param s				the pathfinding state
@@ -707,33 +802,23 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
 
+	// The visibility between polygon vertices is the same for every call
+	// with this polygon set, only the start and end points need to be
+	// checked each time
+	const uint32 *row = nullptr;
+	if (s->cache && (vertex_cur->index >= 0))
+		row = visibility_row(s, vertex_cur);
+
 	for (int i = 0; i < s->vertices; i++) {
 		Vertex *vertex = s->vertex_index[i];
+		bool visible;
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
-
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
-
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
-		}
+		if (row && (vertex->index >= 0))
+			visible = (row[vertex->index >> 5] >> (vertex->index & 31)) & 1;
+		else
+			visible = is_visible(s, vertex_cur, vertex);
 
-		if (j == s->vertices)
+		if (visible)
 			visVerts->push_front(vertex);
 	}
 
@@ -1160,6 +1245,49 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 	return v_new;
 }
 
+/**
+ * Numbers the polygon vertices and looks up the polygon set in the
+ * visibility cache. If the polygons have changed since the last call, the
+ * cache is started over.
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) pf_s: The pathfinding state
+ */
+static void lookup_visibility_cache(EngineState *s, PathfindingState *pf_s) {
+	AvoidPathCache *cache = &s->_avoidPathCache;
+	Common::Array<int16> key;
+	uint vertices = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		Polygon *polygon = *it;
+		Vertex *vertex;
+
+		key.push_back(polygon->type);
+		key.push_back(polygon->vertices.size());
+
+		CLIST_FOREACH(vertex, &polygon->vertices) {
+			key.push_back(vertex->v.x);
+			key.push_back(vertex->v.y);
+			vertex->index = vertices++;
+		}
+	}
+
+	if (key == cache->key) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+		cache->key = key;
+		cache->vertices = vertices;
+		cache->computed.clear();
+		cache->computed.resize(vertices, false);
+		cache->visible.clear();
+		cache->visible.resize(vertices * ((vertices + 31) / 32), 0);
+
+		debugC(kDebugLevelAvoidPath, "[avoidpath] New polygon set with %u vertices (%u hits, %u misses)", vertices, cache->hits, cache->misses);
+	}
+
+	pf_s->cache = cache;
+}
+
 /**
  * Converts an SCI polygon into a Polygon
  * Parameters: (EngineState *) s: The game state
@@ -1326,6 +1454,8 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		}
 	}
 
+	lookup_visibility_cache(s, pf_s);
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1333,6 +1463,12 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_start;
 	delete new_end;
 
+	// A point that splits a polygon edge changes the polygons, so the cached
+	// visibility doesn't apply
+	if (((pf_s->vertex_start->index < 0) && VERTEX_HAS_EDGES(pf_s->vertex_start))
+	        || ((pf_s->vertex_end->index < 0) && VERTEX_HAS_EDGES(pf_s->vertex_end)))
+		pf_s->cache = nullptr;
+
 	// Allocate and build vertex index
 	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
 
@@ -1344,6 +1480,9 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 		CLIST_FOREACH(vertex, &polygon->vertices) {
 			pf_s->vertex_index[count++] = vertex;
+
+			if (VERTEX_HAS_EDGES(vertex))
+				pf_s->edges.push_back(Edge(vertex));
 		}
 	}
 
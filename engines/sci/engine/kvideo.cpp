@@ -49,6 +49,8 @@
 namespace Sci {
 
 void playVideo(Video::VideoDecoder &videoDecoder) {
+	// Decode a few frames ahead while the previous ones are shown
+	videoDecoder.setDecodeAheadDepth(4);
 	videoDecoder.start();
 
 	Common::SpanOwner<SciSpan<byte> > scaleBuffer;
@@ -109,7 +111,7 @@ void playVideo(Video::VideoDecoder &videoDecoder) {
 		if (g_sci->getEngineState()->_delayedRestoreGameId != -1)
 			skipVideo = true;
 
-		g_system->delayMillis(10);
+		videoDecoder.delayMillis(10);
 	}
 }
 reg_t kShowMovie(EngineState *s, int argc, reg_t *argv) {
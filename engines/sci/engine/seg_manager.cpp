@@ -23,6 +23,7 @@
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
+#include "sci/engine/gc.h"
 #ifdef ENABLE_SCI32
 #include "sci/engine/guest_additions.h"
 #endif
@@ -31,7 +32,8 @@ namespace Sci {
 
 
 SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
-	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
+	: _resMan(resMan), _scriptPatcher(scriptPatcher), _gcMarking(false) {
+	_incrementalGC = new IncrementalGC(this);
 	_heap.push_back(0);
 
 	_clonesSegId = 0;
@@ -52,9 +54,12 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 
 SegManager::~SegManager() {
 	resetSegMan();
+	delete _incrementalGC;
 }
 
 void SegManager::resetSegMan() {
+	_incrementalGC->cancel();
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -140,10 +145,20 @@ Script *SegManager::allocateScript(int script_nr, SegmentId &segid) {
 
 	// Add the script to the "script id -> segment id" hashmap
 	_scriptSegMap[script_nr] = segid;
+	gcMarkAllocation(make_reg(segid, 0));
 
 	return script;
 }
 
+void SegManager::gcMarkReference(reg_t value) {
+	_incrementalGC->markReference(value);
+}
+
+void SegManager::gcMarkAllocation(reg_t addr) {
+	if (_incrementalGC->isRunning())
+		_incrementalGC->markAllocation(addr);
+}
+
 SegmentId SegManager::getActualSegment(SegmentId seg) const {
 	if (getSciVersion() <= SCI_VERSION_2_1_LATE) {
 		return seg;
@@ -461,6 +476,7 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	int offset = table->allocEntry();
 
 	reg_t addr = make_reg(_hunksSegId, offset);
+	gcMarkAllocation(addr);
 	Hunk &h = table->at(offset);
 
 	h.mem = malloc(size);
@@ -494,6 +510,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	gcMarkAllocation(*addr);
 	return &table->at(offset);
 }
 
@@ -510,6 +527,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	gcMarkAllocation(*addr);
 	return &table->at(offset);
 }
 
@@ -526,6 +544,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	gcMarkAllocation(*addr);
 	return &table->at(offset);
 }
 
@@ -909,6 +928,7 @@ byte *SegManager::allocDynmem(int size, const char *descr, reg_t *addr) {
 	DynMem *dynmem = new DynMem();
 	SegmentId segid = allocSegment(dynmem);
 	*addr = make_reg(segid, 0);
+	gcMarkAllocation(*addr);
 
 	dynmem->_size = size;
 
@@ -952,6 +972,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	gcMarkAllocation(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -1008,6 +1029,7 @@ SciBitmap *SegManager::allocateBitmap(reg_t *addr, const int16 width, const int1
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_bitmapSegId, offset);
+	gcMarkAllocation(*addr);
 	SciBitmap &bitmap = table->at(offset);
 
 	bitmap.create(width, height, skipColor, originX, originY, xResolution, yResolution, paletteSize, remap, gc);
@@ -43,10 +43,12 @@ enum ScriptLoadType {
 	SCRIPT_GET_LOCK = 3 /**< Load, if necessary, and lock */
 };
 
+class IncrementalGC;
 class Script;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
+	friend class IncrementalGC;
 public:
 	/**
 	 * Initialize the segment manager.
@@ -460,7 +462,27 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	// Incremental garbage collection, see gc.h
+
+	IncrementalGC *getIncrementalGC() { return _incrementalGC; }
+
+	/**
+	 * Write barrier for the incremental garbage collector. Must be called
+	 * with every reference stored into an object or a local variable, so
+	 * that a collection in progress does not miss it.
+	 */
+	void gcWriteBarrier(reg_t value) {
+		if (_gcMarking && value.getSegment())
+			gcMarkReference(value);
+	}
+
 private:
+	void gcMarkReference(reg_t value);
+	void gcMarkAllocation(reg_t addr);
+
+	IncrementalGC *_incrementalGC;
+	bool _gcMarking; ///< Whether the incremental collector is marking
+
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
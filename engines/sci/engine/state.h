@@ -97,6 +97,24 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * Visibility between the polygon vertices of the last polygon set that was
+ * passed to kAvoidPath. Rooms pass the same polygons over and over, so this
+ * is kept across calls for as long as the polygon set stays the same.
+ * See kpathing.cpp.
+ */
+struct AvoidPathCache {
+	AvoidPathCache() : vertices(0), hits(0), misses(0) {}
+
+	Common::Array<int16> key; /**< Types and points of the polygons */
+	uint vertices; /**< Number of polygon vertices */
+	Common::Array<bool> computed; /**< Whether the visibility row of a vertex is known */
+	Common::Array<uint32> visible; /**< Visibility bits, one row per vertex */
+
+	uint32 hits; /**< Number of calls that reused the polygon set */
+	uint32 misses; /**< Number of calls with a new polygon set */
+};
+
 struct EngineState : public Common::Serializable {
 	EngineState(SegManager *segMan);
 	~EngineState() override;
@@ -192,6 +210,8 @@ struct EngineState : public Common::Serializable {
 	MessageState *_msgState;
 	void initMessageState();
 
+	AvoidPathCache _avoidPathCache;
+
 	// MemorySegment provides access to a 256-byte block of memory that remains
 	// intact across restarts and restores
 	enum {
@@ -169,6 +169,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 		if (type == VAR_TEMP && value.getSegment() == kUninitializedSegment)
 			value.setSegment(0);
 
+		s->_segMan->gcWriteBarrier(value);
 		s->variables[type][index] = value;
 
 		g_sci->_guestAdditions->writeVarHook(type, index, value);
@@ -218,6 +219,7 @@ static void _exec_varselectors(EngineState *s) {
 		} else {
 			// varselector access?
 			if (xs.argc) { // write?
+				s->_segMan->gcWriteBarrier(xs.variables_argp[1]);
 				*var = xs.variables_argp[1];
 
 #ifdef ENABLE_SCI32
@@ -848,9 +850,15 @@ void run_vm(EngineState *s) {
 
 		case op_callk: { // 0x21 (33)
 			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+			IncrementalGC *gc = s->_segMan->getIncrementalGC();
+			if (gc->isRunning()) {
+				gc->step(s);
+			} else if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				if (gc->getMode() == IncrementalGC::kModeFull)
+					run_gc(s);
+				else
+					gc->step(s);
 			}
 
 			// Call kernel function
@@ -930,6 +938,7 @@ void run_vm(EngineState *s) {
 					// varselector access?
 					reg_t *var = old_xs->getVarPointer(s->_segMan);
 					if (old_xs->argc) { // write?
+						s->_segMan->gcWriteBarrier(old_xs->variables_argp[1]);
 						*var = old_xs->variables_argp[1];
 
 #ifdef ENABLE_SCI32
@@ -1116,6 +1125,7 @@ void run_vm(EngineState *s) {
 				                    s->_segMan, BREAK_SELECTORWRITE);
 			}
 
+			s->_segMan->gcWriteBarrier(s->r_acc);
 			opProperty = s->r_acc;
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
@@ -1146,6 +1156,7 @@ void run_vm(EngineState *s) {
 				                    opProperty, newValue,
 				                    s->_segMan, BREAK_SELECTORWRITE);
 			}
+			s->_segMan->gcWriteBarrier(newValue);
 			opProperty = newValue;
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
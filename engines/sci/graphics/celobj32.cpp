@@ -19,6 +19,7 @@
  *
  */
 
+#include "sci/console.h"
 #include "sci/resource/resource.h"
 #include "sci/engine/features.h"
 #include "sci/engine/seg_manager.h"
@@ -88,9 +89,8 @@ bool CelObj::_drawBlackLines = false;
 void CelObj::init() {
 	CelObj::deinit();
 	_drawBlackLines = false;
-	_nextCacheId = 1;
 	_scaler = new CelScaler();
-	_cache = new CelCache(100);
+	_cache = new CelCache(kCelCacheSize);
 }
 
 void CelObj::deinit() {
@@ -240,14 +240,18 @@ struct SCALER_Scale {
 				scaledPosition.y,
 				scaledPosition.x + (celObj._width * scaleX).toInt(),
 				scaledPosition.y + (celObj._height * scaleY).toInt());
-			_sourceBuffer = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
-			_sourceBuffer->create(
-				scaledImageRect.width(), scaledImageRect.height(),
-				Graphics::PixelFormat::createFormatCLUT8());
-			Copier copier(_reader, *_sourceBuffer);
-			Graphics::larryScale(
-				celObj._width, celObj._height, celObj._skipColor, copier,
-				scaledImageRect.width(), scaledImageRect.height(), copier);
+			_sourceBuffer = CelObj::_cache->getScaledPixels(celObj._info, scaledImageRect.width(), scaledImageRect.height());
+			if (!_sourceBuffer) {
+				_sourceBuffer = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
+				_sourceBuffer->create(
+					scaledImageRect.width(), scaledImageRect.height(),
+					Graphics::PixelFormat::createFormatCLUT8());
+				Copier copier(_reader, *_sourceBuffer);
+				Graphics::larryScale(
+					celObj._width, celObj._height, celObj._skipColor, copier,
+					scaledImageRect.width(), scaledImageRect.height(), copier);
+				CelObj::_cache->putScaledPixels(celObj._info, _sourceBuffer);
+			}
 
 			// Set _valuesX and _valuesY to reference the scaled image without additional scaling
 			for (int16 x = targetRect.left; x < targetRect.right; ++x) {
@@ -371,6 +375,60 @@ private:
 	const int16 _sourceHeight;
 	const uint8 _skipColor;
 	const int16 _maxWidth;
+	// The decompressed pixels of the whole cel, when it is in the cel cache
+	Common::SharedPtr<Buffer> _pixels;
+
+	void decompressRow(const int16 y, const int16 maxWidth) {
+		// compressed data segment for row
+		const uint32 rowOffset = _resource.getUint32SEAt(_controlOffset + y * sizeof(uint32));
+
+		uint32 rowCompressedSize;
+		if (y + 1 < _sourceHeight) {
+			rowCompressedSize = _resource.getUint32SEAt(_controlOffset + (y + 1) * sizeof(uint32)) - rowOffset;
+		} else {
+			rowCompressedSize = _resource.size() - rowOffset - _dataOffset;
+		}
+
+		const byte *row = _resource.getUnsafeDataAt(_dataOffset + rowOffset, rowCompressedSize);
+
+		// uncompressed data segment for row
+		const uint32 literalOffset = _resource.getUint32SEAt(_controlOffset + _sourceHeight * sizeof(uint32) + y * sizeof(uint32));
+
+		uint32 literalRowSize;
+		if (y + 1 < _sourceHeight) {
+			literalRowSize = _resource.getUint32SEAt(_controlOffset + _sourceHeight * sizeof(uint32) + (y + 1) * sizeof(uint32)) - literalOffset;
+		} else {
+			literalRowSize = _resource.size() - literalOffset - _uncompressedDataOffset;
+		}
+
+		const byte *literal = _resource.getUnsafeDataAt(_uncompressedDataOffset + literalOffset, literalRowSize);
+
+		uint8 length;
+		for (int16 i = 0; i < maxWidth; i += length) {
+			const byte controlByte = *row++;
+			length = controlByte;
+
+			// Run-length encoded
+			if (controlByte & 0x80) {
+				length &= 0x3F;
+				assert(i + length < (int)sizeof(_buffer));
+
+				// Fill with skip color
+				if (controlByte & 0x40) {
+					memset(_buffer + i, _skipColor, length);
+				// Next value is fill color
+				} else {
+					memset(_buffer + i, *literal, length);
+					++literal;
+				}
+			// Uncompressed
+			} else {
+				assert(i + length < (int)sizeof(_buffer));
+				memcpy(_buffer + i, literal, length);
+				literal += length;
+			}
+		}
+	}
 
 public:
 	READER_Compressed(const CelObj &celObj, const int16 maxWidth) :
@@ -385,60 +443,29 @@ public:
 		_dataOffset = celHeader.getUint32SEAt(24);
 		_uncompressedDataOffset = celHeader.getUint32SEAt(28);
 		_controlOffset = celHeader.getUint32SEAt(32);
+
+		_pixels = CelObj::_cache->getPixels(celObj._info);
+		if (!_pixels && CelObj::_cache->canPutPixels(celObj._info, celObj._width * celObj._height)) {
+			// Decompress the whole cel once, so that drawing it again does
+			// not have to decompress it again
+			_pixels = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
+			_pixels->create(celObj._width, celObj._height, Graphics::PixelFormat::createFormatCLUT8());
+			for (int16 y = 0; y < _sourceHeight; ++y) {
+				decompressRow(y, celObj._width);
+				memcpy(_pixels->getBasePtr(0, y), _buffer, celObj._width);
+			}
+			CelObj::_cache->putPixels(celObj._info, _pixels);
+		}
 	}
 
 	inline const byte *getRow(const int16 y) {
 		assert(y >= 0 && y < _sourceHeight);
-		if (y != _y) {
-			// compressed data segment for row
-			const uint32 rowOffset = _resource.getUint32SEAt(_controlOffset + y * sizeof(uint32));
-
-			uint32 rowCompressedSize;
-			if (y + 1 < _sourceHeight) {
-				rowCompressedSize = _resource.getUint32SEAt(_controlOffset + (y + 1) * sizeof(uint32)) - rowOffset;
-			} else {
-				rowCompressedSize = _resource.size() - rowOffset - _dataOffset;
-			}
-
-			const byte *row = _resource.getUnsafeDataAt(_dataOffset + rowOffset, rowCompressedSize);
-
-			// uncompressed data segment for row
-			const uint32 literalOffset = _resource.getUint32SEAt(_controlOffset + _sourceHeight * sizeof(uint32) + y * sizeof(uint32));
-
-			uint32 literalRowSize;
-			if (y + 1 < _sourceHeight) {
-				literalRowSize = _resource.getUint32SEAt(_controlOffset + _sourceHeight * sizeof(uint32) + (y + 1) * sizeof(uint32)) - literalOffset;
-			} else {
-				literalRowSize = _resource.size() - literalOffset - _uncompressedDataOffset;
-			}
-
-			const byte *literal = _resource.getUnsafeDataAt(_uncompressedDataOffset + literalOffset, literalRowSize);
-
-			uint8 length;
-			for (int16 i = 0; i < _maxWidth; i += length) {
-				const byte controlByte = *row++;
-				length = controlByte;
-
-				// Run-length encoded
-				if (controlByte & 0x80) {
-					length &= 0x3F;
-					assert(i + length < (int)sizeof(_buffer));
+		if (_pixels) {
+			return static_cast<const byte *>(_pixels->getBasePtr(0, y));
+		}
 
-					// Fill with skip color
-					if (controlByte & 0x40) {
-						memset(_buffer + i, _skipColor, length);
-					// Next value is fill color
-					} else {
-						memset(_buffer + i, *literal, length);
-						++literal;
-					}
-				// Uncompressed
-				} else {
-					assert(i + length < (int)sizeof(_buffer));
-					memcpy(_buffer + i, literal, length);
-					literal += length;
-				}
-			}
+		if (y != _y) {
+			decompressRow(y, _maxWidth);
 			_y = y;
 		}
 
@@ -698,45 +725,165 @@ void CelObj::submitPalette() const {
 #pragma mark -
 #pragma mark CelObj - Caching
 
-int CelObj::_nextCacheId = 1;
-CelCache *CelObj::_cache = nullptr;
+// Cel objects themselves are small, but still count them for something so
+// that the number of entries stays bounded
+enum { kCelCacheEntrySize = 256 };
 
-int CelObj::searchCache(const CelInfo32 &celInfo, int *const nextInsertIndex) const {
-	*nextInsertIndex = -1;
-	int oldestId = _nextCacheId + 1;
-	int oldestIndex = 0;
+CelCache::CelCache(const uint32 maxSize) :
+	_size(0),
+	_maxSize(maxSize),
+	_celHits(0),
+	_celMisses(0),
+	_pixelHits(0),
+	_pixelMisses(0),
+	_scaledHits(0),
+	_scaledMisses(0) {}
 
-	for (int i = 0, len = _cache->size(); i < len; ++i) {
-		CelCacheEntry &entry = (*_cache)[i];
+CelCache::~CelCache() {
+	for (EntryList::iterator it = _lru.begin(); it != _lru.end(); ++it) {
+		delete *it;
+	}
+}
 
-		if (entry.celObj == nullptr) {
-			if (*nextInsertIndex == -1) {
-				*nextInsertIndex = i;
-			}
-		} else if (entry.celObj->_info == celInfo) {
-			entry.id = ++_nextCacheId;
-			return i;
-		} else if (oldestId > entry.id) {
-			oldestId = entry.id;
-			oldestIndex = i;
-		}
+CelCacheEntry *CelCache::find(const CelInfo32 &celInfo) {
+	EntryMap::iterator it = _entries.find(celInfo);
+	if (it == _entries.end()) {
+		return nullptr;
 	}
 
-	if (*nextInsertIndex == -1) {
-		*nextInsertIndex = oldestIndex;
+	CelCacheEntry *entry = it->_value;
+	if (entry->lruPosition != _lru.begin()) {
+		_lru.erase(entry->lruPosition);
+		_lru.push_front(entry);
+		entry->lruPosition = _lru.begin();
 	}
+	return entry;
+}
+
+void CelCache::resize(CelCacheEntry *entry, const uint32 size) {
+	_size = _size - entry->size + size;
+	entry->size = size;
+
+	while (_size > _maxSize && _lru.back() != entry) {
+		remove(_lru.back());
+	}
+}
+
+void CelCache::remove(CelCacheEntry *entry) {
+	_entries.erase(entry->celObj->_info);
+	_lru.erase(entry->lruPosition);
+	_size -= entry->size;
+	delete entry;
+}
+
+const CelObj *CelCache::getCelObj(const CelInfo32 &celInfo) {
+	const CelCacheEntry *entry = find(celInfo);
+	if (entry == nullptr) {
+		++_celMisses;
+		return nullptr;
+	}
+
+	++_celHits;
+	return entry->celObj.get();
+}
+
+void CelCache::putCelObj(CelObj *celObj) {
+	CelCacheEntry *entry = find(celObj->_info);
+	if (entry == nullptr) {
+		entry = new CelCacheEntry();
+		_lru.push_front(entry);
+		entry->lruPosition = _lru.begin();
+		_entries[celObj->_info] = entry;
+	}
+
+	entry->celObj.reset(celObj);
+	entry->pixels.reset();
+	entry->scaledPixels.reset();
+	resize(entry, kCelCacheEntrySize);
+}
+
+Common::SharedPtr<Buffer> CelCache::getPixels(const CelInfo32 &celInfo) {
+	const CelCacheEntry *entry = find(celInfo);
+	if (entry == nullptr) {
+		return Common::SharedPtr<Buffer>();
+	}
+
+	if (entry->pixels) {
+		++_pixelHits;
+	} else {
+		++_pixelMisses;
+	}
+	return entry->pixels;
+}
+
+bool CelCache::canPutPixels(const CelInfo32 &celInfo, const uint32 size) const {
+	// A cel that would take up most of the budget is cheaper to decompress
+	// again than to push everything else out of the cache for
+	return _entries.contains(celInfo) && size <= _maxSize / 4;
+}
 
-	return -1;
+void CelCache::putPixels(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels) {
+	CelCacheEntry *entry = find(celInfo);
+	if (entry == nullptr) {
+		return;
+	}
+
+	entry->pixels = pixels;
+	resize(entry, entry->size + pixels->w * pixels->h);
+}
+
+Common::SharedPtr<Buffer> CelCache::getScaledPixels(const CelInfo32 &celInfo, const int16 width, const int16 height) {
+	const CelCacheEntry *entry = find(celInfo);
+	if (entry == nullptr) {
+		return Common::SharedPtr<Buffer>();
+	}
+
+	if (entry->scaledPixels && entry->scaledPixels->w == width && entry->scaledPixels->h == height) {
+		++_scaledHits;
+		return entry->scaledPixels;
+	}
+
+	++_scaledMisses;
+	return Common::SharedPtr<Buffer>();
 }
 
-void CelObj::putCopyInCache(const int cacheIndex) const {
-	if (cacheIndex == -1) {
-		error("Invalid cache index");
+void CelCache::putScaledPixels(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels) {
+	CelCacheEntry *entry = find(celInfo);
+	if (entry == nullptr) {
+		return;
+	}
+
+	uint32 size = entry->size;
+	if (entry->scaledPixels) {
+		size -= entry->scaledPixels->w * entry->scaledPixels->h;
 	}
 
-	CelCacheEntry &entry = (*_cache)[cacheIndex];
-	entry.celObj.reset(duplicate());
-	entry.id = ++_nextCacheId;
+	entry->scaledPixels = pixels;
+	resize(entry, size + pixels->w * pixels->h);
+}
+
+void CelCache::setMaxSize(const uint32 maxSize) {
+	_maxSize = maxSize;
+	while (_size > _maxSize && !_lru.empty()) {
+		remove(_lru.back());
+	}
+}
+
+void CelCache::printStats(Console *con) const {
+	con->debugPrintf("%u cels, %u of %u KB used\n", _entries.size(), _size / 1024, _maxSize / 1024);
+	con->debugPrintf("Cel objects: %u hits, %u misses\n", _celHits, _celMisses);
+	con->debugPrintf("Decompressed pixels: %u hits, %u misses\n", _pixelHits, _pixelMisses);
+	con->debugPrintf("Scaled pixels: %u hits, %u misses\n", _scaledHits, _scaledMisses);
+}
+
+CelCache *CelObj::_cache = nullptr;
+
+const CelObj *CelObj::searchCache(const CelInfo32 &celInfo) const {
+	return _cache->getCelObj(celInfo);
+}
+
+void CelObj::putCopyInCache() const {
+	_cache->putCelObj(duplicate());
 }
 
 #pragma mark -
@@ -983,16 +1130,13 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 	_compressionType = kCelCompressionInvalid;
 	_transparent = true;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjView *const cachedCelObj = dynamic_cast<CelObjView *>(entry.celObj.get());
+	const CelObj *const cachedEntry = searchCache(_info);
+	if (cachedEntry != nullptr) {
+		const CelObjView *const cachedCelObj = dynamic_cast<const CelObjView *>(cachedEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjView in cache slot %d", cacheIndex);
+			error("Expected a CelObjView in cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1090,7 +1234,7 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 		_remap = analyzeForRemap();
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjView::analyzeUncompressedForRemap() const {
@@ -1191,16 +1335,13 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 	_transparent = true;
 	_remap = false;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjPic *const cachedCelObj = dynamic_cast<CelObjPic *>(entry.celObj.get());
+	const CelObj *const cachedEntry = searchCache(_info);
+	if (cachedEntry != nullptr) {
+		const CelObjPic *const cachedCelObj = dynamic_cast<const CelObjPic *>(cachedEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjPic in cache slot %d", cacheIndex);
+			error("Expected a CelObjPic in cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1264,7 +1405,7 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 		}
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjPic::analyzeUncompressedForSkip() const {
@@ -22,10 +22,14 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/ptr.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource/resource.h"
 #include "sci/engine/vm_types.h"
+#include "sci/graphics/helpers.h"
 #include "sci/util.h"
 
 namespace Sci {
@@ -105,7 +109,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,7 +119,7 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
@@ -135,18 +139,158 @@ struct CelInfo32 {
 	}
 };
 
+struct CelInfo32Hash {
+	uint operator()(const CelInfo32 &info) const {
+		// Like the equality test, this does not use the color field
+		return ((uint)info.type << 28) ^ ((uint)info.resourceId << 12) ^
+			((uint)info.loopNo << 6) ^ (uint16)info.celNo ^
+			((uint)info.bitmap.getSegment() << 16) ^ info.bitmap.getOffset();
+	}
+};
+
 class CelObj;
+class Console;
 struct CelCacheEntry {
+	Common::ScopedPtr<CelObj> celObj;
+
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * The decompressed pixels of the cel, once it has been drawn.
 	 */
-	int id;
-	Common::ScopedPtr<CelObj> celObj;
-	CelCacheEntry() : id(0) {}
+	Common::SharedPtr<Buffer> pixels;
+
+	/**
+	 * The pixels of the cel after the last smooth (LarryScale) scaling.
+	 */
+	Common::SharedPtr<Buffer> scaledPixels;
+
+	/**
+	 * The number of bytes this entry counts for against the cache budget.
+	 */
+	uint32 size;
+
+	/**
+	 * The position of this entry in the list of recently used entries.
+	 */
+	Common::List<CelCacheEntry *>::iterator lruPosition;
+
+	CelCacheEntry() : size(0) {}
+};
+
+enum {
+	/**
+	 * The default budget of the cel cache, in bytes.
+	 */
+	kCelCacheSize = 16 * 1024 * 1024
 };
 
-typedef Common::Array<CelCacheEntry> CelCache;
+/**
+ * A cache of cel objects used to avoid reinitialisation overhead for cels
+ * with the same CelInfo32. Along with the cel objects, the cache holds the
+ * decompressed and scaled pixels of the cels that have been drawn, up to a
+ * budget in bytes. The least recently used entries are dropped to stay
+ * within that budget.
+ *
+ * In SSCI, this was a fixed array of 100 cel objects which was searched
+ * linearly for every new cel object.
+ */
+class CelCache {
+public:
+	CelCache(const uint32 maxSize);
+	~CelCache();
+
+	/**
+	 * Returns the cached cel object matching the given CelInfo32, or null if
+	 * there is none.
+	 */
+	const CelObj *getCelObj(const CelInfo32 &celInfo);
+
+	/**
+	 * Puts the given cel object into the cache. The cache takes ownership of
+	 * the object.
+	 */
+	void putCelObj(CelObj *celObj);
+
+	/**
+	 * Returns the decompressed pixels of a cached cel, or null if they have
+	 * not been decompressed yet or the cel is not cached.
+	 */
+	Common::SharedPtr<Buffer> getPixels(const CelInfo32 &celInfo);
+
+	/**
+	 * Returns whether decompressed pixels of the given size can be kept for
+	 * the given cel.
+	 */
+	bool canPutPixels(const CelInfo32 &celInfo, const uint32 size) const;
+
+	/**
+	 * Stores the decompressed pixels of a cached cel.
+	 */
+	void putPixels(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels);
+
+	/**
+	 * Returns the smoothly scaled pixels of a cached cel if they have been
+	 * scaled to the given size before, or null otherwise.
+	 */
+	Common::SharedPtr<Buffer> getScaledPixels(const CelInfo32 &celInfo, const int16 width, const int16 height);
+
+	/**
+	 * Stores the smoothly scaled pixels of a cached cel, replacing any that
+	 * were stored for another size.
+	 */
+	void putScaledPixels(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels);
+
+	/**
+	 * Changes the budget of the cache, dropping entries if needed.
+	 */
+	void setMaxSize(const uint32 maxSize);
+
+	uint32 getMaxSize() const { return _maxSize; }
+	uint32 getSize() const { return _size; }
+
+	/**
+	 * Prints the contents and the hit rate of the cache to the debugger
+	 * console.
+	 */
+	void printStats(Console *con) const;
+
+private:
+	typedef Common::HashMap<CelInfo32, CelCacheEntry *, CelInfo32Hash> EntryMap;
+	typedef Common::List<CelCacheEntry *> EntryList;
+
+	/**
+	 * The cache entries, by the CelInfo32 of their cel objects.
+	 */
+	EntryMap _entries;
+
+	/**
+	 * The cache entries, from the most to the least recently used one.
+	 */
+	EntryList _lru;
+
+	/**
+	 * The total size of all entries, and the budget for it.
+	 */
+	uint32 _size, _maxSize;
+
+	uint32 _celHits, _celMisses;
+	uint32 _pixelHits, _pixelMisses;
+	uint32 _scaledHits, _scaledMisses;
+
+	/**
+	 * Returns the entry for the given CelInfo32 and marks it as the most
+	 * recently used one, or returns null if there is no such entry.
+	 */
+	CelCacheEntry *find(const CelInfo32 &celInfo);
+
+	/**
+	 * Changes the size of an entry, then drops the least recently used
+	 * entries until the cache is within budget again. The given entry is
+	 * kept.
+	 */
+	void resize(CelCacheEntry *entry, const uint32 size);
+
+	void remove(CelCacheEntry *entry);
+};
 
 #pragma mark -
 #pragma mark CelScaler
@@ -449,31 +593,24 @@ private:
 
 #pragma mark -
 #pragma mark CelObj - Caching
-protected:
-	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
-	 */
-	static int _nextCacheId;
-
+public:
 	/**
 	 * A cache of cel objects used to avoid reinitialisation overhead for cels
 	 * with the same CelInfo32.
 	 */
 	static CelCache *_cache;
 
+protected:
 	/**
-	 * Searches the cel cache for a CelObj matching the provided CelInfo32. If
-	 * not found, -1 is returned. `nextInsertIndex` will receive the index of
-	 * the oldest item in the cache, which can be used to replace the oldest
-	 * item with a newer item.
+	 * Searches the cel cache for a CelObj matching the provided CelInfo32.
+	 * If not found, null is returned.
 	 */
-	int searchCache(const CelInfo32 &celInfo, int *nextInsertIndex) const;
+	const CelObj *searchCache(const CelInfo32 &celInfo) const;
 
 	/**
-	 * Puts a copy of this CelObj into the cache at the given cache index.
+	 * Puts a copy of this CelObj into the cache.
 	 */
-	void putCopyInCache(int index) const;
+	void putCopyInCache() const;
 };
 
 #pragma mark -
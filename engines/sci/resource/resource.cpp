@@ -25,6 +25,7 @@
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -207,6 +208,7 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_evicted = false;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -256,9 +258,11 @@ uint32 AudioVolumeResourceSource::getAudioCompressionType() const {
 ResourceSource::ResourceSource(ResSourceType type, const Common::Path &name, int volNum, const Common::FSNode *resFile)
  : _sourceType(type), _name(name), _volumeNumber(volNum), _resourceFile(resFile) {
 	_scanned = false;
+	_preloadedData = nullptr;
 }
 
 ResourceSource::~ResourceSource() {
+	delete _preloadedData;
 }
 
 MacResourceForkResourceSource::MacResourceForkResourceSource(const Common::Path &name, int volNum)
@@ -367,6 +371,9 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 	}
 #endif
 
+	if (source->_preloadedData)
+		return source->_preloadedData;
+
 	if (source->_resourceFile)
 		return source->_resourceFile->createReadStream();
 
@@ -411,6 +418,10 @@ void ResourceManager::disposeVolumeFileStream(Common::SeekableReadStream *fileSt
 	}
 #endif
 
+	// Preloaded volumes are kept until the source is deleted
+	if (fileStream == source->_preloadedData)
+		return;
+
 	if (source->_resourceFile) {
 		delete fileStream;
 		return;
@@ -1005,6 +1016,9 @@ ResourceManager::ResourceManager(const bool detectionMode) :
 
 void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
+	_maxMemoryLRULimit = _maxMemoryLRU;
+	_cacheStats = ResourceCacheStats();
+	_loadRunStartTime = _loadRunEndTime = 0;
 	_memoryLocked = 0;
 	_memoryLRU = 0;
 	_LRU.clear();
@@ -1080,6 +1094,22 @@ void ResourceManager::init() {
 	if (getSciVersion() >= SCI_VERSION_2) {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
+	_maxMemoryLRULimit = _maxMemoryLRU;
+
+	if (!_detectionMode) {
+		// The budget above is only where the LRU starts out. It grows when
+		// resources have to be loaded again after having been freed, unless
+		// the user has set a fixed size.
+		if (ConfMan.hasKey("resource_cache_size")) {
+			_maxMemoryLRU = ConfMan.getInt("resource_cache_size") * 1024;
+			_maxMemoryLRULimit = _maxMemoryLRU;
+		} else {
+			_maxMemoryLRULimit = _maxMemoryLRU * 16;
+		}
+
+		if (ConfMan.hasKey("preload_resources") && ConfMan.getBool("preload_resources"))
+			preloadVolumes();
+	}
 
 	switch (_viewType) {
 	case kViewEga:
@@ -1153,12 +1183,57 @@ void ResourceManager::freeOldResources() {
 		Resource *goner = _LRU.back();
 		removeFromLRU(goner);
 		goner->unalloc();
+		goner->_evicted = true;
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
 #endif
 	}
 }
 
+void ResourceManager::setMaxMemoryLRU(int maxMemory) {
+	_maxMemoryLRU = maxMemory;
+	_maxMemoryLRULimit = maxMemory;
+	freeOldResources();
+}
+
+void ResourceManager::preloadVolumes() {
+	uint32 totalSize = 0;
+
+	for (SourcesList::iterator it = _sources.begin(); it != _sources.end(); ++it) {
+		ResourceSource *source = *it;
+		if (source->getSourceType() != kSourceVolume || source->_preloadedData)
+			continue;
+
+		Common::SeekableReadStream *fileStream;
+		if (source->_resourceFile) {
+			fileStream = source->_resourceFile->createReadStream();
+		} else {
+			Common::File *file = new Common::File();
+			if (!file->open(source->getLocationName())) {
+				delete file;
+				continue;
+			}
+			fileStream = file;
+		}
+
+		if (!fileStream)
+			continue;
+
+		const uint32 size = fileStream->size();
+		if (totalSize + size <= MAX_PRELOADED_VOLUMES_SIZE) {
+			source->_preloadedData = fileStream->readStream(size);
+			totalSize += size;
+		} else {
+			debugC(1, kDebugLevelResMan, "resMan: Not enough room to preload %s", source->getLocationName().toString().c_str());
+		}
+
+		delete fileStream;
+	}
+
+	debugC(1, kDebugLevelResMan, "resMan: Preloaded %d KB of resource volumes", totalSize / 1024);
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1183,6 +1258,12 @@ bool ResourceManager::hasResourceType(ResourceType type) {
 	return false;
 }
 
+ResourceCacheStats ResourceManager::getCacheStats() const {
+	ResourceCacheStats stats = _cacheStats;
+	stats.loadTime += _loadRunEndTime - _loadRunStartTime;
+	return stats;
+}
+
 Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	// remap known incorrect audio36 and sync36 resource ids
 	if (id.getType() == kResourceTypeAudio36) {
@@ -1195,15 +1276,34 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return nullptr;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		const uint32 loadStartTime = g_system->getMillis();
+		if (loadStartTime != _loadRunEndTime) {
+			_cacheStats.loadTime += _loadRunEndTime - _loadRunStartTime;
+			_loadRunStartTime = loadStartTime;
+		}
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		// The resource is removed from its current position
-		// in the LRU list because it has been requested
-		// again. Below, it will either be locked, or it
-		// will be added back to the LRU list at the 'most
-		// recent' position.
-		removeFromLRU(retval);
+		_loadRunEndTime = g_system->getMillis();
+		_cacheStats.loads++;
+		_cacheStats.bytesLoaded += retval->size();
+
+		if (retval->_evicted) {
+			// The LRU is too small for what the game uses at the moment,
+			// so make room for this resource next time
+			_cacheStats.reloads++;
+			_maxMemoryLRU = MIN<int>(_maxMemoryLRU + retval->size(), _maxMemoryLRULimit);
+		}
+	} else {
+		_cacheStats.hits++;
+
+		if (retval->_status == kResStatusEnqueued)
+			// The resource is removed from its current position
+			// in the LRU list because it has been requested
+			// again. Below, it will either be locked, or it
+			// will be added back to the LRU list at the 'most
+			// recent' position.
+			removeFromLRU(retval);
+	}
 
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
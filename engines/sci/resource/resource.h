@@ -76,7 +76,8 @@ enum ResourceErrorCodes {
 };
 
 enum {
-	MAX_OPENED_VOLUMES = 5 ///< Max number of simultaneously opened volumes
+	MAX_OPENED_VOLUMES = 5, ///< Max number of simultaneously opened volumes
+	MAX_PRELOADED_VOLUMES_SIZE = 512 * 1024 * 1024 ///< Max number of volume bytes to preload into memory
 };
 
 enum ResourceType {
@@ -309,6 +310,7 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _evicted; /**< Whether the LRU has freed this resource before */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -323,6 +325,20 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+/**
+ * Statistics on how well the LRU resource cache works.
+ */
+struct ResourceCacheStats {
+	uint32 hits;        ///< Requests for resources that were in memory already
+	uint32 loads;       ///< Resources that had to be read and decompressed
+	uint32 reloads;     ///< Loads of resources that the LRU had freed before
+	uint32 evictions;   ///< Resources freed to stay within the LRU budget
+	uint32 bytesLoaded; ///< Total size of the loaded resources
+	uint32 loadTime;    ///< Milliseconds spent reading and decompressing, see ResourceManager::getCacheStats()
+
+	ResourceCacheStats() : hits(0), loads(0), reloads(0), evictions(0), bytesLoaded(0), loadTime(0) {}
+};
+
 class IntMapResourceSource;
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
@@ -419,6 +435,24 @@ public:
 	const char *getVolVersionDesc() const { return versionDescription(_volVersion); }
 	ResVersion getVolVersion() const { return _volVersion; }
 
+	/**
+	 * Returns the statistics of the LRU resource cache.
+	 *
+	 * Most resources load in less than a millisecond, so the load time is
+	 * measured over runs of loads which follow each other within the same
+	 * millisecond, like the ones of a room change.
+	 */
+	ResourceCacheStats getCacheStats() const;
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMemoryLocked() const { return _memoryLocked; }
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+
+	/**
+	 * Sets a fixed budget for the LRU resource cache, freeing resources if
+	 * needed.
+	 */
+	void setMaxMemoryLRU(int maxMemory);
+
 	/**
 	 * Adds the appropriate GM patch from the Sierra MIDI utility as 4.pat, without
 	 * requiring the user to rename the file to 4.pat. Thus, the original Sierra
@@ -496,6 +530,14 @@ protected:
 	// issued whenever this limit is exceeded.
 	int _maxMemoryLRU;
 
+	// Resources that the LRU has to free and load again make the budget above
+	// grow, up to this limit. The budget stays fixed when it is set by the user.
+	int _maxMemoryLRULimit;
+
+	ResourceCacheStats _cacheStats;
+	uint32 _loadRunStartTime; ///< Start of the current run of loads, in milliseconds
+	uint32 _loadRunEndTime;   ///< End of the last load of the current run
+
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	typedef Common::List<ResourceSource *> SourcesList;
 	SourcesList _sources;
@@ -563,6 +605,13 @@ protected:
 	void disposeVolumeFileStream(Common::SeekableReadStream *fileStream, ResourceSource *source);
 	void loadResource(Resource *res);
 	void freeOldResources();
+
+	/**
+	 * Reads all resource volumes into memory, as far as they fit into
+	 * MAX_PRELOADED_VOLUMES_SIZE, so that loading resources does not have to
+	 * wait for the disk.
+	 */
+	void preloadVolumes();
 	bool validateResource(const ResourceId &resourceId, const Common::Path &sourceMapLocation, const Common::Path &sourceName, const uint32 offset, const uint32 size, const uint32 sourceSize) const;
 	Resource *addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0, const Common::Path &sourceMapLocation = Common::Path("(no map location)"));
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size, const Common::Path &sourceMapLocation = Common::Path("(no map location)"));
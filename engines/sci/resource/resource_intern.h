@@ -54,6 +54,7 @@ public:
 	bool _scanned;
 	const Common::FSNode * const _resourceFile;
 	const int _volumeNumber;
+	Common::SeekableReadStream *_preloadedData; ///< Contents of the whole volume, when preloaded
 
 protected:
 	ResourceSource(ResSourceType type, const Common::Path &name, int volNum = 0, const Common::FSNode *resFile = 0);
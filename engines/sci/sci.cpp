@@ -33,6 +33,7 @@
 #include "sci/event.h"
 
 #include "sci/engine/features.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/guest_additions.h"
 #include "sci/engine/message.h"
 #include "sci/engine/object.h"
@@ -291,6 +292,11 @@ Common::Error SciEngine::run() {
 	_scriptPatcher = new ScriptPatcher();
 	SegManager *segMan = new SegManager(_resMan, _scriptPatcher);
 
+	// Full collection stays the default until the write barriers of the
+	// incremental collector have been checked with more games
+	if (ConfMan.hasKey("incremental_gc") && ConfMan.getBool("incremental_gc"))
+		segMan->getIncrementalGC()->setMode(IncrementalGC::kModeIncremental);
+
 	// Load the Mac executable and fonts if available
 	if (getSciVersion() < SCI_VERSION_2 && getPlatform() == Common::kPlatformMacintosh) {
 		loadMacExecutable();
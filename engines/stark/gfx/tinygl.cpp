@@ -50,6 +50,7 @@ void TinyGLDriver::init() {
 	computeScreenViewport();
 
 	TinyGL::createContext(kOriginalWidth, kOriginalHeight, g_system->getScreenFormat(), 512, true, ConfMan.getBool("dirtyrects"));
+	TinyGL::enableTiledRendering(true);
 
 	tglMatrixMode(TGL_PROJECTION);
 	tglLoadIdentity();
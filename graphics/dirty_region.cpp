@@ -0,0 +1,163 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/dirty_region.h"
+
+namespace Graphics {
+
+static inline bool isTileSet(const uint32 *row, uint x) {
+	return (row[x >> 5] >> (x & 31)) & 1;
+}
+
+DirtyRegion::DirtyRegion(int tileShift) : _tileShift(tileShift), _tilesX(0), _tilesY(0), _wordsPerRow(0), _firstRow(0), _lastRow(0) {
+	assert(tileShift >= 0 && tileShift < 16);
+}
+
+void DirtyRegion::setBounds(const Common::Rect &bounds) {
+	if (bounds == _bounds)
+		return;
+
+	_bounds = bounds;
+	_tilesX = (bounds.width() + (1 << _tileShift) - 1) >> _tileShift;
+	_tilesY = (bounds.height() + (1 << _tileShift) - 1) >> _tileShift;
+	_wordsPerRow = (_tilesX + 31) >> 5;
+
+	_tiles.resize(_wordsPerRow * _tilesY);
+	for (uint i = 0; i < _tiles.size(); i++)
+		_tiles[i] = 0;
+
+	_extent = Common::Rect();
+	_firstRow = _lastRow = 0;
+}
+
+void DirtyRegion::clear() {
+	if (isEmpty())
+		return;
+
+	// Only the rows between the first and the last marked one can be set
+	for (uint i = _firstRow * _wordsPerRow; i < _lastRow * _wordsPerRow; i++)
+		_tiles[i] = 0;
+
+	_extent = Common::Rect();
+	_firstRow = _lastRow = 0;
+}
+
+void DirtyRegion::setBits(uint32 *row, uint first, uint last) {
+	const uint firstWord = first >> 5, lastWord = last >> 5;
+	const uint32 firstMask = 0xFFFFFFFF << (first & 31);
+	const uint32 lastMask = 0xFFFFFFFF >> (31 - (last & 31));
+
+	if (firstWord == lastWord) {
+		row[firstWord] |= firstMask & lastMask;
+		return;
+	}
+
+	row[firstWord] |= firstMask;
+	for (uint i = firstWord + 1; i < lastWord; i++)
+		row[i] = 0xFFFFFFFF;
+	row[lastWord] |= lastMask;
+}
+
+void DirtyRegion::addRect(const Common::Rect &r) {
+	Common::Rect rect = r;
+	rect.clip(_bounds);
+	if (rect.isEmpty())
+		return;
+
+	const uint left = (rect.left - _bounds.left) >> _tileShift;
+	const uint right = (rect.right - 1 - _bounds.left) >> _tileShift;
+	const uint top = (rect.top - _bounds.top) >> _tileShift;
+	const uint bottom = (rect.bottom - 1 - _bounds.top) >> _tileShift;
+
+	for (uint y = top; y <= bottom; y++)
+		setBits(&_tiles[y * _wordsPerRow], left, right);
+
+	if (isEmpty()) {
+		_extent = rect;
+		_firstRow = top;
+		_lastRow = bottom + 1;
+	} else {
+		_extent.extend(rect);
+		_firstRow = MIN(_firstRow, top);
+		_lastRow = MAX(_lastRow, bottom + 1);
+	}
+}
+
+void DirtyRegion::getRects(Common::List<Common::Rect> &rects) const {
+	if (isEmpty())
+		return;
+
+	// Rectangles in tile coordinates which can still grow downwards. Both
+	// these and the runs of a row are sorted from left to right.
+	Common::Array<Common::Rect> open, next;
+
+	for (uint y = _firstRow; y <= _lastRow; y++) {
+		uint current = 0;
+		next.clear();
+
+		if (y < _lastRow) {
+			const uint32 *row = &_tiles[y * _wordsPerRow];
+			uint x = 0;
+			while (x < _tilesX) {
+				if (!(x & 31) && !row[x >> 5]) {
+					x += 32;
+					continue;
+				}
+				if (!isTileSet(row, x)) {
+					x++;
+					continue;
+				}
+
+				const uint start = x;
+				while (x < _tilesX && isTileSet(row, x))
+					x++;
+
+				// Close the rectangles left of this run, and continue the
+				// one above it if it has the same horizontal extent
+				while (current < open.size() && (uint)open[current].left < start) {
+					rects.push_back(tilesToPixels(open[current]));
+					current++;
+				}
+				if (current < open.size() && (uint)open[current].left == start && (uint)open[current].right == x) {
+					next.push_back(open[current]);
+					next.back().bottom = y + 1;
+					current++;
+				} else {
+					next.push_back(Common::Rect(start, y, x, y + 1));
+				}
+			}
+		}
+
+		while (current < open.size())
+			rects.push_back(tilesToPixels(open[current++]));
+
+		open.swap(next);
+	}
+}
+
+Common::Rect DirtyRegion::tilesToPixels(const Common::Rect &tiles) const {
+	Common::Rect rect(_bounds.left + (tiles.left << _tileShift), _bounds.top + (tiles.top << _tileShift),
+	                  _bounds.left + (tiles.right << _tileShift), _bounds.top + (tiles.bottom << _tileShift));
+	rect.clip(_extent);
+	return rect;
+}
+
+} // End of namespace Graphics
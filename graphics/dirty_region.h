@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * @defgroup graphics_dirty_region Dirty region
+ * @ingroup graphics
+ *
+ * @brief Tile based tracking of the modified areas of a surface.
+ *
+ * @{
+ */
+
+/**
+ * Collects dirty rectangles into a bitmap of fixed size tiles.
+ *
+ * Adding a rectangle only sets the bits of the tiles it covers, so the cost
+ * does not grow with the number of rectangles already added. The region is
+ * turned back into rectangles by getRects(), which joins horizontally adjacent
+ * dirty tiles into runs and stacks runs with the same extent on consecutive
+ * tile rows into a single rectangle.
+ *
+ * The resulting rectangles cover every added rectangle, rounded out to tile
+ * boundaries and clipped to the bounding box of everything added.
+ */
+class DirtyRegion {
+public:
+	DirtyRegion(int tileShift = 4);
+
+	/**
+	 * Set the area covered by the region. Rectangles outside of it are
+	 * clipped. Changing the bounds clears the region.
+	 */
+	void setBounds(const Common::Rect &bounds);
+	const Common::Rect &getBounds() const { return _bounds; }
+
+	/** Mark the given area as dirty. */
+	void addRect(const Common::Rect &r);
+
+	/** Mark the whole region as dirty. */
+	void addAll() { addRect(_bounds); }
+
+	/** Return true if nothing has been marked since the last clear(). */
+	bool isEmpty() const { return _extent.isEmpty(); }
+
+	/** Return the bounding box of all the areas marked since the last clear(). */
+	const Common::Rect &getExtent() const { return _extent; }
+
+	void clear();
+
+	/** Append the coalesced dirty rectangles. */
+	void getRects(Common::List<Common::Rect> &rects) const;
+
+private:
+	void setBits(uint32 *row, uint first, uint last);
+	Common::Rect tilesToPixels(const Common::Rect &tiles) const;
+
+	Common::Rect _bounds;
+	Common::Rect _extent;
+	int _tileShift;
+	uint _tilesX, _tilesY;
+	uint _wordsPerRow;
+	Common::Array<uint32> _tiles;
+	uint _firstRow, _lastRow;
+};
+
+/** @} */
+
+} // End of namespace Graphics
+
+#endif
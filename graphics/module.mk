@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	blit/blit-generic.o \
 	blit/blit-scale.o \
 	cursorman.o \
+	dirty_region.o \
 	font.o \
 	fontman.o \
 	fonts/amigafont.o \
@@ -95,7 +96,21 @@ MODULE_OBJS += \
 	tinygl/zmath.o \
 	tinygl/ztriangle.o \
 	tinygl/zblit.o \
-	tinygl/zdirtyrect.o
+	tinygl/zdirtyrect.o \
+	tinygl/zspan.o
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	tinygl/zspan_neon.o
+endif
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	tinygl/zspan_sse2.o
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	tinygl/zspan_avx2.o
+endif
 endif
 
 ifdef USE_ASPECT
@@ -145,15 +160,18 @@ endif
 
 ifdef SCUMMVM_NEON
 MODULE_OBJS += \
-	blit/blit-neon.o
+	blit/blit-neon.o \
+	yuv_to_rgb_neon.o
 endif
 ifdef SCUMMVM_SSE2
 MODULE_OBJS += \
-	blit/blit-sse2.o
+	blit/blit-sse2.o \
+	yuv_to_rgb_sse2.o
 endif
 ifdef SCUMMVM_AVX2
 MODULE_OBJS += \
-	blit/blit-avx2.o
+	blit/blit-avx2.o \
+	yuv_to_rgb_avx2.o
 endif
 
 # Include common rules
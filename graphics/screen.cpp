@@ -76,25 +76,23 @@ void Screen::makeAllDirty() {
 }
 
 void Screen::mergeDirtyRects() {
-	Common::List<Common::Rect>::iterator rOuter, rInner;
+	// A single rect is already as merged as it gets
+	if (_dirtyRects.empty() || ++_dirtyRects.begin() == _dirtyRects.end())
+		return;
 
-	// Process the dirty rect list to find any rects to merge
-	for (rOuter = _dirtyRects.begin(); rOuter != _dirtyRects.end(); ++rOuter) {
-		rInner = rOuter;
-		while (++rInner != _dirtyRects.end()) {
-
-			if ((*rOuter).intersects(*rInner)) {
-				// These two rectangles overlap, so merge them
-				unionRectangle(*rOuter, *rOuter, *rInner);
+	Common::Rect bounds = getBounds();
+	bounds.translate(getOffsetFromOwner().x, getOffsetFromOwner().y);
+	_dirtyRegion.setBounds(bounds);
 
-				// remove the inner rect from the list
-				_dirtyRects.erase(rInner);
+	// Mark the tiles covered by each rect, and read back a few larger
+	// rects that cover all of them
+	Common::List<Common::Rect>::const_iterator i;
+	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+		_dirtyRegion.addRect(*i);
 
-				// move back to beginning of list
-				rInner = rOuter;
-			}
-		}
-	}
+	_dirtyRects.clear();
+	_dirtyRegion.getRects(_dirtyRects);
+	_dirtyRegion.clear();
 }
 
 bool Screen::unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2) {
@@ -22,6 +22,7 @@
 #ifndef GRAPHICS_SCREEN_H
 #define GRAPHICS_SCREEN_H
 
+#include "graphics/dirty_region.h"
 #include "graphics/managed_surface.h"
 #include "graphics/palette.h"
 #include "graphics/pixelformat.h"
@@ -51,9 +52,14 @@ protected:
 	 * List of affected areas of the screen
 	 */
 	Common::List<Common::Rect> _dirtyRects;
+
+	/**
+	 * Tile bitmap used to coalesce the dirty rects
+	 */
+	DirtyRegion _dirtyRegion;
 protected:
 	/**
-	 * Merges together overlapping dirty areas of the screen
+	 * Merges together overlapping and neighboring dirty areas of the screen
 	 */
 	void mergeDirtyRects();
 
@@ -150,6 +150,8 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	GLViewport *v;
 
 	_enableDirtyRectangles = dirtyRectsEnable;
+	_tilePool = nullptr;
+	_isTileContext = false;
 	stencil_buffer_supported = enableStencilBuffer;
 
 	fb = new TinyGL::FrameBuffer(screenW, screenH, pixelFormat, enableStencilBuffer);
@@ -358,10 +360,11 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
 
-	TinyGL::Internal::tglBlitResetScissorRect();
+	TinyGL::Internal::tglBlitResetScissorRect(this);
 }
 
 void GLContext::deinit() {
+	enableTiledRendering(false, 0);
 	disposeDrawCallLists();
 	disposeResources();
 
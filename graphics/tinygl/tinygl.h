@@ -39,6 +39,13 @@ void destroyContext(ContextHandle *handle);
 void setContext(ContextHandle *handle);
 void presentBuffer();
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas);
+/**
+ * Split the framebuffer into bands drawn concurrently on worker threads
+ * when a frame is presented. By default there is one thread less than there
+ * are CPU cores, and nothing changes if there are none. Must not be called
+ * while a frame is being recorded.
+ */
+void enableTiledRendering(bool enable, int numThreads = -1);
 void getSurfaceRef(Graphics::Surface &surface);
 Graphics::Surface *copyFromFrameBuffer(const Graphics::PixelFormat &dstFormat);
 
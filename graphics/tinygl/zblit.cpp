@@ -214,8 +214,7 @@ public:
 
 	// Blits an image to the z buffer.
 	// The function only supports clipped blitting without any type of transformation or tinting.
-	void tglBlitZBuffer(int dstX, int dstY) {
-		TinyGL::GLContext *c = TinyGL::gl_get_context();
+	void tglBlitZBuffer(GLContext *c, int dstX, int dstY) {
 		assert(_zBuffer);
 
 		int clampWidth, clampHeight;
@@ -240,50 +239,50 @@ public:
 		}
 	}
 
-	void tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight);
+	void tglBlitOpaque(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight);
 
 	template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
-	void tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitRLE(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitSimple(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitRotoScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
+	void tglBlitRotoScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
 	                      int originX, int originY, float aTint, float rTint, float gTint, float bTint);
 
 	//Utility function that calls the correct blitting function.
 	template <bool kDisableBlending, bool kDisableColoring, bool kDisableTransform, bool kFlipVertical, bool kFlipHorizontal, bool kEnableAlphaBlending, bool kEnableOpaqueBlit>
-	void tglBlitGeneric(const BlitTransform &transform) {
+	void tglBlitGeneric(GLContext *c, const BlitTransform &transform) {
 		assert(!_zBuffer);
 
 		if (kDisableTransform) {
 			if (kEnableOpaqueBlit && kDisableColoring && kFlipVertical == false && kFlipHorizontal == false) {
-				tglBlitOpaque(transform._destinationRectangle.left, transform._destinationRectangle.top,
+				tglBlitOpaque(c, transform._destinationRectangle.left, transform._destinationRectangle.top,
 					transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height());
 			} else if ((kDisableBlending || kEnableAlphaBlending) && kFlipVertical == false && kFlipHorizontal == false) {
-				tglBlitRLE<kDisableColoring, kDisableBlending, kEnableAlphaBlending>(transform._destinationRectangle.left,
+				tglBlitRLE<kDisableColoring, kDisableBlending, kEnableAlphaBlending>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height(), transform._aTint,
 					transform._rTint, transform._gTint, transform._bTint);
 			} else {
-				tglBlitSimple<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitSimple<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height(),
 					transform._aTint, transform._rTint, transform._gTint, transform._bTint);
 			}
 		} else {
 			if (transform._rotation == 0) {
-				tglBlitScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._destinationRectangle.width(), transform._destinationRectangle.height(),
 					transform._sourceRectangle.left, transform._sourceRectangle.top, transform._sourceRectangle.width(), transform._sourceRectangle.height(),
 					transform._aTint, transform._rTint, transform._gTint, transform._bTint);
 			} else {
-				tglBlitRotoScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitRotoScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._destinationRectangle.width(), transform._destinationRectangle.height(),
 					transform._sourceRectangle.left, transform._sourceRectangle.top, transform._sourceRectangle.width(),
 					transform._sourceRectangle.height(), transform._rotation, transform._originX, transform._originY, transform._aTint,
@@ -346,9 +345,7 @@ void tglDeleteBlitImage(TinyGL::BlitImage *blitImage) {
 
 namespace TinyGL {
 
-void BlitImage::tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight) {
-	GLContext *c = gl_get_context();
-
+void BlitImage::tglBlitOpaque(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight) {
 	int clampWidth, clampHeight;
 	int width = srcWidth, height = srcHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
@@ -367,9 +364,7 @@ void BlitImage::tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWid
 // This blit only supports tinting but it will fall back to simpleBlit
 // if flipping is required (or anything more complex than that, including rotationd and scaling).
 template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
-void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
-
+void BlitImage::tglBlitRLE(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
 	int clampWidth, clampHeight;
 	int width = srcWidth, height = srcHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
@@ -454,9 +449,7 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 
 // This blit function is called when flipping is needed but transformation isn't.
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
-
+void BlitImage::tglBlitSimple(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
 	int clampWidth, clampHeight;
 	int width = srcWidth, height = srcHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
@@ -508,10 +501,8 @@ void BlitImage::tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWid
 // This function is called when scale is needed: it uses a simple nearest
 // filter to scale the blit image before copying it to the screen.
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight,
+void BlitImage::tglBlitScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight,
 	                     float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
-
 	int clampWidth, clampHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
 		return;
@@ -598,10 +589,8 @@ systems.
 */
 
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
+void BlitImage::tglBlitRotoScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
 	                         int originX, int originY, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
-
 	int clampWidth, clampHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
 		return;
@@ -713,58 +702,57 @@ namespace TinyGL {
 namespace Internal {
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor, bool kDisableTransform, bool kDisableBlend>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform) {
 	if (transform._flipHorizontally) {
 		if (transform._flipVertically) {
-			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, true, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, true, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 		} else {
-			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, true, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, true, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 		}
 	} else if (transform._flipVertically) {
-		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, false, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, false, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 	} else {
-		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, false, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, false, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor, bool kDisableTransform>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableBlend) {
 	if (disableBlend) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, true>(blitImage, transform);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, true>(c, blitImage, transform);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, false>(blitImage, transform);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, false>(c, blitImage, transform);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableTransform, bool disableBlend) {
 	if (disableTransform) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, true>(blitImage, transform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, true>(c, blitImage, transform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, false>(blitImage, transform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, false>(c, blitImage, transform, disableBlend);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableColor, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableColor, bool disableTransform, bool disableBlend) {
 	if (disableColor) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, true>(blitImage, transform, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, true>(c, blitImage, transform, disableTransform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, false>(blitImage, transform, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, false>(c, blitImage, transform, disableTransform, disableBlend);
 	}
 }
 
 template <bool kEnableAlphaBlending>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool enableOpaqueBlit, bool disableColor, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool enableOpaqueBlit, bool disableColor, bool disableTransform, bool disableBlend) {
 	if (enableOpaqueBlit) {
-		tglBlit<kEnableAlphaBlending, true>(blitImage, transform, disableColor, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, true>(c, blitImage, transform, disableColor, disableTransform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, false>(blitImage, transform, disableColor, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, false>(c, blitImage, transform, disableColor, disableTransform, disableBlend);
 	}
 }
 
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
-	GLContext *c = gl_get_context();
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform) {
 	bool disableColor = transform._aTint == 1.0f && transform._bTint == 1.0f && transform._gTint == 1.0f && transform._rTint == 1.0f;
 	bool disableTransform = transform._destinationRectangle.width() == 0 && transform._destinationRectangle.height() == 0 && transform._rotation == 0;
 	bool disableBlend = c->blending_enabled == false;
@@ -774,23 +762,23 @@ void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
 	                    && (c->destination_blending_factor == TGL_ZERO || c->destination_blending_factor == TGL_ONE_MINUS_SRC_ALPHA);
 
 	if (enableAlphaBlending) {
-		tglBlit<true>(blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
+		tglBlit<true>(c, blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
 	} else {
-		tglBlit<false>(blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
+		tglBlit<false>(c, blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
 	}
 }
 
-void tglBlitFast(BlitImage *blitImage, int x, int y) {
+void tglBlitFast(GLContext *c, BlitImage *blitImage, int x, int y) {
 	BlitTransform transform(x, y);
 	if (blitImage->isOpaque()) {
-		blitImage->tglBlitGeneric<true, true, true, false, false, false, true>(transform);
+		blitImage->tglBlitGeneric<true, true, true, false, false, false, true>(c, transform);
 	} else {
-		blitImage->tglBlitGeneric<true, true, true, false, false, false, false>(transform);
+		blitImage->tglBlitGeneric<true, true, true, false, false, false, false>(c, transform);
 	}
 }
 
-void tglBlitZBuffer(BlitImage *blitImage, int x, int y) {
-	blitImage->tglBlitZBuffer(x, y);
+void tglBlitZBuffer(GLContext *c, BlitImage *blitImage, int x, int y) {
+	blitImage->tglBlitZBuffer(c, x, y);
 }
 
 void tglCleanupImages() {
@@ -806,12 +794,11 @@ void tglCleanupImages() {
 	}
 }
 
-void tglBlitSetScissorRect(const Common::Rect &rect) {
-	gl_get_context()->_scissorRect = rect;
+void tglBlitSetScissorRect(GLContext *c, const Common::Rect &rect) {
+	c->_scissorRect = rect;
 }
 
-void tglBlitResetScissorRect() {
-	GLContext *c = gl_get_context();
+void tglBlitResetScissorRect(GLContext *c) {
 	c->_scissorRect = c->renderRect;
 }
 
@@ -30,6 +30,7 @@
 namespace TinyGL {
 
 struct BlitImage;
+struct GLContext;
 
 namespace Internal {
 	/**
@@ -38,18 +39,18 @@ namespace Internal {
 	void tglCleanupImages(); // This function checks if any blit image is to be cleaned up and deletes it.
 
 	// Documentation for those is the same as the one before, only those function are the one that actually execute the correct code path.
-	void tglBlit(BlitImage *blitImage, const BlitTransform &transform);
+	void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform);
 
 	// Disables blending, transforms and tinting.
-	void tglBlitFast(BlitImage *blitImage, int x, int y);
+	void tglBlitFast(GLContext *c, BlitImage *blitImage, int x, int y);
 
-	void tglBlitZBuffer(BlitImage *blitImage, int x, int y);
+	void tglBlitZBuffer(GLContext *c, BlitImage *blitImage, int x, int y);
 
 	/**
-	@brief Sets up a scissor rectangle for blit calls: every blit call is affected by this rectangle.
+	@brief Sets up a scissor rectangle for blit calls: every blit call drawing with the context @p c is affected by this rectangle.
 	*/
-	void tglBlitSetScissorRect(const Common::Rect &rect);
-	void tglBlitResetScissorRect();
+	void tglBlitSetScissorRect(GLContext *c, const Common::Rect &rect);
+	void tglBlitResetScissorRect(GLContext *c);
 } // end of namespace Internal
 
 } // end of namespace TinyGL
@@ -49,6 +49,7 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 		_sbuf = (byte *)gl_zalloc(_pbufWidth * _pbufHeight * sizeof(byte));
 	else
 		_sbuf = nullptr;
+	_ownsBuffers = true;
 
 	_offscreenBuffer.pbuf = _pbuf;
 	_offscreenBuffer.zbuf = _zbuf;
@@ -56,9 +57,21 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_currentTexture = nullptr;
 
 	_enableScissor = false;
+
+	_spanFormat = SpanState();
+	_spanFormat.rLoss = _pbufFormat.rLoss;
+	_spanFormat.gLoss = _pbufFormat.gLoss;
+	_spanFormat.bLoss = _pbufFormat.bLoss;
+	_spanFormat.aLoss = _pbufFormat.aLoss;
+	_spanFormat.rShift = _pbufFormat.rShift;
+	_spanFormat.gShift = _pbufFormat.gShift;
+	_spanFormat.bShift = _pbufFormat.bShift;
+	_spanFormat.aShift = _pbufFormat.aShift;
 }
 
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
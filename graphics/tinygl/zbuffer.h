@@ -31,6 +31,7 @@
 #include "graphics/surface.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/zspan.h"
 
 #include "common/rect.h"
 #include "common/textconsole.h"
@@ -107,6 +108,16 @@ struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
 	~FrameBuffer();
 
+	/**
+	 * Create a framebuffer which draws into the buffers of this one, with its
+	 * own copy of the rasterizer state. The buffers stay owned by this one.
+	 */
+	FrameBuffer *createView() const {
+		FrameBuffer *view = new FrameBuffer(*this);
+		view->_ownsBuffers = false;
+		return view;
+	}
+
 	Graphics::PixelFormat getPixelFormat() {
 		return _pbufFormat;
 	}
@@ -764,6 +775,7 @@ private:
 
 	uint *_zbuf;
 	byte *_sbuf;
+	bool _ownsBuffers;
 
 	bool _enableStencil;
 	int _textureSize;
@@ -772,6 +784,9 @@ private:
 	Common::Rect _clipRectangle;
 	bool _enableScissor;
 
+	// Framebuffer format part of the state passed to SpanFill
+	SpanState _spanFormat;
+
 	const TexelBuffer *_currentTexture;
 	uint _wrapS, _wrapT;
 	bool _blendingEnabled;
@@ -22,13 +22,15 @@
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/zspan.h"
 
 #include "common/debug.h"
+#include "common/threadpool.h"
 
 namespace TinyGL {
 
 void GLContext::issueDrawCall(DrawCall *drawCall) {
-	if (_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
+	if (computesDirtyRegions() && drawCall->getDirtyRegion().isEmpty())
 		return;
 	_drawCallsQueue.push_back(drawCall);
 }
@@ -115,6 +117,7 @@ static inline void _appendDirtyRectangle(const DrawCall &call, Common::List<Dirt
 void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas) {
 	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
 	typedef Common::List<DirtyRectangle>::iterator RectangleIterator;
+	typedef Common::List<Common::Rect>::const_iterator MergedRectangleIterator;
 
 	Common::List<DirtyRectangle> rectangles;
 
@@ -143,70 +146,41 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		_appendDirtyRectangle(**itFrame, rectangles, 255, 0, 0);
 	}
 
-	// This loop increases outer rectangle coordinates to favor merging of adjacent rectangles.
+	// Coalesce the dirty rects on a tile grid.
+	_dirtyRegion.setBounds(renderRect);
 	for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
-		(*it).rectangle.right++;
-		(*it).rectangle.bottom++;
+		_dirtyRegion.addRect((*it).rectangle);
 	}
 
-	// Merge coalesce dirty rects.
-	bool restartMerge;
-	do {
-		restartMerge = false;
-		for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-			for (RectangleIterator it2 = rectangles.begin(); it2 != rectangles.end();) {
-				if (it1 != it2) {
-					if ((*it1).rectangle.intersects((*it2).rectangle)) {
-						(*it1).rectangle.extend((*it2).rectangle);
-						it2 = rectangles.erase(it2);
-						restartMerge = true;
-					} else {
-						++it2;
-					}
-				} else {
-					++it2;
-				}
-			}
-		}
-	} while(restartMerge);
-
-	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-		RectangleIterator it2 = it1;
-		it2++;
-		while (it2 != rectangles.end()) {
-			if ((*it1).rectangle.contains((*it2).rectangle)) {
-				it2 = rectangles.erase(it2);
-			} else {
-				++it2;
-			}
-		}
-	}
+	Common::List<Common::Rect> mergedRectangles;
+	_dirtyRegion.getRects(mergedRectangles);
+	_dirtyRegion.clear();
 
-	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-		(*it1).rectangle.clip(renderRect);
-	}
-
-	if (!rectangles.empty()) {
-		for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-			dirtyAreas.push_back((*itRect).rectangle);
+	if (!mergedRectangles.empty()) {
+		for (MergedRectangleIterator itRect = mergedRectangles.begin(); itRect != mergedRectangles.end(); ++itRect) {
+			dirtyAreas.push_back(*itRect);
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+		if (_tilePool && render_mode == TGL_RENDER) {
+			executeDrawCallsTiled(mergedRectangles);
+		} else {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (MergedRectangleIterator itRect = mergedRectangles.begin(); itRect != mergedRectangles.end(); ++itRect) {
+					const Common::Rect &dirtyRegion = *itRect;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(this, dirtyRegion, true);
+					}
 				}
 			}
 		}
 
 		if (_debugRectsEnabled) {
 			// Draw debug rectangles.
-			// Note: white rectangles are rectangle that contained other rectangles
-			// blue rectangles are rectangle merged from other rectangles
-			// red rectangles are original dirty rects
+			// Note: white rectangles are the areas of the previous frame draw calls
+			// red rectangles are the areas of the current frame draw calls
+			// blue rectangles are the merged areas that were redrawn
 
 			fb->enableBlending(false);
 			fb->enableAlphaTest(false);
@@ -214,6 +188,9 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 			for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
 				debugDrawRectangle((*it).rectangle, (*it).r, (*it).g, (*it).b);
 			}
+			for (MergedRectangleIterator it = mergedRectangles.begin(); it != mergedRectangles.end(); ++it) {
+				debugDrawRectangle(*it, 0, 0, 255);
+			}
 
 			fb->enableBlending(blending_enabled);
 			fb->enableAlphaTest(alpha_test_enabled);
@@ -237,10 +214,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
 
-	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
+	const Common::Rect frameRect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight());
+	dirtyAreas.push_back(frameRect);
+
+	if (_tilePool && render_mode == TGL_RENDER) {
+		Common::List<Common::Rect> regions;
+		regions.push_back(frameRect);
+		executeDrawCallsTiled(regions);
+	} else {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			(*it)->execute(this, true);
+		}
+	}
 
 	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
 		delete *it;
 	}
 
@@ -251,6 +238,111 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+void GLContext::executeDrawCallsTiled(const Common::List<Common::Rect> &regions) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::List<Common::Rect>::const_iterator RectangleIterator;
+
+	// Pick the span filler before the tiles use it
+	if (!SpanFill::fillFunc)
+		SpanFill::selectFillFunc();
+
+	// State the rasterizer reads which is not part of the draw calls
+	for (uint i = 0; i < _tileContexts.size(); i++) {
+		GLContext *tile = _tileContexts[i];
+		tile->renderRect = renderRect;
+		tile->current_cull_face = current_cull_face;
+		tile->vertex_n = vertex_n;
+	}
+
+	DrawCallIterator begin = _drawCallsQueue.begin();
+	while (begin != _drawCallsQueue.end()) {
+		DrawCallIterator end = begin;
+		while (end != _drawCallsQueue.end() && (*end)->clipsExactly())
+			++end;
+
+		if (begin != end) {
+			_tilePool->parallelFor(_tileContexts.size(), [this, begin, end, &regions](uint tile) {
+				executeTile(tile, begin, end, regions);
+			});
+		}
+
+		// Draw calls which cannot be split run on the whole framebuffer,
+		// between the tiled runs of the ones before and after them
+		if (end != _drawCallsQueue.end()) {
+			const Common::Rect drawCallRegion = (*end)->getDirtyRegion();
+			for (RectangleIterator itRect = regions.begin(); itRect != regions.end(); ++itRect) {
+				if (itRect->intersects(drawCallRegion)) {
+					(*end)->execute(this, *itRect, true);
+				}
+			}
+			++end;
+		}
+
+		begin = end;
+	}
+}
+
+void GLContext::executeTile(uint tile, Common::List<DrawCall *>::const_iterator begin, Common::List<DrawCall *>::const_iterator end,
+                            const Common::List<Common::Rect> &regions) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::List<Common::Rect>::const_iterator RectangleIterator;
+
+	GLContext *c = _tileContexts[tile];
+	const int width = fb->getPixelBufferWidth();
+	const int height = fb->getPixelBufferHeight();
+	const Common::Rect band(0, height * tile / _tileContexts.size(), width, height * (tile + 1) / _tileContexts.size());
+
+	Common::Array<Common::Rect> clippingRectangles;
+	for (RectangleIterator itRect = regions.begin(); itRect != regions.end(); ++itRect) {
+		if (band.intersects(*itRect))
+			clippingRectangles.push_back(band.findIntersectingRect(*itRect));
+	}
+
+	for (DrawCallIterator it = begin; it != end; ++it) {
+		const Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		for (uint i = 0; i < clippingRectangles.size(); i++) {
+			if (clippingRectangles[i].intersects(drawCallRegion)) {
+				(*it)->execute(c, clippingRectangles[i], false);
+			}
+		}
+	}
+}
+
+void GLContext::enableTiledRendering(bool enable, int numThreads) {
+	for (uint i = 0; i < _tileContexts.size(); i++) {
+		GLContext *tile = _tileContexts[i];
+		gl_free(tile->vertex);
+		delete tile->fb;
+		delete tile;
+	}
+	_tileContexts.clear();
+	delete _tilePool;
+	_tilePool = nullptr;
+
+	if (!enable)
+		return;
+
+	_tilePool = new Common::ThreadPool(numThreads);
+	if (!_tilePool->getNumThreads()) {
+		// Tiles would only be drawn one after another
+		delete _tilePool;
+		_tilePool = nullptr;
+		return;
+	}
+
+	// A few bands per thread, so that the threads stay busy when some parts
+	// of the frame take longer to draw than others
+	const uint tileCount = MIN<uint>((_tilePool->getNumThreads() + 1) * 2, MAX(1, fb->getPixelBufferHeight() / 16));
+	for (uint i = 0; i < tileCount; i++) {
+		// The rest of the state is set by the draw calls, or copied when they are executed
+		GLContext *tile = new GLContext();
+		tile->fb = fb->createView();
+		tile->render_mode = TGL_RENDER;
+		tile->_isTileContext = true;
+		_tileContexts.push_back(tile);
+	}
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
@@ -265,6 +357,10 @@ void presentBuffer() {
 	presentBuffer(dirtyAreas);
 }
 
+void enableTiledRendering(bool enable, int numThreads) {
+	gl_get_context()->enableTiledRendering(enable, numThreads);
+}
+
 bool DrawCall::operator==(const DrawCall &other) const {
 	if (_type == other._type) {
 		switch (_type) {
@@ -293,8 +389,8 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	_state = captureState(c);
+	if (c->computesDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -332,19 +428,29 @@ void RasterizationDrawCall::computeDirtyRegion() {
 	}
 }
 
-void RasterizationDrawCall::execute(bool restoreState) const {
-	GLContext *c = gl_get_context();
-
+void RasterizationDrawCall::execute(GLContext *c, bool restoreState) const {
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
-	c->vertex = _vertex;
+	if (c->_isTileContext) {
+		// Drawing modifies the vertices, so the contexts of tiles drawn
+		// concurrently each use their own copy
+		if (c->vertex_max < _vertexCount) {
+			gl_free(c->vertex);
+			c->vertex = (GLVertex *)gl_malloc(_vertexCount * sizeof(GLVertex));
+			c->vertex_max = _vertexCount;
+			prevVertex = c->vertex;
+		}
+		memcpy(c->vertex, _vertex, sizeof(GLVertex) * _vertexCount);
+	} else {
+		c->vertex = _vertex;
+	}
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
@@ -428,13 +534,12 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	c->vertex_cnt = prevVertexCount;
 
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) const {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -485,8 +590,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -549,10 +653,9 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	memcpy(c->viewport.trans._v, state.viewportTranslation, sizeof(c->viewport.trans._v));
 }
 
-void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void RasterizationDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	c->fb->setScissorRectangle(clippingRectangle);
-	execute(restoreState);
+	execute(c, restoreState);
 	c->fb->resetScissorRectangle();
 }
 
@@ -573,10 +676,11 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 
 
 BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode) : DrawCall(DrawCall_Blitting), _transform(transform), _mode(blittingMode), _image(image) {
+	GLContext *c = gl_get_context();
 	tglIncBlitImageRef(image);
-	_blitState = captureState();
+	_blitState = captureState(c);
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	if (c->computesDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -585,40 +689,46 @@ BlittingDrawCall::~BlittingDrawCall() {
 	tglDeleteBlitImage(_image);
 }
 
-void BlittingDrawCall::execute(bool restoreState) const {
+void BlittingDrawCall::execute(GLContext *c, bool restoreState) const {
 	BlittingState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_blitState);
+	applyState(c, _blitState);
 
 	switch (_mode) {
 	case BlittingDrawCall::BlitMode_Regular:
-		Internal::tglBlit(_image, _transform);
+		Internal::tglBlit(c, _image, _transform);
 		break;
 	case BlittingDrawCall::BlitMode_Fast:
-		Internal::tglBlitFast(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitFast(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	case BlittingDrawCall::BlitMode_ZBuffer:
-		Internal::tglBlitZBuffer(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitZBuffer(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	default:
 		break;
 	}
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	Internal::tglBlitSetScissorRect(clippingRectangle);
-	execute(restoreState);
-	Internal::tglBlitResetScissorRect();
+void BlittingDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
+	Internal::tglBlitSetScissorRect(c, clippingRectangle);
+	execute(c, restoreState);
+	Internal::tglBlitResetScissorRect(c);
+}
+
+bool BlittingDrawCall::clipsExactly() const {
+	// Scaled, rotated and flipped blits are clipped as if they were not
+	return _mode != BlitMode_Regular ||
+		(_transform._destinationRectangle.width() == 0 && _transform._destinationRectangle.height() == 0 &&
+		 _transform._rotation == 0 && !_transform._flipHorizontally && !_transform._flipVertically);
 }
 
-BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
+BlittingDrawCall::BlittingState BlittingDrawCall::captureState(GLContext *c) const {
 	BlittingState state;
-	TinyGL::GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -629,8 +739,7 @@ BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	return state;
 }
 
-void BlittingDrawCall::applyState(const BlittingState &state) const {
-	TinyGL::GLContext *c = gl_get_context();
+void BlittingDrawCall::applyState(GLContext *c, const BlittingState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -693,18 +802,16 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->computesDirtyRegions()) {
 		_dirtyRegion = c->renderRect;
 	}
 }
 
-void ClearBufferDrawCall::execute(bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, bool restoreState) const {
 	c->fb->clear(_clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue, _clearStencilBuffer, _stencilValue);
 }
 
-void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	Common::Rect clearRect = clippingRectangle.findIntersectingRect(getDirtyRegion());
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(),
 	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
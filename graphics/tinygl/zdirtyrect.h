@@ -53,8 +53,10 @@ public:
 	bool operator!=(const DrawCall &other) const {
 		return !(*this == other);
 	}
-	virtual void execute(bool restoreState) const = 0;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	// Whether executing the call clipped to several rectangles draws the same pixels as executing it once clipped to their union
+	virtual bool clipsExactly() const { return true; }
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
 protected:
@@ -68,8 +70,8 @@ public:
 	ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue, bool clearStencilBuffer, int stencilValue);
 	virtual ~ClearBufferDrawCall() { }
 	bool operator==(const ClearBufferDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -87,8 +89,8 @@ public:
 	RasterizationDrawCall();
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -152,8 +154,8 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	RasterizationState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -168,8 +170,9 @@ public:
 	BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode);
 	virtual ~BlittingDrawCall();
 	bool operator==(const BlittingDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool clipsExactly() const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -204,8 +207,8 @@ private:
 		}
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	BlittingState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const BlittingState &state) const;
 
 	BlittingState _blitState;
 };
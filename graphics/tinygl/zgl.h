@@ -34,6 +34,7 @@
 #include "common/list.h"
 #include "common/scummsys.h"
 
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 #include "graphics/tinygl/gl.h"
@@ -43,6 +44,10 @@
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/texelbuffer.h"
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace TinyGL {
 
 enum {
@@ -452,6 +457,12 @@ struct GLContext {
 
 	bool _enableDirtyRectangles;
 
+	// tiled rendering: the framebuffer is split into horizontal bands, each
+	// drawn by its own context on the worker threads of the pool
+	Common::ThreadPool *_tilePool;
+	Common::Array<GLContext *> _tileContexts;
+	bool _isTileContext;
+
 	// stipple
 	bool polygon_stipple_enabled;
 	byte polygon_stipple_pattern[128];
@@ -464,6 +475,7 @@ struct GLContext {
 	Common::List<DrawCall *> _previousFrameDrawCallsQueue;
 	int _currentAllocatorIndex;
 	LinearAllocator _drawCallAllocator[2];
+	Graphics::DirtyRegion _dirtyRegion;
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
@@ -524,6 +536,16 @@ public:
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
 
+	void enableTiledRendering(bool enable, int numThreads);
+	bool computesDirtyRegions() const {
+		return _enableDirtyRectangles || _tilePool;
+	}
+	/** Run the draw calls of the current frame on the tile contexts, clipped to the given regions. */
+	void executeDrawCallsTiled(const Common::List<Common::Rect> &regions);
+	/** Run the draw calls from @p begin to @p end clipped to one band, on the context of the band. */
+	void executeTile(uint tile, Common::List<DrawCall *>::const_iterator begin, Common::List<DrawCall *>::const_iterator end,
+	                 const Common::List<Common::Rect> &regions);
+
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
 	GLSpecBuf *specbuf_get_buffer(const int shininess_i, const float shininess);
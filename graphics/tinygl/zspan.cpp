@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/system.h"
+
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+SpanFill::FillFunc SpanFill::fillFunc = nullptr;
+
+void SpanFill::selectFillFunc() {
+	fillFunc = fillGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) fillFunc = fillNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) fillFunc = fillSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) fillFunc = fillAVX2;
+#endif
+}
+
+void SpanFill::fillGeneric(uint32 *pixels, uint *zbuf, int count, const SpanState &state) {
+	uint32 z = state.z, r = state.r, g = state.g, b = state.b, a = state.a;
+
+	for (int i = 0; i < count; i++) {
+		bool depthTestResult;
+		switch (state.depthMode) {
+		case SpanState::kDepthLess:
+			depthTestResult = zbuf[i] < z;
+			break;
+		case SpanState::kDepthLessEqual:
+			depthTestResult = zbuf[i] <= z;
+			break;
+		default:
+			depthTestResult = true;
+			break;
+		}
+
+		if (depthTestResult) {
+			// Depth goes through a float, like in FrameBuffer::writePixel()
+			if (state.depthWrite)
+				zbuf[i] = (uint)(float)z;
+
+			const byte cr = r >> (ZB_POINT_RED_BITS - 8);
+			const byte cg = g >> (ZB_POINT_GREEN_BITS - 8);
+			const byte cb = b >> (ZB_POINT_BLUE_BITS - 8);
+			const byte ca = a >> (ZB_POINT_ALPHA_BITS - 8);
+			pixels[i] = ((ca >> state.aLoss) << state.aShift) |
+			            ((cr >> state.rLoss) << state.rShift) |
+			            ((cg >> state.gLoss) << state.gShift) |
+			            ((cb >> state.bLoss) << state.bShift);
+		}
+
+		z += state.dzdx;
+		r += state.drdx;
+		g += state.dgdx;
+		b += state.dbdx;
+		a += state.dadx;
+	}
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H_
+#define GRAPHICS_TINYGL_ZSPAN_H_
+
+#include "common/scummsys.h"
+
+namespace TinyGL {
+
+/**
+ * Interpolation and output state of a span handled by SpanFill.
+ *
+ * Spans are Gouraud shaded, opaque and written to a 32bpp framebuffer,
+ * without stencil, stipple, alpha test or fog. They are clipped to the
+ * scissor rectangle by the caller. Everything else
+ * stays with the scalar fillTriangle() templates, which are the reference
+ * for these kernels.
+ */
+struct SpanState {
+	enum DepthMode {
+		kDepthAlways,
+		kDepthLess,
+		kDepthLessEqual
+	};
+
+	// Depth values use ZB_Z_BITS + ZB_POINT_Z_FRAC_BITS bits, so they can
+	// be compared and converted as signed integers.
+	uint32 z, dzdx;
+	uint32 r, g, b, a;
+	uint32 drdx, dgdx, dbdx, dadx;
+
+	DepthMode depthMode;
+	bool depthWrite;
+
+	// Conversion from the 8 bit components to the framebuffer format
+	byte rLoss, gLoss, bLoss, aLoss;
+	byte rShift, gShift, bShift, aShift;
+};
+
+class SpanFill {
+public:
+	typedef void (*FillFunc)(uint32 *pixels, uint *zbuf, int count, const SpanState &state);
+
+	/** The selected implementation, or nullptr before the first call of fill(). */
+	static FillFunc fillFunc;
+
+	/**
+	 * Fill @p count pixels, stepping the interpolated values of @p state
+	 * from one pixel to the next.
+	 */
+	static void fill(uint32 *pixels, uint *zbuf, int count, const SpanState &state) {
+		if (!fillFunc)
+			selectFillFunc();
+		fillFunc(pixels, zbuf, count, state);
+	}
+
+	static void fillGeneric(uint32 *pixels, uint *zbuf, int count, const SpanState &state);
+#ifdef SCUMMVM_NEON
+	static void fillNEON(uint32 *pixels, uint *zbuf, int count, const SpanState &state);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void fillSSE2(uint32 *pixels, uint *zbuf, int count, const SpanState &state);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void fillAVX2(uint32 *pixels, uint *zbuf, int count, const SpanState &state);
+#endif
+
+	/**
+	 * Pick the implementation for this CPU. fill() does it on its first call,
+	 * so this is only needed before filling spans on several threads.
+	 */
+	static void selectFillFunc();
+
+	/** Advance the interpolated values of @p state by @p count pixels. */
+	static void advance(SpanState &state, int count) {
+		state.z += state.dzdx * count;
+		state.r += state.drdx * count;
+		state.g += state.dgdx * count;
+		state.b += state.dbdx * count;
+		state.a += state.dadx * count;
+	}
+};
+
+} // end of namespace TinyGL
+
+#endif
@@ -0,0 +1,116 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zspan.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace TinyGL {
+
+static FORCEINLINE __m256i avx2_lanes(uint32 value, uint32 step) {
+	return _mm256_add_epi32(_mm256_set1_epi32(value), _mm256_mullo_epi32(_mm256_set1_epi32(step), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+
+static FORCEINLINE __m256i avx2_component(__m256i value, int bits, __m128i loss, __m128i shift) {
+	__m256i c = _mm256_and_si256(_mm256_srli_epi32(value, bits - 8), _mm256_set1_epi32(0xFF));
+	return _mm256_sll_epi32(_mm256_srl_epi32(c, loss), shift);
+}
+
+void SpanFill::fillAVX2(uint32 *pixels, uint *zbuf, int count, const SpanState &state) {
+	__m256i z = avx2_lanes(state.z, state.dzdx);
+	__m256i r = avx2_lanes(state.r, state.drdx);
+	__m256i g = avx2_lanes(state.g, state.dgdx);
+	__m256i b = avx2_lanes(state.b, state.dbdx);
+	__m256i a = avx2_lanes(state.a, state.dadx);
+	const __m256i dz = _mm256_set1_epi32(state.dzdx * 8);
+	const __m256i dr = _mm256_set1_epi32(state.drdx * 8);
+	const __m256i dg = _mm256_set1_epi32(state.dgdx * 8);
+	const __m256i db = _mm256_set1_epi32(state.dbdx * 8);
+	const __m256i da = _mm256_set1_epi32(state.dadx * 8);
+
+	const __m128i rLoss = _mm_cvtsi32_si128(state.rLoss), rShift = _mm_cvtsi32_si128(state.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(state.gLoss), gShift = _mm_cvtsi32_si128(state.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(state.bLoss), bShift = _mm_cvtsi32_si128(state.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(state.aLoss), aShift = _mm_cvtsi32_si128(state.aShift);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)(zbuf + i));
+
+		__m256i mask;
+		switch (state.depthMode) {
+		case SpanState::kDepthLess:
+			mask = _mm256_cmpgt_epi32(z, zDst);
+			break;
+		case SpanState::kDepthLessEqual:
+			mask = _mm256_xor_si256(_mm256_cmpgt_epi32(zDst, z), _mm256_set1_epi32(-1));
+			break;
+		default:
+			mask = _mm256_set1_epi32(-1);
+			break;
+		}
+
+		if (!_mm256_testz_si256(mask, mask)) {
+			if (state.depthWrite) {
+				// Depth goes through a float, like in FrameBuffer::writePixel()
+				const __m256i zSrc = _mm256_cvttps_epi32(_mm256_cvtepi32_ps(z));
+				_mm256_storeu_si256((__m256i *)(zbuf + i), _mm256_blendv_epi8(zDst, zSrc, mask));
+			}
+
+			__m256i color = avx2_component(r, ZB_POINT_RED_BITS, rLoss, rShift);
+			color = _mm256_or_si256(color, avx2_component(g, ZB_POINT_GREEN_BITS, gLoss, gShift));
+			color = _mm256_or_si256(color, avx2_component(b, ZB_POINT_BLUE_BITS, bLoss, bShift));
+			color = _mm256_or_si256(color, avx2_component(a, ZB_POINT_ALPHA_BITS, aLoss, aShift));
+
+			_mm256_maskstore_epi32((int *)(pixels + i), mask, color);
+		}
+
+		z = _mm256_add_epi32(z, dz);
+		r = _mm256_add_epi32(r, dr);
+		g = _mm256_add_epi32(g, dg);
+		b = _mm256_add_epi32(b, db);
+		a = _mm256_add_epi32(a, da);
+	}
+
+	if (i < count) {
+		SpanState tail = state;
+		advance(tail, i);
+		fillGeneric(pixels + i, zbuf + i, count - i, tail);
+	}
+}
+
+} // end of namespace TinyGL
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zspan.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace TinyGL {
+
+static FORCEINLINE uint32x4_t neon_lanes(uint32 value, uint32 step) {
+	static const uint32 lanes[4] = { 0, 1, 2, 3 };
+	return vmlaq_n_u32(vdupq_n_u32(value), vld1q_u32(lanes), step);
+}
+
+template<int bits>
+static FORCEINLINE uint32x4_t neon_component(uint32x4_t value, int32x4_t loss, int32x4_t shift) {
+	uint32x4_t c = vandq_u32(vshrq_n_u32(value, bits - 8), vdupq_n_u32(0xFF));
+	// Negative shift counts shift to the right
+	return vshlq_u32(vshlq_u32(c, loss), shift);
+}
+
+void SpanFill::fillNEON(uint32 *pixels, uint *zbuf, int count, const SpanState &state) {
+	uint32x4_t z = neon_lanes(state.z, state.dzdx);
+	uint32x4_t r = neon_lanes(state.r, state.drdx);
+	uint32x4_t g = neon_lanes(state.g, state.dgdx);
+	uint32x4_t b = neon_lanes(state.b, state.dbdx);
+	uint32x4_t a = neon_lanes(state.a, state.dadx);
+	const uint32x4_t dz = vdupq_n_u32(state.dzdx * 4);
+	const uint32x4_t dr = vdupq_n_u32(state.drdx * 4);
+	const uint32x4_t dg = vdupq_n_u32(state.dgdx * 4);
+	const uint32x4_t db = vdupq_n_u32(state.dbdx * 4);
+	const uint32x4_t da = vdupq_n_u32(state.dadx * 4);
+
+	const int32x4_t rLoss = vdupq_n_s32(-state.rLoss), rShift = vdupq_n_s32(state.rShift);
+	const int32x4_t gLoss = vdupq_n_s32(-state.gLoss), gShift = vdupq_n_s32(state.gShift);
+	const int32x4_t bLoss = vdupq_n_s32(-state.bLoss), bShift = vdupq_n_s32(state.bShift);
+	const int32x4_t aLoss = vdupq_n_s32(-state.aLoss), aShift = vdupq_n_s32(state.aShift);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t zDst = vld1q_u32(zbuf + i);
+
+		uint32x4_t mask;
+		switch (state.depthMode) {
+		case SpanState::kDepthLess:
+			mask = vcltq_u32(zDst, z);
+			break;
+		case SpanState::kDepthLessEqual:
+			mask = vcleq_u32(zDst, z);
+			break;
+		default:
+			mask = vdupq_n_u32(0xFFFFFFFF);
+			break;
+		}
+
+		if (state.depthWrite) {
+			// Depth goes through a float, like in FrameBuffer::writePixel()
+			const uint32x4_t zSrc = vreinterpretq_u32_s32(vcvtq_s32_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(z))));
+			vst1q_u32(zbuf + i, vbslq_u32(mask, zSrc, zDst));
+		}
+
+		uint32x4_t color = neon_component<ZB_POINT_RED_BITS>(r, rLoss, rShift);
+		color = vorrq_u32(color, neon_component<ZB_POINT_GREEN_BITS>(g, gLoss, gShift));
+		color = vorrq_u32(color, neon_component<ZB_POINT_BLUE_BITS>(b, bLoss, bShift));
+		color = vorrq_u32(color, neon_component<ZB_POINT_ALPHA_BITS>(a, aLoss, aShift));
+		vst1q_u32(pixels + i, vbslq_u32(mask, color, vld1q_u32(pixels + i)));
+
+		z = vaddq_u32(z, dz);
+		r = vaddq_u32(r, dr);
+		g = vaddq_u32(g, dg);
+		b = vaddq_u32(b, db);
+		a = vaddq_u32(a, da);
+	}
+
+	if (i < count) {
+		SpanState tail = state;
+		advance(tail, i);
+		fillGeneric(pixels + i, zbuf + i, count - i, tail);
+	}
+}
+
+} // end of namespace TinyGL
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zspan.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace TinyGL {
+
+static FORCEINLINE __m128i sse2_component(__m128i value, int bits, __m128i loss, __m128i shift) {
+	__m128i c = _mm_and_si128(_mm_srli_epi32(value, bits - 8), _mm_set1_epi32(0xFF));
+	return _mm_sll_epi32(_mm_srl_epi32(c, loss), shift);
+}
+
+void SpanFill::fillSSE2(uint32 *pixels, uint *zbuf, int count, const SpanState &state) {
+	// Per lane start values are the start value plus lane * step
+	__m128i z = _mm_set_epi32(state.z + 3 * state.dzdx, state.z + 2 * state.dzdx, state.z + state.dzdx, state.z);
+	__m128i r = _mm_set_epi32(state.r + 3 * state.drdx, state.r + 2 * state.drdx, state.r + state.drdx, state.r);
+	__m128i g = _mm_set_epi32(state.g + 3 * state.dgdx, state.g + 2 * state.dgdx, state.g + state.dgdx, state.g);
+	__m128i b = _mm_set_epi32(state.b + 3 * state.dbdx, state.b + 2 * state.dbdx, state.b + state.dbdx, state.b);
+	__m128i a = _mm_set_epi32(state.a + 3 * state.dadx, state.a + 2 * state.dadx, state.a + state.dadx, state.a);
+	const __m128i dz = _mm_set1_epi32(state.dzdx * 4);
+	const __m128i dr = _mm_set1_epi32(state.drdx * 4);
+	const __m128i dg = _mm_set1_epi32(state.dgdx * 4);
+	const __m128i db = _mm_set1_epi32(state.dbdx * 4);
+	const __m128i da = _mm_set1_epi32(state.dadx * 4);
+
+	const __m128i rLoss = _mm_cvtsi32_si128(state.rLoss), rShift = _mm_cvtsi32_si128(state.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(state.gLoss), gShift = _mm_cvtsi32_si128(state.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(state.bLoss), bShift = _mm_cvtsi32_si128(state.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(state.aLoss), aShift = _mm_cvtsi32_si128(state.aShift);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)(zbuf + i));
+
+		__m128i mask;
+		switch (state.depthMode) {
+		case SpanState::kDepthLess:
+			mask = _mm_cmplt_epi32(zDst, z);
+			break;
+		case SpanState::kDepthLessEqual:
+			mask = _mm_xor_si128(_mm_cmpgt_epi32(zDst, z), _mm_set1_epi32(-1));
+			break;
+		default:
+			mask = _mm_set1_epi32(-1);
+			break;
+		}
+
+		if (_mm_movemask_epi8(mask) != 0) {
+			if (state.depthWrite) {
+				// Depth goes through a float, like in FrameBuffer::writePixel()
+				const __m128i zSrc = _mm_cvttps_epi32(_mm_cvtepi32_ps(z));
+				_mm_storeu_si128((__m128i *)(zbuf + i), _mm_or_si128(_mm_and_si128(mask, zSrc), _mm_andnot_si128(mask, zDst)));
+			}
+
+			__m128i color = sse2_component(r, ZB_POINT_RED_BITS, rLoss, rShift);
+			color = _mm_or_si128(color, sse2_component(g, ZB_POINT_GREEN_BITS, gLoss, gShift));
+			color = _mm_or_si128(color, sse2_component(b, ZB_POINT_BLUE_BITS, bLoss, bShift));
+			color = _mm_or_si128(color, sse2_component(a, ZB_POINT_ALPHA_BITS, aLoss, aShift));
+
+			const __m128i dst = _mm_loadu_si128((const __m128i *)(pixels + i));
+			_mm_storeu_si128((__m128i *)(pixels + i), _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, dst)));
+		}
+
+		z = _mm_add_epi32(z, dz);
+		r = _mm_add_epi32(r, dr);
+		g = _mm_add_epi32(g, dg);
+		b = _mm_add_epi32(b, db);
+		a = _mm_add_epi32(a, da);
+	}
+
+	if (i < count) {
+		SpanState tail = state;
+		advance(tail, i);
+		fillGeneric(pixels + i, zbuf + i, count - i, tail);
+	}
+}
+
+} // end of namespace TinyGL
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
@@ -29,6 +29,7 @@
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
@@ -50,34 +51,34 @@ void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
                                     int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
                                     int &dzdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                     uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
-	if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
-		return;
-	}
-
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
+	// pixels outside of the scissor rectangle still step the interpolation,
+	// so that the visible part of the span matches an unclipped one
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
 			return;
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
-		          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
-		          z, fog, fog_r, fog_g, fog_b);
+
+		if (kStencilEnabled) {
+			bool stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+				return;
+			}
+		}
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (depthTestResult) {
+			writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
+			          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
+			          z, fog, fog_r, fog_g, fog_b);
+		}
 	}
 	z += dzdx;
 	if (kFogMode) {
@@ -98,40 +99,39 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
                                   uint &r, uint &g, uint &b, uint &a,
                                   int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                   uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
+	// clipped pixels still step the interpolation
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		if (kStencilEnabled) {
+			bool stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+				return;
+			}
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		uint8 c_a, c_r, c_g, c_b;
-		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
-		if (kLightsMode) {
-			uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
-			uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
-			uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
-			uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
-			c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
-			c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
-			c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
-			c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (depthTestResult) {
+			uint8 c_a, c_r, c_g, c_b;
+			texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+			if (kLightsMode) {
+				uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
+				uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
+				uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
+				uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
+				c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
+				c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
+				c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
+				c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+			}
+			writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
 		}
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
 	}
 	z += dzdx;
 	s += dsdx;
@@ -149,32 +149,31 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
 
 template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kStippleEnabled, bool kDepthTestEnabled>
 void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
-	/*if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
-		return;
-	}*/
-
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
+	// clipped pixels still step the interpolation
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		/*if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
 			return;
+		}*/
+
+		if (kStencilEnabled) {
+			bool stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+				return;
+			}
+		}
+		bool depthTestResult;
+		if (kDepthTestEnabled) {
+			depthTestResult = compareDepth(z, pz[_a]);
+		} else {
+			depthTestResult = true;
+		}
+		if (kStencilEnabled) {
+			stencilOp(true, depthTestResult, ps + _a);
+		}
+		if (kDepthWrite && depthTestResult) {
+			pz[_a] = z;
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (kDepthWrite && depthTestResult) {
-		pz[_a] = z;
 	}
 	z += dzdx;
 }
@@ -229,6 +228,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		p2 = tp;
 	}
 
+	// nothing to do for triangles above or below the scissor rectangle,
+	// like most of them when a frame is drawn tile by tile
+	if (kEnableScissor && (p2->y < _clipRectangle.top || p0->y >= _clipRectangle.bottom))
+		return;
+
 	// we compute dXdx and dXdy for all interpolated values
 
 	fdx1 = (float)(p1->x - p0->x);
@@ -324,6 +328,30 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		polyOffset = -m * _offsetFactor + -_offsetUnits * (1 << 6);
 	}
 
+	// opaque Gouraud shaded spans can be filled several pixels at a time
+	SpanState span;
+	bool useSpanFill = false;
+	if (kInterpRGB && kInterpZ && !(kInterpST || kInterpSTZ) && !kFogMode && !kAlphaTestEnabled &&
+	    !kBlendingEnabled && !kStencilEnabled && !kStippleEnabled && _pbufBpp == 4) {
+		span = _spanFormat;
+		span.depthWrite = kDepthWrite;
+		if (!kDepthTestEnabled || _depthFunc == TGL_ALWAYS) {
+			span.depthMode = SpanState::kDepthAlways;
+			useSpanFill = true;
+		} else if (_depthFunc == TGL_LESS) {
+			span.depthMode = SpanState::kDepthLess;
+			useSpanFill = true;
+		} else if (_depthFunc == TGL_LEQUAL) {
+			span.depthMode = SpanState::kDepthLessEqual;
+			useSpanFill = true;
+		}
+		span.dzdx = dzdx;
+		span.drdx = drdx;
+		span.dgdx = dgdx;
+		span.dbdx = dbdx;
+		span.dadx = dadx;
+	}
+
 	// screen coordinates
 
 	int pp1 = _pbufWidth * p0->y;
@@ -446,7 +474,26 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && (y < _clipRectangle.top || y >= _clipRectangle.bottom)) {
+				// the scan line is outside of the scissor rectangle, only step the edges
+			} else if (!(kInterpST || kInterpSTZ) && useSpanFill) {
+				// the scan line is clipped to the scissor rectangle up front,
+				// starting the interpolation at the first visible pixel
+				int xStart = x1, xEnd = x2 >> 16;
+				if (kEnableScissor) {
+					xStart = MAX<int>(xStart, _clipRectangle.left);
+					xEnd = MIN<int>(xEnd, _clipRectangle.right - 1);
+				}
+				if (xStart <= xEnd) {
+					const int skip = xStart - x1;
+					span.z = z1 + skip * dzdx;
+					span.r = r1 + skip * drdx;
+					span.g = g1 + skip * dgdx;
+					span.b = b1 + skip * dbdx;
+					span.a = a1 + skip * dadx;
+					SpanFill::fill((uint32 *)_pbuf + pp1 + xStart, pz1 + xStart, xEnd - xStart + 1, span);
+				}
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -82,8 +82,11 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/system.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_row.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -98,12 +101,14 @@ public:
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
 	const int16 *getColorTable() const { return _colorTab; }
+	const int16 *getChromaTable() const { return _chromaTab; }
 	const byte *getClipTable() const { return _clipTable; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
 	int16 _colorTab[4 * 256]; // 2048 bytes
+	int16 _chromaTab[4 * 256]; // The color table without the clip table offsets
 	byte _clipTable[3 * 768];
 };
 
@@ -178,6 +183,11 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 		Cr_g_tab[i] = (int16) (-(0.299 / 0.419) * CR) + g_offset + 256;
 		Cb_g_tab[i] = (int16) (-(0.114 / 0.331) * CB);
 		Cb_b_tab[i] = (int16) ( (0.587 / 0.331) * CB) + b_offset + 256;
+
+		_chromaTab[0 * 256 + i] = Cr_r_tab[i] - (r_offset + 256);
+		_chromaTab[1 * 256 + i] = Cr_g_tab[i] - (g_offset + 256);
+		_chromaTab[2 * 256 + i] = Cb_g_tab[i];
+		_chromaTab[3 * 256 + i] = Cb_b_tab[i] - (b_offset + 256);
 	}
 }
 
@@ -198,6 +208,108 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+YUVToRGBRow::ConvertFunc YUVToRGBRow::convertFunc = nullptr;
+
+void YUVToRGBRow::selectConvertFunc() {
+	convertFunc = convertGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) convertFunc = convertNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) convertFunc = convertSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) convertFunc = convertAVX2;
+#endif
+}
+
+static inline uint32 clipComponent(int value, bool ituScale, byte loss, byte shift) {
+	// Same as the clip table: values out of range are clamped, and the ITU
+	// range is stretched to [0, 255]
+	if (ituScale)
+		value = (CLIP(value, 16, 235) - 16) * 255 / 219;
+	else
+		value = CLIP(value, 0, 255);
+
+	return (uint32)(value >> loss) << shift;
+}
+
+void YUVToRGBRow::convertGeneric(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	for (int x = 0; x < width; x++) {
+		const int c = state.halfChroma ? x >> 1 : x;
+		const int y = ySrc[x];
+
+		const uint32 pixel = clipComponent(y + state.rChroma[c], state.ituScale, state.rLoss, state.rShift) |
+		                     clipComponent(y + state.gChroma[c], state.ituScale, state.gLoss, state.gShift) |
+		                     clipComponent(y + state.bChroma[c], state.ituScale, state.bLoss, state.bShift) |
+		                     state.aMask;
+
+		if (state.bytesPerPixel == 2)
+			*((uint16 *)dst + x) = pixel;
+		else
+			*((uint32 *)dst + x) = pixel;
+	}
+}
+
+/**
+ * Convert through the YUVToRGBRow kernels. The chroma of each row is turned
+ * into intensity offsets once, in chunks, and then shared by all the pixels
+ * and rows it covers.
+ */
+static void convertYUVRows(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, int chromaShiftX, int chromaShiftY) {
+	static const int kChunkSize = 256;
+	int16 rChroma[kChunkSize], gChroma[kChunkSize], bChroma[kChunkSize];
+
+	const int16 *Cr_r_tab = lookup->getChromaTable();
+	const int16 *Cr_g_tab = Cr_r_tab + 256;
+	const int16 *Cb_g_tab = Cr_g_tab + 256;
+	const int16 *Cb_b_tab = Cb_g_tab + 256;
+
+	const Graphics::PixelFormat &format = lookup->getFormat();
+	YUVToRGBRowState state;
+	state.rChroma = rChroma;
+	state.gChroma = gChroma;
+	state.bChroma = bChroma;
+	state.halfChroma = chromaShiftX != 0;
+	state.ituScale = lookup->getScale() == YUVToRGBManager::kScaleITU;
+	state.bytesPerPixel = format.bytesPerPixel;
+	state.rLoss = format.rLoss;
+	state.gLoss = format.gLoss;
+	state.bLoss = format.bLoss;
+	state.rShift = format.rShift;
+	state.gShift = format.gShift;
+	state.bShift = format.bShift;
+	state.aMask = (0xFF >> format.aLoss) << format.aShift;
+
+	const int chromaWidth = yWidth >> chromaShiftX;
+	const int chromaHeight = yHeight >> chromaShiftY;
+
+	for (int cy = 0; cy < chromaHeight; cy++) {
+		for (int cx = 0; cx < chromaWidth; cx += kChunkSize) {
+			const int count = MIN(kChunkSize, chromaWidth - cx);
+			const byte *u = uSrc + cy * uvPitch + cx;
+			const byte *v = vSrc + cy * uvPitch + cx;
+
+			for (int i = 0; i < count; i++) {
+				rChroma[i] = Cr_r_tab[v[i]];
+				gChroma[i] = Cr_g_tab[v[i]] + Cb_g_tab[u[i]];
+				bChroma[i] = Cb_b_tab[u[i]];
+			}
+
+			const int x = cx << chromaShiftX;
+			for (int y = cy << chromaShiftY; y < (cy + 1) << chromaShiftY; y++)
+				YUVToRGBRow::convertFunc(dstPtr + y * dstPitch + x * state.bytesPerPixel, ySrc + y * yPitch + x, count << chromaShiftX, state);
+		}
+	}
+}
+
+static bool useRowKernels() {
+	if (!YUVToRGBRow::convertFunc)
+		YUVToRGBRow::selectConvertFunc();
+
+	return YUVToRGBRow::convertFunc != YUVToRGBRow::convertGeneric;
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &clipTable[(s)]; \
 	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | a_mask)
@@ -246,6 +358,11 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	if (useRowKernels()) {
+		convertYUVRows((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 0, 0);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -303,6 +420,11 @@ void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	if (useRowKernels()) {
+		convertYUVRows((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 1, 0);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV422ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -364,6 +486,11 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	if (useRowKernels()) {
+		convertYUVRows((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 1, 1);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
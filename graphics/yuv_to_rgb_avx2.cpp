@@ -0,0 +1,126 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_row.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+template<bool halfChroma>
+static FORCEINLINE __m256i avx2_chroma(const int16 *chroma) {
+	if (halfChroma) {
+		// Each chroma sample covers two pixels
+		const __m128i c = _mm_loadu_si128((const __m128i *)chroma);
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(c, c)), _mm_unpackhi_epi16(c, c), 1);
+	}
+
+	return _mm256_loadu_si256((const __m256i *)chroma);
+}
+
+template<bool ituScale>
+static FORCEINLINE __m256i avx2_component(__m256i value, __m128i loss) {
+	if (ituScale) {
+		// (value - 16) * 255 / 219, which (x * 4 * 19078) >> 16 matches
+		// exactly for x in [0, 219]
+		value = _mm256_min_epi16(_mm256_max_epi16(value, _mm256_set1_epi16(16)), _mm256_set1_epi16(235));
+		value = _mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_sub_epi16(value, _mm256_set1_epi16(16)), 2), _mm256_set1_epi16(19078));
+	} else {
+		value = _mm256_min_epi16(_mm256_max_epi16(value, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+	}
+
+	return _mm256_srl_epi16(value, loss);
+}
+
+static FORCEINLINE __m256i avx2_pack32(__m128i r, __m128i g, __m128i b, __m128i rShift, __m128i gShift, __m128i bShift, __m256i aMask) {
+	return _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(r), rShift), _mm256_sll_epi32(_mm256_cvtepu16_epi32(g), gShift)),
+	                       _mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(b), bShift), aMask));
+}
+
+template<bool halfChroma, bool ituScale, int bytesPerPixel>
+static void convertBlocksAVX2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	const __m128i rLoss = _mm_cvtsi32_si128(state.rLoss), rShift = _mm_cvtsi32_si128(state.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(state.gLoss), gShift = _mm_cvtsi32_si128(state.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(state.bLoss), bShift = _mm_cvtsi32_si128(state.bShift);
+	const __m256i aMask = (bytesPerPixel == 2) ? _mm256_set1_epi16((int16)state.aMask) : _mm256_set1_epi32(state.aMask);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const int c = halfChroma ? x >> 1 : x;
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + x)));
+
+		const __m256i r = avx2_component<ituScale>(_mm256_add_epi16(y, avx2_chroma<halfChroma>(state.rChroma + c)), rLoss);
+		const __m256i g = avx2_component<ituScale>(_mm256_add_epi16(y, avx2_chroma<halfChroma>(state.gChroma + c)), gLoss);
+		const __m256i b = avx2_component<ituScale>(_mm256_add_epi16(y, avx2_chroma<halfChroma>(state.bChroma + c)), bLoss);
+
+		if (bytesPerPixel == 2) {
+			const __m256i pixels = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi16(r, rShift), _mm256_sll_epi16(g, gShift)),
+			                                       _mm256_or_si256(_mm256_sll_epi16(b, bShift), aMask));
+			_mm256_storeu_si256((__m256i *)(dst + x * 2), pixels);
+		} else {
+			const __m256i lo = avx2_pack32(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b), rShift, gShift, bShift, aMask);
+			const __m256i hi = avx2_pack32(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1), rShift, gShift, bShift, aMask);
+			_mm256_storeu_si256((__m256i *)(dst + x * 4), lo);
+			_mm256_storeu_si256((__m256i *)(dst + x * 4 + 32), hi);
+		}
+	}
+
+	YUVToRGBRow::convertTail(dst, ySrc, x, width, state);
+}
+
+template<int bytesPerPixel>
+static void convertRowAVX2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.halfChroma) {
+		if (state.ituScale)
+			convertBlocksAVX2<true, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksAVX2<true, false, bytesPerPixel>(dst, ySrc, width, state);
+	} else {
+		if (state.ituScale)
+			convertBlocksAVX2<false, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksAVX2<false, false, bytesPerPixel>(dst, ySrc, width, state);
+	}
+}
+
+void YUVToRGBRow::convertAVX2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.bytesPerPixel == 2)
+		convertRowAVX2<2>(dst, ySrc, width, state);
+	else
+		convertRowAVX2<4>(dst, ySrc, width, state);
+}
+
+} // End of namespace Graphics
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb_row.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Graphics {
+
+template<bool halfChroma>
+static FORCEINLINE int16x8_t neon_chroma(const int16 *chroma) {
+	if (halfChroma) {
+		// Each chroma sample covers two pixels
+		const int16x4_t c = vld1_s16(chroma);
+		const int16x4x2_t pairs = vzip_s16(c, c);
+		return vcombine_s16(pairs.val[0], pairs.val[1]);
+	}
+
+	return vld1q_s16(chroma);
+}
+
+template<bool ituScale>
+static FORCEINLINE uint16x8_t neon_component(int16x8_t value, int16x8_t loss) {
+	if (ituScale) {
+		// (value - 16) * 255 / 219, which (x * 4 * 19078) >> 16 matches
+		// exactly for x in [0, 219]
+		value = vminq_s16(vmaxq_s16(value, vdupq_n_s16(16)), vdupq_n_s16(235));
+		value = vqdmulhq_n_s16(vshlq_n_s16(vsubq_s16(value, vdupq_n_s16(16)), 1), 19078);
+	} else {
+		value = vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255));
+	}
+
+	// loss holds the negated loss, for a right shift
+	return vshlq_u16(vreinterpretq_u16_s16(value), loss);
+}
+
+static FORCEINLINE uint32x4_t neon_pack32(uint16x4_t r, uint16x4_t g, uint16x4_t b, int32x4_t rShift, int32x4_t gShift, int32x4_t bShift, uint32x4_t aMask) {
+	return vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(r), rShift), vshlq_u32(vmovl_u16(g), gShift)),
+	                 vorrq_u32(vshlq_u32(vmovl_u16(b), bShift), aMask));
+}
+
+template<bool halfChroma, bool ituScale, int bytesPerPixel>
+static void convertBlocksNEON(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	const int16x8_t rLoss = vdupq_n_s16(-state.rLoss);
+	const int16x8_t gLoss = vdupq_n_s16(-state.gLoss);
+	const int16x8_t bLoss = vdupq_n_s16(-state.bLoss);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const int c = halfChroma ? x >> 1 : x;
+		const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + x)));
+
+		const uint16x8_t r = neon_component<ituScale>(vaddq_s16(y, neon_chroma<halfChroma>(state.rChroma + c)), rLoss);
+		const uint16x8_t g = neon_component<ituScale>(vaddq_s16(y, neon_chroma<halfChroma>(state.gChroma + c)), gLoss);
+		const uint16x8_t b = neon_component<ituScale>(vaddq_s16(y, neon_chroma<halfChroma>(state.bChroma + c)), bLoss);
+
+		if (bytesPerPixel == 2) {
+			const uint16x8_t pixels = vorrq_u16(vorrq_u16(vshlq_u16(r, vdupq_n_s16(state.rShift)), vshlq_u16(g, vdupq_n_s16(state.gShift))),
+			                                    vorrq_u16(vshlq_u16(b, vdupq_n_s16(state.bShift)), vdupq_n_u16(state.aMask)));
+			vst1q_u16((uint16 *)(dst + x * 2), pixels);
+		} else {
+			const int32x4_t rShift = vdupq_n_s32(state.rShift), gShift = vdupq_n_s32(state.gShift), bShift = vdupq_n_s32(state.bShift);
+			const uint32x4_t aMask = vdupq_n_u32(state.aMask);
+			vst1q_u32((uint32 *)(dst + x * 4), neon_pack32(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), rShift, gShift, bShift, aMask));
+			vst1q_u32((uint32 *)(dst + x * 4 + 16), neon_pack32(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b), rShift, gShift, bShift, aMask));
+		}
+	}
+
+	YUVToRGBRow::convertTail(dst, ySrc, x, width, state);
+}
+
+template<int bytesPerPixel>
+static void convertRowNEON(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.halfChroma) {
+		if (state.ituScale)
+			convertBlocksNEON<true, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksNEON<true, false, bytesPerPixel>(dst, ySrc, width, state);
+	} else {
+		if (state.ituScale)
+			convertBlocksNEON<false, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksNEON<false, false, bytesPerPixel>(dst, ySrc, width, state);
+	}
+}
+
+void YUVToRGBRow::convertNEON(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.bytesPerPixel == 2)
+		convertRowNEON<2>(dst, ySrc, width, state);
+	else
+		convertRowNEON<4>(dst, ySrc, width, state);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
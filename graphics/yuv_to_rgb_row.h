@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_ROW_H
+#define GRAPHICS_YUV_TO_RGB_ROW_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Chroma and output format of a row converted by YUVToRGBRow.
+ *
+ * The chroma contributions come from the tables of the lookup path, so the
+ * kernels only have to add the luminance, clip, scale and pack. The per pixel
+ * lookup path in yuv_to_rgb.cpp is the reference for these kernels.
+ */
+struct YUVToRGBRowState {
+	// Contributions of the chroma samples to the red, green and blue
+	// intensities, one entry per chroma sample
+	const int16 *rChroma;
+	const int16 *gChroma;
+	const int16 *bChroma;
+
+	// Whether each chroma sample covers two horizontal pixels
+	bool halfChroma;
+
+	// Whether the luminance range is [16, 235] rather than [0, 255]
+	bool ituScale;
+
+	// 2 or 4
+	byte bytesPerPixel;
+
+	byte rLoss, gLoss, bLoss;
+	byte rShift, gShift, bShift;
+	uint32 aMask;
+};
+
+class YUVToRGBRow {
+public:
+	typedef void (*ConvertFunc)(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state);
+
+	/**
+	 * The selected kernel, or nullptr before the first conversion. When no
+	 * kernel suits the CPU, this is convertGeneric, and the per pixel lookup
+	 * path is used instead.
+	 */
+	static ConvertFunc convertFunc;
+
+	static void selectConvertFunc();
+
+	/** Convert a row of @p width pixels, which has to be even for half chroma. */
+	static void convertGeneric(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state);
+#ifdef SCUMMVM_NEON
+	static void convertNEON(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void convertSSE2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void convertAVX2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state);
+#endif
+
+	/**
+	 * Convert the last @p width - @p x pixels of a row with convertGeneric().
+	 * This is used by the kernels for what is left after their last full block.
+	 */
+	static void convertTail(byte *dst, const byte *ySrc, int x, int width, const YUVToRGBRowState &state) {
+		if (x >= width)
+			return;
+
+		YUVToRGBRowState tail = state;
+		const int chromaX = state.halfChroma ? x >> 1 : x;
+		tail.rChroma += chromaX;
+		tail.gChroma += chromaX;
+		tail.bChroma += chromaX;
+		convertGeneric(dst + x * state.bytesPerPixel, ySrc + x, width - x, tail);
+	}
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_row.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Graphics {
+
+template<bool halfChroma>
+static FORCEINLINE __m128i sse2_chroma(const int16 *chroma) {
+	if (halfChroma) {
+		// Each chroma sample covers two pixels
+		const __m128i c = _mm_loadl_epi64((const __m128i *)chroma);
+		return _mm_unpacklo_epi16(c, c);
+	}
+
+	return _mm_loadu_si128((const __m128i *)chroma);
+}
+
+template<bool ituScale>
+static FORCEINLINE __m128i sse2_component(__m128i value, __m128i loss) {
+	if (ituScale) {
+		// (value - 16) * 255 / 219, which (x * 4 * 19078) >> 16 matches
+		// exactly for x in [0, 219]
+		value = _mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+		value = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(value, _mm_set1_epi16(16)), 2), _mm_set1_epi16(19078));
+	} else {
+		value = _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+	}
+
+	return _mm_srl_epi16(value, loss);
+}
+
+static FORCEINLINE __m128i sse2_pack32(__m128i r, __m128i g, __m128i b, __m128i rShift, __m128i gShift, __m128i bShift, __m128i aMask) {
+	return _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, rShift), _mm_sll_epi32(g, gShift)),
+	                    _mm_or_si128(_mm_sll_epi32(b, bShift), aMask));
+}
+
+template<bool halfChroma, bool ituScale, int bytesPerPixel>
+static void convertBlocksSSE2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	const __m128i rLoss = _mm_cvtsi32_si128(state.rLoss), rShift = _mm_cvtsi32_si128(state.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(state.gLoss), gShift = _mm_cvtsi32_si128(state.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(state.bLoss), bShift = _mm_cvtsi32_si128(state.bShift);
+	const __m128i aMask = (bytesPerPixel == 2) ? _mm_set1_epi16((int16)state.aMask) : _mm_set1_epi32(state.aMask);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const int c = halfChroma ? x >> 1 : x;
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+
+		const __m128i r = sse2_component<ituScale>(_mm_add_epi16(y, sse2_chroma<halfChroma>(state.rChroma + c)), rLoss);
+		const __m128i g = sse2_component<ituScale>(_mm_add_epi16(y, sse2_chroma<halfChroma>(state.gChroma + c)), gLoss);
+		const __m128i b = sse2_component<ituScale>(_mm_add_epi16(y, sse2_chroma<halfChroma>(state.bChroma + c)), bLoss);
+
+		if (bytesPerPixel == 2) {
+			const __m128i pixels = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(r, rShift), _mm_sll_epi16(g, gShift)),
+			                                    _mm_or_si128(_mm_sll_epi16(b, bShift), aMask));
+			_mm_storeu_si128((__m128i *)(dst + x * 2), pixels);
+		} else {
+			const __m128i lo = sse2_pack32(_mm_unpacklo_epi16(r, zero), _mm_unpacklo_epi16(g, zero), _mm_unpacklo_epi16(b, zero), rShift, gShift, bShift, aMask);
+			const __m128i hi = sse2_pack32(_mm_unpackhi_epi16(r, zero), _mm_unpackhi_epi16(g, zero), _mm_unpackhi_epi16(b, zero), rShift, gShift, bShift, aMask);
+			_mm_storeu_si128((__m128i *)(dst + x * 4), lo);
+			_mm_storeu_si128((__m128i *)(dst + x * 4 + 16), hi);
+		}
+	}
+
+	YUVToRGBRow::convertTail(dst, ySrc, x, width, state);
+}
+
+template<int bytesPerPixel>
+static void convertRowSSE2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.halfChroma) {
+		if (state.ituScale)
+			convertBlocksSSE2<true, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksSSE2<true, false, bytesPerPixel>(dst, ySrc, width, state);
+	} else {
+		if (state.ituScale)
+			convertBlocksSSE2<false, true, bytesPerPixel>(dst, ySrc, width, state);
+		else
+			convertBlocksSSE2<false, false, bytesPerPixel>(dst, ySrc, width, state);
+	}
+}
+
+void YUVToRGBRow::convertSSE2(byte *dst, const byte *ySrc, int width, const YUVToRGBRowState &state) {
+	if (state.bytesPerPixel == 2)
+		convertRowSSE2<2>(dst, ySrc, width, state);
+	else
+		convertRowSSE2<4>(dst, ySrc, width, state);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
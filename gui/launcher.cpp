@@ -424,6 +424,7 @@ void LauncherDialog::massAddGame() {
 		MassAddDialog massAddDlg(_browser->getResult());
 
 		massAddDlg.runModal();
+		ADCacheMan.savePersistentCache();
 
 		// Update the ListWidget and force a redraw
 
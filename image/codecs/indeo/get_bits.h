@@ -56,29 +56,33 @@ public:
 		int n, nbBits;
 		unsigned int index;
 
-		index = peekBits<bits>();
+		// One refill of the 8-bit stream leaves at least 57 bits, which
+		// covers all the codes used by Indeo
+		refill();
+
+		index = peekBitsFast(bits);
 		code  = table[index][0];
 		n     = table[index][1];
 
 		if (maxDepth > 1 && n < 0) {
-			skip(bits);
+			skipFast(bits);
 			nbBits = -n;
 
-			index = peekBits(nbBits) + code;
+			index = peekBitsFast(nbBits) + code;
 			code = table[index][0];
 			n = table[index][1];
 
 			if (maxDepth > 2 && n < 0) {
-				skip(nbBits);
+				skipFast(nbBits);
 				nbBits = -n;
 
-				index = peekBits(nbBits) + code;
+				index = peekBitsFast(nbBits) + code;
 				code = table[index][0];
 				n = table[index][1];
 			}
 		}
 
-		skip(n);
+		skipFast(n);
 		return code;
 	}
 };
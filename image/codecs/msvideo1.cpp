@@ -33,10 +33,11 @@ namespace Image {
 	return; \
   }
 
+static const Graphics::PixelFormat kNativeFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+
 MSVideo1Decoder::MSVideo1Decoder(uint16 width, uint16 height, byte bitsPerPixel) : Codec() {
 	_surface = new Graphics::Surface();
-	_surface->create(width, height, (bitsPerPixel == 8) ? Graphics::PixelFormat::createFormatCLUT8() :
-														  Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+	_surface->create(width, height, (bitsPerPixel == 8) ? Graphics::PixelFormat::createFormatCLUT8() : kNativeFormat);
 
 	_bitsPerPixel = bitsPerPixel;
 }
@@ -125,11 +126,23 @@ void MSVideo1Decoder::decode8(Common::SeekableReadStream &stream) {
 	}
 }
 
+template<typename PixelInt, bool kConvert>
+static inline PixelInt convertColor(uint16 color, const Graphics::PixelFormat &format) {
+	if (!kConvert)
+		return color;
+
+	byte r, g, b;
+	kNativeFormat.colorToRGB(color, r, g, b);
+	return format.RGBToColor(r, g, b);
+}
+
+template<typename PixelInt, bool kConvert>
 void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
 	/* decoding parameters */
-	uint16 colors[8];
-	uint16 *pixels = (uint16 *)_surface->getPixels();
-	int32 stride = _surface->w;
+	const Graphics::PixelFormat &format = _surface->format;
+	PixelInt colors[8];
+	PixelInt *pixels = (PixelInt *)_surface->getPixels();
+	int32 stride = _surface->pitch / sizeof(PixelInt);
 
 	int32 skip_blocks = 0;
 	int32 blocks_wide = _surface->w / 4;
@@ -167,18 +180,15 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
 				uint16 flags = (byte_b << 8) | byte_a;
 
 				CHECK_STREAM_PTR(4);
-				colors[0] = stream.readUint16LE();
-				colors[1] = stream.readUint16LE();
+				uint16 color0 = stream.readUint16LE();
+				colors[0] = convertColor<PixelInt, kConvert>(color0, format);
+				colors[1] = convertColor<PixelInt, kConvert>(stream.readUint16LE(), format);
 
-				if (colors[0] & 0x8000) {
+				if (color0 & 0x8000) {
 					/* 8-color encoding */
 					CHECK_STREAM_PTR(12);
-					colors[2] = stream.readUint16LE();
-					colors[3] = stream.readUint16LE();
-					colors[4] = stream.readUint16LE();
-					colors[5] = stream.readUint16LE();
-					colors[6] = stream.readUint16LE();
-					colors[7] = stream.readUint16LE();
+					for (int i = 2; i < 8; i++)
+						colors[i] = convertColor<PixelInt, kConvert>(stream.readUint16LE(), format);
 
 					for (int pixel_y = 0; pixel_y < 4; pixel_y++) {
 						for (int pixel_x = 0; pixel_x < 4; pixel_x++, flags >>= 1)
@@ -197,7 +207,7 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
 				}
 			} else {
 				/* otherwise, it's a 1-color block */
-				colors[0] = (byte_b << 8) | byte_a;
+				colors[0] = convertColor<PixelInt, kConvert>((byte_b << 8) | byte_a, format);
 
 				for (int pixel_y = 0; pixel_y < 4; pixel_y++) {
 					for (int pixel_x = 0; pixel_x < 4; pixel_x++)
@@ -215,10 +225,27 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
 const Graphics::Surface *MSVideo1Decoder::decodeFrame(Common::SeekableReadStream &stream) {
 	if (_bitsPerPixel == 8)
 		decode8(stream);
+	else if (_surface->format == kNativeFormat)
+		decode16<uint16, false>(stream);
+	else if (_surface->format.bytesPerPixel == 2)
+		decode16<uint16, true>(stream);
 	else
-		decode16(stream);
+		decode16<uint32, true>(stream);
 
 	return _surface;
 }
 
+bool MSVideo1Decoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (_bitsPerPixel == 8 || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	if (format != _surface->format) {
+		const int16 width = _surface->w, height = _surface->h;
+		_surface->free();
+		_surface->create(width, height, format);
+	}
+
+	return true;
+}
+
 } // End of namespace Image
@@ -38,6 +38,7 @@ public:
 
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream) override;
 	Graphics::PixelFormat getPixelFormat() const override { return _surface->format; }
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format) override;
 
 private:
 	byte _bitsPerPixel;
@@ -45,6 +46,7 @@ private:
 	Graphics::Surface *_surface;
 
 	void decode8(Common::SeekableReadStream &stream);
+	template<typename PixelInt, bool kConvert>
 	void decode16(Common::SeekableReadStream &stream);
 };
 
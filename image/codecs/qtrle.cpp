@@ -33,6 +33,8 @@
 
 namespace Image {
 
+static const Graphics::PixelFormat kNativeFormat16(2, 5, 5, 5, 0, 10, 5, 0, 0);
+
 QTRLEDecoder::QTRLEDecoder(uint16 width, uint16 height, byte bitsPerPixel) : Codec() {
 	_bitsPerPixel = bitsPerPixel;
 	_ditherPalette = 0;
@@ -224,9 +226,20 @@ void QTRLEDecoder::decode8(Common::SeekableReadStream &stream, uint32 rowPtr, ui
 	}
 }
 
+template<typename PixelInt, bool kConvert>
+static inline PixelInt convertColor16(uint16 color, const Graphics::PixelFormat &format) {
+	if (!kConvert)
+		return color;
+
+	byte r, g, b;
+	kNativeFormat16.colorToRGB(color, r, g, b);
+	return format.RGBToColor(r, g, b);
+}
+
+template<typename PixelInt, bool kConvert>
 void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint16 *rgb = (uint16 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -242,7 +255,7 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 				rleCode = -rleCode;
 				CHECK_STREAM_PTR(2);
 
-				uint16 rgb16 = stream.readUint16BE();
+				PixelInt rgb16 = convertColor16<PixelInt, kConvert>(stream.readUint16BE(), _surface->format);
 
 				CHECK_PIXEL_PTR(rleCode);
 
@@ -254,7 +267,7 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 
 				// copy pixels directly to output
 				while (rleCode--)
-					rgb[pixelPtr++] = stream.readUint16BE();
+					rgb[pixelPtr++] = convertColor16<PixelInt, kConvert>(stream.readUint16BE(), _surface->format);
 			}
 		}
 
@@ -262,9 +275,10 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 	}
 }
 
+template<typename PixelInt>
 void QTRLEDecoder::decode24(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint32 *rgb = (uint32 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -373,9 +387,10 @@ void QTRLEDecoder::dither24(Common::SeekableReadStream &stream, uint32 rowPtr, u
 	}
 }
 
+template<typename PixelInt>
 void QTRLEDecoder::decode32(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint32 *rgb = (uint32 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -469,16 +484,26 @@ const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &s
 		decode8(stream, rowPtr, height);
 		break;
 	case 16:
-		decode16(stream, rowPtr, height);
+		if (_surface->format == kNativeFormat16)
+			decode16<uint16, false>(stream, rowPtr, height);
+		else if (_surface->format.bytesPerPixel == 2)
+			decode16<uint16, true>(stream, rowPtr, height);
+		else
+			decode16<uint32, true>(stream, rowPtr, height);
 		break;
 	case 24:
 		if (_ditherPalette)
 			dither24(stream, rowPtr, height);
+		else if (_surface->format.bytesPerPixel == 2)
+			decode24<uint16>(stream, rowPtr, height);
 		else
-			decode24(stream, rowPtr, height);
+			decode24<uint32>(stream, rowPtr, height);
 		break;
 	case 32:
-		decode32(stream, rowPtr, height);
+		if (_surface->format.bytesPerPixel == 2)
+			decode32<uint16>(stream, rowPtr, height);
+		else
+			decode32<uint32>(stream, rowPtr, height);
 		break;
 	default:
 		error("Unsupported QTRLE bits per pixel %d", _bitsPerPixel);
@@ -502,10 +527,10 @@ Graphics::PixelFormat QTRLEDecoder::getPixelFormat() const {
 	case 40:
 		return Graphics::PixelFormat::createFormatCLUT8();
 	case 16:
-		return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		return _pixelFormat.bytesPerPixel ? _pixelFormat : kNativeFormat16;
 	case 24:
 	case 32:
-		return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		return _pixelFormat.bytesPerPixel ? _pixelFormat : Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
 	default:
 		error("Unsupported QTRLE bits per pixel %d", _bitsPerPixel);
 	}
@@ -513,6 +538,20 @@ Graphics::PixelFormat QTRLEDecoder::getPixelFormat() const {
 	return Graphics::PixelFormat();
 }
 
+bool QTRLEDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (_ditherPalette || (_bitsPerPixel != 16 && _bitsPerPixel != 24 && _bitsPerPixel != 32))
+		return false;
+	if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4)
+		return false;
+
+	_pixelFormat = format;
+
+	if (_surface && _surface->format != format)
+		createSurface();
+
+	return true;
+}
+
 bool QTRLEDecoder::canDither(DitherType type) const {
 	// Only 24-bit dithering is implemented at the moment
 	return type == kDitherTypeQT && _bitsPerPixel == 24;
@@ -39,6 +39,7 @@ public:
 
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream) override;
 	Graphics::PixelFormat getPixelFormat() const override;
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format) override;
 
 	bool containsPalette() const override { return _ditherPalette != 0; }
 	const byte *getPalette() override { _dirtyPalette = false; return _ditherPalette; }
@@ -54,15 +55,19 @@ private:
 	byte *_ditherPalette;
 	bool _dirtyPalette;
 	byte *_colorMap;
+	Graphics::PixelFormat _pixelFormat;
 
 	void createSurface();
 
 	void decode1(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
 	void decode2_4(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange, byte bpp);
 	void decode8(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
+	template<typename PixelInt, bool kConvert>
 	void decode16(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
+	template<typename PixelInt>
 	void decode24(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
 	void dither24(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
+	template<typename PixelInt>
 	void decode32(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
 };
 
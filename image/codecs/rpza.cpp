@@ -30,8 +30,10 @@
 
 namespace Image {
 
+static const Graphics::PixelFormat kNativeFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+
 RPZADecoder::RPZADecoder(uint16 width, uint16 height) : Codec() {
-	_format = Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+	_format = kNativeFormat;
 	_ditherPalette = 0;
 	_dirtyPalette = false;
 	_colorMap = 0;
@@ -63,7 +65,7 @@ RPZADecoder::~RPZADecoder() {
 		error("rpza block counter just went negative (this should not happen)") \
 
 struct BlockDecoderRaw {
-	static inline void drawFillBlock(uint16 *blockPtr, uint16 pitch, uint16 color, const byte *colorMap) {
+	inline void drawFillBlock(uint16 *blockPtr, uint16 pitch, uint16 color) const {
 		blockPtr[0] = color;
 		blockPtr[1] = color;
 		blockPtr[2] = color;
@@ -85,7 +87,7 @@ struct BlockDecoderRaw {
 		blockPtr[3] = color;
 	}
 
-	static inline void drawRawBlock(uint16 *blockPtr, uint16 pitch, const uint16 (&colors)[16], const byte *colorMap) {
+	inline void drawRawBlock(uint16 *blockPtr, uint16 pitch, const uint16 (&colors)[16]) const {
 		blockPtr[0] = colors[0];
 		blockPtr[1] = colors[1];
 		blockPtr[2] = colors[2];
@@ -107,7 +109,7 @@ struct BlockDecoderRaw {
 		blockPtr[3] = colors[15];
 	}
 
-	static inline void drawBlendBlock(uint16 *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4], const byte *colorMap) {
+	inline void drawBlendBlock(uint16 *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4]) const {
 		blockPtr[0] = colors[(indexes[0] >> 6) & 0x03];
 		blockPtr[1] = colors[(indexes[0] >> 4) & 0x03];
 		blockPtr[2] = colors[(indexes[0] >> 2) & 0x03];
@@ -131,7 +133,11 @@ struct BlockDecoderRaw {
 };
 
 struct BlockDecoderDither {
-	static inline void drawFillBlock(byte *blockPtr, uint16 pitch, uint16 color, const byte *colorMap) {
+	const byte *colorMap;
+
+	BlockDecoderDither(const byte *map) : colorMap(map) {}
+
+	inline void drawFillBlock(byte *blockPtr, uint16 pitch, uint16 color) const {
 		const byte *mapOffset = colorMap + (color >> 1);
 		byte pixel1 = mapOffset[0x0000];
 		byte pixel2 = mapOffset[0x4000];
@@ -159,7 +165,7 @@ struct BlockDecoderDither {
 		blockPtr[3] = pixel2;
 	}
 
-	static inline void drawRawBlock(byte *blockPtr, uint16 pitch, const uint16 (&colors)[16], const byte *colorMap) {
+	inline void drawRawBlock(byte *blockPtr, uint16 pitch, const uint16 (&colors)[16]) const {
 		blockPtr[0] = colorMap[(colors[0] >> 1) + 0x0000];
 		blockPtr[1] = colorMap[(colors[1] >> 1) + 0x4000];
 		blockPtr[2] = colorMap[(colors[2] >> 1) + 0x8000];
@@ -181,7 +187,7 @@ struct BlockDecoderDither {
 		blockPtr[3] = colorMap[(colors[15] >> 1) + 0x4000];
 	}
 
-	static inline void drawBlendBlock(byte *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4], const byte *colorMap) {
+	inline void drawBlendBlock(byte *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4]) const {
 		blockPtr[0] = colorMap[(colors[(indexes[0] >> 6) & 0x03] >> 1) + 0x0000];
 		blockPtr[1] = colorMap[(colors[(indexes[0] >> 4) & 0x03] >> 1) + 0x4000];
 		blockPtr[2] = colorMap[(colors[(indexes[0] >> 2) & 0x03] >> 1) + 0x8000];
@@ -204,8 +210,46 @@ struct BlockDecoderDither {
 	}
 };
 
+/** Converts the RGB555 colors to another output format. */
+template<typename PixelInt>
+struct BlockDecoderConvert {
+	const Graphics::PixelFormat &format;
+
+	BlockDecoderConvert(const Graphics::PixelFormat &f) : format(f) {}
+
+	inline PixelInt convert(uint16 color) const {
+		byte r, g, b;
+		kNativeFormat.colorToRGB(color, r, g, b);
+		return format.RGBToColor(r, g, b);
+	}
+
+	inline void drawFillBlock(PixelInt *blockPtr, uint16 pitch, uint16 color) const {
+		const PixelInt pixel = convert(color);
+
+		for (int y = 0; y < 4; y++, blockPtr += pitch)
+			blockPtr[0] = blockPtr[1] = blockPtr[2] = blockPtr[3] = pixel;
+	}
+
+	inline void drawRawBlock(PixelInt *blockPtr, uint16 pitch, const uint16 (&colors)[16]) const {
+		for (int y = 0; y < 4; y++, blockPtr += pitch)
+			for (int x = 0; x < 4; x++)
+				blockPtr[x] = convert(colors[y * 4 + x]);
+	}
+
+	inline void drawBlendBlock(PixelInt *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4]) const {
+		const PixelInt pixels[4] = { convert(colors[0]), convert(colors[1]), convert(colors[2]), convert(colors[3]) };
+
+		for (int y = 0; y < 4; y++, blockPtr += pitch) {
+			blockPtr[0] = pixels[(indexes[y] >> 6) & 0x03];
+			blockPtr[1] = pixels[(indexes[y] >> 4) & 0x03];
+			blockPtr[2] = pixels[(indexes[y] >> 2) & 0x03];
+			blockPtr[3] = pixels[(indexes[y] >> 0) & 0x03];
+		}
+	}
+};
+
 template<typename PixelInt, typename BlockDecoder>
-static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt *ptr, uint16 pitch, uint16 blockWidth, uint16 blockHeight, const byte *colorMap) {
+static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt *ptr, uint16 pitch, uint16 blockWidth, uint16 blockHeight, const BlockDecoder &blockDecoder) {
 	uint16 colorA = 0, colorB = 0;
 	uint16 color4[4];
 
@@ -261,7 +305,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 			colorA = stream.readUint16BE();
 
 			while (numBlocks--) {
-				BlockDecoder::drawFillBlock(blockPtr, pitch, colorA, colorMap);
+				blockDecoder.drawFillBlock(blockPtr, pitch, colorA);
 				ADVANCE_BLOCK();
 			}
 			break;
@@ -301,7 +345,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 				byte indexes[4];
 				stream.read(indexes, 4);
 
-				BlockDecoder::drawBlendBlock(blockPtr, pitch, color4, indexes, colorMap);
+				blockDecoder.drawBlendBlock(blockPtr, pitch, color4, indexes);
 				ADVANCE_BLOCK();
 			}
 			break;
@@ -314,7 +358,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 			for (int i = 0; i < 15; i++)
 				colors[i + 1] = stream.readUint16BE();
 
-			BlockDecoder::drawRawBlock(blockPtr, pitch, colors, colorMap);
+			blockDecoder.drawRawBlock(blockPtr, pitch, colors);
 			ADVANCE_BLOCK();
 			break;
 		}
@@ -339,13 +383,32 @@ const Graphics::Surface *RPZADecoder::decodeFrame(Common::SeekableReadStream &st
 	}
 
 	if (_colorMap)
-		decodeFrameTmpl<byte, BlockDecoderDither>(stream, (byte *)_surface->getPixels(), _surface->pitch, _blockWidth, _blockHeight, _colorMap);
+		decodeFrameTmpl(stream, (byte *)_surface->getPixels(), _surface->pitch, _blockWidth, _blockHeight, BlockDecoderDither(_colorMap));
+	else if (_format == kNativeFormat)
+		decodeFrameTmpl(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, BlockDecoderRaw());
+	else if (_format.bytesPerPixel == 2)
+		decodeFrameTmpl(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, BlockDecoderConvert<uint16>(_format));
 	else
-		decodeFrameTmpl<uint16, BlockDecoderRaw>(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, _colorMap);
+		decodeFrameTmpl(stream, (uint32 *)_surface->getPixels(), _surface->pitch / 4, _blockWidth, _blockHeight, BlockDecoderConvert<uint32>(_format));
 
 	return _surface;
 }
 
+bool RPZADecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (_colorMap || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	// The surface is created again by the next frame
+	if (_surface && _surface->format != format) {
+		_surface->free();
+		delete _surface;
+		_surface = 0;
+	}
+
+	_format = format;
+	return true;
+}
+
 bool RPZADecoder::canDither(DitherType type) const {
 	return type == kDitherTypeQT;
 }
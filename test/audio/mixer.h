@@ -0,0 +1,122 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_play_and_stop() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl impl(22050);
+		impl.setReady(true);
+		Audio::Mixer &mixer = impl;
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false), 1, 100);
+
+		// The channel is only inserted by the next mixing pass, but
+		// queries have to reflect it right away
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixer.isSoundIDActive(1));
+		TS_ASSERT_EQUALS(mixer.getSoundID(handle), 1);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 100);
+		TS_ASSERT(mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+
+		mixer.setChannelVolume(handle, 200);
+		mixer.setChannelBalance(handle, -20);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 200);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -20);
+
+		int16 buffer[512 * 2];
+		TS_ASSERT_EQUALS(impl.mixCallback((byte *)buffer, sizeof(buffer)), 512);
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.isSoundIDActive(1));
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+#endif
+	}
+
+	void test_finished_channels_are_reclaimed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl impl(22050);
+		impl.setReady(true);
+		Audio::Mixer &mixer = impl;
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false));
+
+		int16 buffer[512 * 2];
+		impl.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+
+		// Finished channels are handed back by the next mixing pass and
+		// freed once the engine side touches the mixer again
+		for (int i = 0; i < 50; ++i)
+			impl.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+#endif
+	}
+
+	void test_command_queue_overflow() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl impl(22050);
+		impl.setReady(true);
+		Audio::Mixer &mixer = impl;
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kMusicSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false));
+
+		// Without a running mixing thread the queue fills up, which must
+		// neither block nor lose the latest state
+		for (int i = 0; i < 1000; ++i)
+			mixer.setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 999 & 0xFF);
+
+		for (int i = 0; i < 40; ++i)
+			mixer.playStream(Audio::Mixer::kSFXSoundType, nullptr, createSineStream<int16>(22050, 1, nullptr, false, false));
+
+		mixer.stopAll();
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+#endif
+	}
+
+	void test_parallel_mixing() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl serialImpl(22050);
+		ConfMan.setBool("audio_parallel_mixing", true, Common::ConfigManager::kApplicationDomain);
+		Audio::MixerImpl parallelImpl(22050);
+		ConfMan.removeKey("audio_parallel_mixing", Common::ConfigManager::kApplicationDomain);
+
+		Audio::MixerImpl *impls[2] = { &serialImpl, &parallelImpl };
+		int16 buffers[2][512 * 2];
+
+		for (int i = 0; i < 2; ++i) {
+			impls[i]->setReady(true);
+			Audio::Mixer &mixer = *impls[i];
+
+			// Keep the sum in range, clipping happens at different stages
+			mixer.playStream(Audio::Mixer::kSFXSoundType, nullptr, createSineStream<int16>(22050, 1, nullptr, false, false), -1, 60);
+			mixer.playStream(Audio::Mixer::kSFXSoundType, nullptr, createSineStream<int16>(11025, 1, nullptr, false, true), -1, 60, 50);
+			mixer.playStream(Audio::Mixer::kMusicSoundType, nullptr, createSineStream<int16>(44100, 1, nullptr, false, false), -1, 60, -30);
+
+			for (int pass = 0; pass < 4; ++pass)
+				TS_ASSERT_EQUALS(impls[i]->mixCallback((byte *)buffers[i], sizeof(buffers[i])), 512);
+		}
+
+		TS_ASSERT_EQUALS(memcmp(buffers[0], buffers[1], sizeof(buffers[0])), 0);
+#endif
+	}
+};
@@ -0,0 +1,136 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/pcm_cache.h"
+#include "audio/decoders/raw.h"
+
+class PCMCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	/** Create a mono clip with the given number of samples, counting up from the seed. */
+	static Audio::SeekableAudioStream *createClip(uint numSamples, int16 seed) {
+		int16 *data = (int16 *)malloc(numSamples * sizeof(int16));
+		for (uint i = 0; i < numSamples; ++i)
+			data[i] = seed + i;
+
+		return Audio::makeRawStream((byte *)data, numSamples * sizeof(int16), 22050, Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+			| Audio::FLAG_LITTLE_ENDIAN
+#endif
+		);
+	}
+
+	/** Forwards to a clip, without telling its length, like some decoders do. */
+	class UnknownLengthStream : public Audio::SeekableAudioStream {
+	public:
+		UnknownLengthStream(Audio::SeekableAudioStream *parent) : _parent(parent) {}
+		~UnknownLengthStream() { delete _parent; }
+
+		int readBuffer(int16 *buffer, const int numSamples) override { return _parent->readBuffer(buffer, numSamples); }
+		bool isStereo() const override { return _parent->isStereo(); }
+		int getRate() const override { return _parent->getRate(); }
+		bool endOfData() const override { return _parent->endOfData(); }
+		bool seek(const Audio::Timestamp &where) override { return _parent->seek(where); }
+		Audio::Timestamp getLength() const override { return Audio::Timestamp(0, getRate()); }
+
+	private:
+		Audio::SeekableAudioStream *_parent;
+	};
+
+	static bool checkClip(Audio::SeekableAudioStream *stream, uint numSamples, int16 seed) {
+		int16 buffer[256];
+		uint pos = 0;
+		while (!stream->endOfData()) {
+			const int count = stream->readBuffer(buffer, ARRAYSIZE(buffer));
+			for (int i = 0; i < count; ++i, ++pos)
+				if (buffer[i] != (int16)(seed + pos))
+					return false;
+		}
+
+		return pos == numSamples;
+	}
+
+public:
+	void test_hit_and_miss() {
+		Audio::PCMCache cache;
+
+		TS_ASSERT(!cache.getStream("step"));
+		TS_ASSERT_EQUALS(cache.getMisses(), 1u);
+
+		Audio::SeekableAudioStream *stream = cache.addStream("step", createClip(1000, 5));
+		TS_ASSERT(checkClip(stream, 1000, 5));
+		delete stream;
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 2000u);
+
+		for (int i = 0; i < 3; ++i) {
+			stream = cache.getStream("step");
+			TS_ASSERT(stream);
+			TS_ASSERT(checkClip(stream, 1000, 5));
+
+			// Cached clips can be replayed like any seekable stream
+			TS_ASSERT(stream->rewind());
+			TS_ASSERT(checkClip(stream, 1000, 5));
+			delete stream;
+		}
+
+		TS_ASSERT_EQUALS(cache.getHits(), 3u);
+	}
+
+	void test_lru_eviction() {
+		Audio::PCMCache cache(5000, 5000);
+
+		delete cache.addStream("a", createClip(1000, 1));
+		delete cache.addStream("b", createClip(1000, 2));
+		delete cache.getStream("a");
+
+		// "b" is the least recently played clip now
+		delete cache.addStream("c", createClip(1000, 3));
+		TS_ASSERT(cache.contains("a"));
+		TS_ASSERT(!cache.contains("b"));
+		TS_ASSERT(cache.contains("c"));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 4000u);
+	}
+
+	void test_long_clips_are_not_cached() {
+		Audio::PCMCache cache(10000, 1000);
+
+		Audio::SeekableAudioStream *stream = cache.addStream("music", createClip(1000, 7));
+		TS_ASSERT(!cache.contains("music"));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+		TS_ASSERT(checkClip(stream, 1000, 7));
+		delete stream;
+	}
+
+	void test_unknown_length() {
+		Audio::PCMCache cache(100000, 50000);
+
+		// The whole clip is decoded, and only its actual size is charged
+		Audio::SeekableAudioStream *stream = cache.addStream("door", new UnknownLengthStream(createClip(20000, 3)));
+		TS_ASSERT(cache.contains("door"));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 40000u);
+		TS_ASSERT(checkClip(stream, 20000, 3));
+		delete stream;
+
+		// Clips turning out too long are handed back from their start
+		stream = cache.addStream("wind", new UnknownLengthStream(createClip(30000, 4)));
+		TS_ASSERT(!cache.contains("wind"));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 40000u);
+		TS_ASSERT(checkClip(stream, 30000, 4));
+		delete stream;
+	}
+
+	void test_streams_outlive_their_entries() {
+		Audio::SeekableAudioStream *stream;
+
+		{
+			Audio::PCMCache cache;
+			delete cache.addStream("click", createClip(300, 9));
+			stream = cache.getStream("click");
+			cache.clear();
+			TS_ASSERT(!cache.contains("click"));
+		}
+
+		TS_ASSERT(checkClip(stream, 300, 9));
+		delete stream;
+	}
+};
@@ -0,0 +1,206 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoders/raw.h"
+#include "audio/rate.h"
+#include "audio/rate_intern.h"
+#include "common/str.h"
+
+#include "test/instrset_detect.h"
+#include "../null_osystem.h"
+
+#include <math.h>
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class RateKernelsTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int16 nextSample() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	void compareKernels(const Audio::RateKernels &reference, const Audio::RateKernels &kernels) {
+		int16 in[2 * 300], last[2 * 300], cur[2 * 300];
+		int16 outRef[2 * 300], out[2 * 300];
+		uint16 frac[2 * 300];
+		int16 taps[64];
+
+		for (int round = 0; round < 50; ++round) {
+			const uint numFrames = round * 5 + (round & 7);
+			for (uint i = 0; i < ARRAYSIZE(in); ++i) {
+				in[i] = nextSample();
+				last[i] = nextSample();
+				cur[i] = nextSample();
+				frac[i] = (uint16)nextSample() & (Audio::FRAC_ONE_LOW - 1);
+				outRef[i] = out[i] = nextSample();
+			}
+
+			// Include the extreme values to check the clamping
+			in[0] = -32768;
+			in[1] = 32767;
+			outRef[0] = out[0] = -32768;
+			outRef[1] = out[1] = 32767;
+
+			const Audio::st_volume_t volL = (round * 37) % (Audio::Mixer::kMaxMixerVolume + 1);
+			const Audio::st_volume_t volR = (round == 0) ? Audio::Mixer::kMaxMixerVolume : (round * 91) % (Audio::Mixer::kMaxMixerVolume + 1);
+
+			for (int mode = 0; mode < 8; ++mode) {
+				const bool inStereo = (mode & 4) != 0, outStereo = (mode & 2) != 0, reverse = (mode & 1) != 0;
+				int16 outRefCopy[ARRAYSIZE(outRef)];
+				int16 outCopy[ARRAYSIZE(out)];
+				memcpy(outRefCopy, outRef, sizeof(outRef));
+				memcpy(outCopy, out, sizeof(out));
+
+				reference.mix[inStereo][outStereo][reverse](outRefCopy, in, numFrames, volL, volR);
+				kernels.mix[inStereo][outStereo][reverse](outCopy, in, numFrames, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(outRefCopy, outCopy, sizeof(out)), 0);
+			}
+
+			reference.interpolate(outRef, last, cur, frac, numFrames * 2);
+			kernels.interpolate(out, last, cur, frac, numFrames * 2);
+			TS_ASSERT_EQUALS(memcmp(outRef, out, sizeof(out)), 0);
+
+			// Keep the taps in the range of real filters, which sum up to 1 << 14
+			for (uint i = 0; i < ARRAYSIZE(taps); ++i)
+				taps[i] = nextSample() >> 6;
+
+			for (uint count = 16; count <= ARRAYSIZE(taps); count += 16)
+				TS_ASSERT_EQUALS(reference.dotProduct(in + round, taps, count), kernels.dotProduct(in + round, taps, count));
+		}
+	}
+
+public:
+	void test_simd_kernels() {
+		_seed = 1;
+
+		Audio::RateKernels reference;
+		Audio::setupRateKernelsGeneric(reference);
+
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			Audio::RateKernels sse2;
+			Audio::setupRateKernelsSSE2(sse2);
+			compareKernels(reference, sse2);
+		}
+#endif
+
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			Audio::RateKernels avx2;
+			Audio::setupRateKernelsAVX2(avx2);
+			compareKernels(reference, avx2);
+		}
+#endif
+
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		// NEON is always available on aarch64
+		Audio::RateKernels neon;
+		Audio::setupRateKernelsNEON(neon);
+		compareKernels(reference, neon);
+#endif
+	}
+};
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	/** Create a sine tone of the given frequency, played for one second. */
+	static Audio::AudioStream *createTone(int rate, int frequency, bool stereo = false) {
+		const int channels = stereo ? 2 : 1;
+		byte *data = (byte *)malloc(rate * channels * 2);
+		for (int i = 0; i < rate * channels; ++i)
+			WRITE_LE_INT16(data + i * 2, (int16)(sin(2 * M_PI * frequency * (i / channels) / rate) * 16000));
+
+		return Audio::makeRawStream(data, rate * channels * 2, rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+	}
+
+	/** Power of a single frequency in the signal, computed with the Goertzel algorithm. */
+	static double power(const int16 *samples, int numSamples, int rate, int frequency) {
+		const double coef = 2 * cos(2 * M_PI * frequency / rate);
+		double s1 = 0.0, s2 = 0.0;
+		for (int i = 0; i < numSamples; ++i) {
+			const double s0 = samples[i] + coef * s1 - s2;
+			s2 = s1;
+			s1 = s0;
+		}
+
+		return s1 * s1 + s2 * s2 - coef * s1 * s2;
+	}
+
+	/** Resample a 3 kHz tone from 11025 Hz to 48000 Hz, returning the power of its strongest image relative to the tone. */
+	static double imageLevel(Audio::ResamplerQuality quality) {
+		Audio::AudioStream *input = createTone(11025, 3000);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 48000, false, false, false, quality);
+
+		int16 *output = new int16[48000]();
+		const int numSamples = converter->convert(*input, output, 48000, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+		// Skip the start, where the filter still sees silence
+		const int16 *samples = output + 1000;
+		const int count = numSamples - 2000;
+		const double tone = power(samples, count, 48000, 3000);
+		const double image = MAX(power(samples, count, 48000, 11025 - 3000), power(samples, count, 48000, 11025 + 3000));
+
+		delete[] output;
+		delete converter;
+		delete input;
+
+		return image / tone;
+	}
+
+	/** Time how long it takes to resample ten seconds of stereo audio from 22050 Hz to 44100 Hz. */
+	static uint32 convertTime(Audio::ResamplerQuality quality) {
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, true, true, false, quality);
+		int16 output[1024 * 2];
+
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < 10; ++i) {
+			Audio::AudioStream *input = createTone(22050, 1000, true);
+			for (int j = 0; j < 44100 / 1024; ++j)
+				converter->convert(*input, output, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			delete input;
+		}
+		const uint32 time = g_system->getMillis() - start;
+
+		delete converter;
+		return time;
+	}
+
+public:
+	void test_sinc_image_rejection() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const double linear = imageLevel(Audio::kResamplerLinear);
+		const double sinc = imageLevel(Audio::kResamplerSinc);
+
+		// Linear interpolation leaves images at about -25 dB, the
+		// windowed-sinc filter has to get them below -60 dB
+		TS_ASSERT_LESS_THAN(sinc, linear);
+		TS_ASSERT_LESS_THAN(sinc, 1e-6);
+#endif
+	}
+
+	void test_resampler_speed() {
+#if BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		const uint32 linearTime = convertTime(Audio::kResamplerLinear);
+		const uint32 sincTime = convertTime(Audio::kResamplerSinc);
+
+		TS_TRACE(Common::String::format("Resampling 10s of 22050 Hz stereo audio to 44100 Hz: linear %d ms (image level %.1f dB), sinc %d ms (image level %.1f dB)",
+		         linearTime, 10 * log10(imageLevel(Audio::kResamplerLinear)),
+		         sincTime, 10 * log10(imageLevel(Audio::kResamplerSinc))).c_str());
+#endif
+	}
+};
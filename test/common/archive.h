@@ -0,0 +1,141 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+
+#include "../null_osystem.h"
+
+class CountingArchive : public Common::MemcachingCaseInsensitiveArchive {
+public:
+	CountingArchive(uint32 maxCacheSize = 0) : Common::MemcachingCaseInsensitiveArchive(16, maxCacheSize), _reads(0), _prefetches(0) {}
+
+	bool hasFile(const Common::Path &path) const override {
+		return getSize(path) != 0;
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		return 0;
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		return Common::ArchiveMemberPtr();
+	}
+
+	Common::SharedArchiveContents readContentsForPath(const Common::Path &translatedPath) const override {
+		const uint32 size = getSize(translatedPath);
+		if (!size)
+			return Common::SharedArchiveContents();
+
+		_reads++;
+		byte *data = new byte[size];
+		memset(data, 'x', size);
+		return Common::SharedArchiveContents(data, size);
+	}
+
+	void prefetchMember(const Common::Path &path) const override {
+		_prefetches++;
+	}
+
+	mutable int _reads;
+	mutable int _prefetches;
+
+private:
+	static uint32 getSize(const Common::Path &path) {
+		if (path == Common::Path("small"))
+			return 8;
+		if (path == Common::Path("large"))
+			return 100;
+		if (path == Common::Path("large2"))
+			return 60;
+		if (path == Common::Path("huge"))
+			return 1000;
+		return 0;
+	}
+};
+
+class ArchiveTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_memcaching_lru() {
+		CountingArchive archive(200);
+
+		delete archive.createReadStreamForMember("large");
+		delete archive.createReadStreamForMember("large");
+		TS_ASSERT_EQUALS(archive._reads, 1);
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 100U);
+
+		// Too big for the budget, so it does not push the others out
+		delete archive.createReadStreamForMember("huge");
+		delete archive.createReadStreamForMember("huge");
+		TS_ASSERT_EQUALS(archive._reads, 3);
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 100U);
+
+		delete archive.createReadStreamForMember("large2");
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 160U);
+
+		// Use "large" again, so that "large2" is the least recently used
+		delete archive.createReadStreamForMember("large");
+		TS_ASSERT_EQUALS(archive._reads, 4);
+
+		archive.setMaxCacheSize(150);
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 100U);
+		delete archive.createReadStreamForMember("large");
+		TS_ASSERT_EQUALS(archive._reads, 4);
+		delete archive.createReadStreamForMember("large2");
+		TS_ASSERT_EQUALS(archive._reads, 5);
+
+		// That pushed out "large", and an evicted member stays available
+		// while it is open
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 60U);
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive.createReadStreamForMember("large2"));
+		archive.setMaxCacheSize(0);
+		TS_ASSERT_EQUALS(archive.getCacheSize(), 0U);
+		delete archive.createReadStreamForMember("large2");
+		TS_ASSERT_EQUALS(archive._reads, 5);
+		stream.reset();
+		delete archive.createReadStreamForMember("large2");
+		TS_ASSERT_EQUALS(archive._reads, 6);
+
+		TS_ASSERT_EQUALS(archive.getCacheMisses(), 6U);
+		TS_ASSERT_EQUALS(archive.getCacheHits(), 5U);
+		TS_ASSERT_EQUALS(archive.getBytesRead(), 100U + 1000U * 2 + 60U * 3);
+	}
+
+	void test_search_set_prefetch() {
+		CountingArchive *first = new CountingArchive(200);
+		CountingArchive *second = new CountingArchive(200);
+
+		Common::SearchSet searchSet;
+		searchSet.add("first", first, 1);
+		searchSet.add("second", second, 0);
+
+		// Only the archive which would be opened is asked
+		searchSet.prefetchMember("large");
+		TS_ASSERT_EQUALS(first->_prefetches, 1);
+		TS_ASSERT_EQUALS(second->_prefetches, 0);
+
+		searchSet.prefetchMember("missing");
+		TS_ASSERT_EQUALS(first->_prefetches, 1);
+		TS_ASSERT_EQUALS(second->_prefetches, 0);
+	}
+
+	void test_directory_prefetch() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// The tests run from the build directory
+		Common::FSDirectory dir("test");
+		if (!dir.hasFile("runner"))
+			return;
+
+		dir.prefetchMember("runner");
+		dir.prefetchMember("missing");
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(dir.createReadStreamForMember("runner"));
+		TS_ASSERT(stream);
+		TS_ASSERT_LESS_THAN(0, stream->size());
+#endif
+	}
+};
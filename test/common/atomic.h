@@ -0,0 +1,39 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/threadpool.h"
+
+#include "../null_osystem.h"
+
+class AtomicTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_load_store() {
+		volatile uint32 value = 0;
+		Common::atomicStoreRelease(value, 0xFFFFFFFF);
+		TS_ASSERT_EQUALS(Common::atomicLoadAcquire(value), 0xFFFFFFFFU);
+	}
+
+	void test_increment_decrement() {
+		volatile int32 value = 0;
+		TS_ASSERT_EQUALS(Common::atomicIncrement(value), 1);
+		TS_ASSERT_EQUALS(Common::atomicIncrement(value), 2);
+		TS_ASSERT_EQUALS(Common::atomicDecrement(value), 1);
+		TS_ASSERT_EQUALS(Common::atomicDecrement(value), 0);
+		TS_ASSERT_EQUALS(Common::atomicDecrement(value), -1);
+	}
+
+	void test_concurrent_increment() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		volatile int32 value = 0;
+		Common::ThreadPool pool(4);
+		pool.parallelFor(64, [&value](uint) {
+			for (int i = 0; i < 1000; ++i)
+				Common::atomicIncrement(value);
+		});
+		TS_ASSERT_EQUALS(value, 64 * 1000);
+#endif
+	}
+};
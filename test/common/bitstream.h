@@ -255,4 +255,55 @@ public:
 		tmpl_align_16<Common::MemoryReadStream, Common::BitStream16BELSB>();
 		tmpl_align_16<Common::BitStreamMemoryStream, Common::BitStreamMemory16BELSB>();
 	}
+
+private:
+	template<class BS, class MBS>
+	void tmpl_memory_refill() {
+		byte contents[61];
+		uint32 seed = 1;
+		for (uint i = 0; i < sizeof(contents); i++) {
+			seed = seed * 1103515245 + 12345;
+			contents[i] = seed >> 16;
+		}
+
+		// The memory stream loads 64 bits at a time and has to give the
+		// same bits as reading value by value, up to and past the end
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		BS bs(ms);
+		Common::BitStreamMemoryStream mms(contents, sizeof(contents));
+		MBS mbs(mms);
+
+		while (bs.pos() < bs.size() + 40) {
+			seed = seed * 1103515245 + 12345;
+			const uint n = (seed >> 16) % 33;
+			TS_ASSERT_EQUALS(mbs.peekBits(n), bs.peekBits(n));
+			TS_ASSERT_EQUALS(mbs.getBits(n), bs.getBits(n));
+			TS_ASSERT_EQUALS(mbs.pos(), bs.pos());
+		}
+
+		// Several unchecked reads after a single refill
+		bs.rewind();
+		mbs.rewind();
+		while (bs.pos() < bs.size()) {
+			mbs.refill();
+			for (uint n = 1; n <= 8; n++) {
+				TS_ASSERT_EQUALS(mbs.peekBitsFast(n), bs.peekBits(n));
+				TS_ASSERT_EQUALS(mbs.getBitsFast(n), bs.getBits(n));
+			}
+			TS_ASSERT_EQUALS(mbs.pos(), bs.pos());
+		}
+	}
+public:
+	void test_memory_refill() {
+		tmpl_memory_refill<Common::BitStream8MSB, Common::BitStreamMemory8MSB>();
+		tmpl_memory_refill<Common::BitStream8LSB, Common::BitStreamMemory8LSB>();
+		tmpl_memory_refill<Common::BitStream16LEMSB, Common::BitStreamMemory16LEMSB>();
+		tmpl_memory_refill<Common::BitStream16LELSB, Common::BitStreamMemory16LELSB>();
+		tmpl_memory_refill<Common::BitStream16BEMSB, Common::BitStreamMemory16BEMSB>();
+		tmpl_memory_refill<Common::BitStream16BELSB, Common::BitStreamMemory16BELSB>();
+		tmpl_memory_refill<Common::BitStream32LEMSB, Common::BitStreamMemory32LEMSB>();
+		tmpl_memory_refill<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>();
+		tmpl_memory_refill<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>();
+		tmpl_memory_refill<Common::BitStream32BELSB, Common::BitStreamMemory32BELSB>();
+	}
 };
@@ -10,6 +10,73 @@
 * TODO: It could be improved by generating one at runtime.
 */
 class HuffmanTestSuite : public CxxTest::TestSuite {
+	/** Lengths of a complete code with codes too long for a single table. */
+	static const int kLongCodeCount = 21;
+
+	/** Assign canonical codes, with their first bit as the most significant one. */
+	static void makeLongCodes(uint8 *lengths, uint32 *codes) {
+		for (int i = 0; i < kLongCodeCount; i++)
+			lengths[i] = MIN(i + 1, kLongCodeCount - 1);
+
+		uint32 code = 0;
+		for (int i = 0; i < kLongCodeCount; i++) {
+			if (i > 0)
+				code = (code + 1) << (lengths[i] - lengths[i - 1]);
+			codes[i] = code;
+		}
+	}
+
+	/** Encode random symbols, writing the bits in the order the stream reads them. */
+	static uint32 encode(byte *data, uint32 size, uint32 *expected, uint32 count, const uint8 *lengths, const uint32 *codes, bool msb2lsb) {
+		memset(data, 0, size);
+
+		uint32 seed = 1, pos = 0;
+		for (uint32 i = 0; i < count; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 symbol = (seed >> 16) % kLongCodeCount;
+			expected[i] = symbol;
+
+			for (int b = lengths[symbol] - 1; b >= 0; b--, pos++) {
+				assert(pos < size * 8);
+				if ((codes[symbol] >> b) & 1)
+					data[pos >> 3] |= msb2lsb ? 0x80 >> (pos & 7) : 1 << (pos & 7);
+			}
+		}
+
+		return pos;
+	}
+
+	template<class BITSTREAM>
+	void checkLongCodes(bool msb2lsb, uint8 tableBits) {
+		uint8 lengths[kLongCodeCount];
+		uint32 codes[kLongCodeCount], streamCodes[kLongCodeCount];
+		makeLongCodes(lengths, codes);
+
+		// Streams read LSB first take their codes in that order, too
+		for (int i = 0; i < kLongCodeCount; i++)
+			streamCodes[i] = msb2lsb ? codes[i] : Common::REVERSEBITS(codes[i]) >> (32 - lengths[i]);
+
+		Common::Huffman<BITSTREAM> h(0, kLongCodeCount, streamCodes, lengths, nullptr, tableBits);
+
+		const uint32 count = 2000;
+		byte data[count * 4];
+		uint32 expected[count];
+		const uint32 bitCount = encode(data, sizeof(data), expected, count, lengths, codes, msb2lsb);
+
+		Common::MemoryReadStream ms(data, sizeof(data));
+		BITSTREAM bs(ms);
+		for (uint32 i = 0; i < count; i++)
+			TS_ASSERT_EQUALS(h.getSymbol(bs), expected[i]);
+		TS_ASSERT_EQUALS(bs.pos(), bitCount);
+
+		// Decoding several symbols at once gives the same result
+		bs.rewind();
+		uint32 symbols[count];
+		h.getSymbols(bs, symbols, count);
+		TS_ASSERT_EQUALS(memcmp(symbols, expected, sizeof(symbols)), 0);
+		TS_ASSERT_EQUALS(bs.pos(), bitCount);
+	}
+
 	public:
 	void test_get_with_full_symbols() {
 
@@ -94,4 +161,11 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[5]);
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[6]);
 	}
+
+	void test_long_codes() {
+		checkLongCodes<Common::BitStream8MSB>(true, 9);
+		checkLongCodes<Common::BitStream8MSB>(true, 4);
+		checkLongCodes<Common::BitStream32LELSB>(false, 9);
+		checkLongCodes<Common::BitStream32LELSB>(false, 3);
+	}
 };
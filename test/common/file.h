@@ -0,0 +1,66 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+
+#include "../null_osystem.h"
+
+#ifdef HAS_MMAP
+#include "backends/fs/posix/posix-iostream.h"
+#endif
+
+class FileTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_mapped_file() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(HAS_MMAP)
+		Common::install_null_g_system();
+
+		// The tests run from the build directory, where the test runner
+		// is large enough to be mapped and config.h is not
+		Common::FSNode large("test/runner");
+		Common::FSNode small("config.h");
+		if (!large.exists() || !small.exists())
+			return;
+
+		Common::File smallFile;
+		TS_ASSERT(smallFile.openMapped(small));
+		TS_ASSERT(!smallFile.getData());
+
+		// Files are only mapped on request
+		Common::File plainFile;
+		TS_ASSERT(plainFile.open(large));
+		TS_ASSERT(!plainFile.getData());
+
+		Common::File file;
+		TS_ASSERT(file.openMapped(large));
+		const byte *data = file.getData();
+		TS_ASSERT(data);
+		if (!data)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> plain(PosixIoStream::makeFromPath(large.getPath().toString(Common::Path::kNativeSeparator), StdioStream::WriteMode_Read));
+		TS_ASSERT(plain);
+		TS_ASSERT_EQUALS(file.size(), plain->size());
+
+		byte buffer[4096];
+		const uint32 size = plain->size();
+		for (uint32 pos = 0; pos < size; pos += sizeof(buffer)) {
+			const uint32 count = plain->read(buffer, sizeof(buffer));
+			if (memcmp(buffer, data + pos, count)) {
+				TS_FAIL("Mapped data differs from the file contents");
+				break;
+			}
+		}
+
+		// Reading through the stream interface still works
+		TS_ASSERT(file.seek(size / 2));
+		TS_ASSERT_EQUALS(file.read(buffer, 16), 16U);
+		TS_ASSERT_EQUALS(memcmp(buffer, data + size / 2, 16), 0);
+		TS_ASSERT(file.seek(-4, SEEK_END));
+		TS_ASSERT_EQUALS(file.read(buffer, 16), 4U);
+		TS_ASSERT(file.eos());
+#endif
+	}
+};
@@ -104,4 +104,18 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_get_data() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(ms.getData(), contents);
+
+		// The data always starts at the beginning of the block
+		ms.readByte();
+		TS_ASSERT_EQUALS(ms.getData(), contents);
+		ms.seek(4, SEEK_SET);
+		TS_ASSERT_EQUALS(ms.getData(), contents);
+		ms.seek(-2, SEEK_END);
+		TS_ASSERT_EQUALS(ms.getData()[ms.pos()], 6);
+	}
 };
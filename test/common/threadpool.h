@@ -0,0 +1,109 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/threadpool.h"
+
+#include "../null_osystem.h"
+
+class ThreadPoolTestSuite : public CxxTest::TestSuite
+{
+private:
+	static int square(int value) {
+		return value * value;
+	}
+
+	void checkPool(Common::ThreadPool &pool) {
+		Common::Array<Common::Future<int> > futures;
+		for (int i = 0; i < 64; i++)
+			futures.push_back(pool.submit([i]() { return square(i); }));
+
+		for (int i = 0; i < 64; i++) {
+			TS_ASSERT(futures[i].isValid());
+			TS_ASSERT_EQUALS(futures[i].get(), i * i);
+			TS_ASSERT(futures[i].isReady());
+		}
+
+		// Every index is visited exactly once
+		Common::Array<int> visits;
+		visits.resize(1000);
+		for (uint i = 0; i < visits.size(); i++)
+			visits[i] = 0;
+		pool.parallelFor(visits.size(), [&visits](uint i) { visits[i]++; });
+		for (uint i = 0; i < visits.size(); i++)
+			TS_ASSERT_EQUALS(visits[i], 1);
+
+		pool.parallelFor(0, [](uint) { TS_FAIL("Called for an empty range"); });
+
+		// Nested loops run serially
+		int sums[8];
+		pool.parallelFor(8, [&pool, &sums](uint i) {
+			int sum = 0;
+			pool.parallelFor(100, [&sum](uint j) { sum += j; });
+			sums[i] = sum;
+		});
+		for (int i = 0; i < 8; i++)
+			TS_ASSERT_EQUALS(sums[i], 4950);
+	}
+
+public:
+	void test_no_threads() {
+		Common::ThreadPool pool(0);
+		TS_ASSERT_EQUALS(pool.getNumThreads(), 0U);
+
+		// Without worker threads, jobs run as soon as they are submitted
+		int value = 0;
+		Common::Future<void> future = pool.submit([&value]() { value = 42; });
+		TS_ASSERT_EQUALS(value, 42);
+		TS_ASSERT(future.isReady());
+
+		checkPool(pool);
+	}
+
+	void test_worker_threads() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::ThreadPool pool(4);
+		checkPool(pool);
+#endif
+	}
+
+	void test_future_copies() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::Future<int> copy;
+		TS_ASSERT(!copy.isValid());
+		{
+			Common::ThreadPool pool(2);
+			Common::Future<int> future = pool.submit([]() { return 7; });
+			copy = future;
+			Common::Future<int> other(future);
+			other.wait();
+			TS_ASSERT_EQUALS(copy.get(), 7);
+			TS_ASSERT_EQUALS(other.get(), 7);
+			copy = Common::Future<int>();
+		}
+		TS_ASSERT(!copy.isValid());
+#endif
+	}
+
+	void test_destructor_runs_queued_jobs() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		int done[32];
+		for (int i = 0; i < 32; i++)
+			done[i] = 0;
+
+		{
+			Common::ThreadPool pool(2);
+			for (int i = 0; i < 32; i++)
+				pool.submit([&done, i]() { done[i] = 1; });
+		}
+
+		for (int i = 0; i < 32; i++)
+			TS_ASSERT_EQUALS(done[i], 1);
+#endif
+	}
+};
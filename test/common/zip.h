@@ -0,0 +1,181 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/compression/deflate.h"
+#include "common/compression/unzip.h"
+
+#include "../null_osystem.h"
+
+class ZipTestSuite : public CxxTest::TestSuite
+{
+private:
+	struct ZipFile {
+		Common::String name;
+		const byte *data;
+		uint32 size;
+		bool compress;
+		bool badCRC;
+	};
+
+	/** Build a zip archive in memory, holding the given files. */
+	static Common::SeekableReadStream *createZip(const ZipFile *files, int numFiles) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		Common::MemoryWriteStreamDynamic centralDir(DisposeAfterUse::YES);
+
+		for (int i = 0; i < numFiles; i++) {
+			const ZipFile &file = files[i];
+			const uint32 crc = Common::CRC32().crcFast(file.data, file.size) ^ (file.badCRC ? 1 : 0);
+
+			// Raw deflate data is what is left of a gzip stream without
+			// its 10 bytes of header and 8 bytes of trailer
+			Common::MemoryWriteStreamDynamic *compressed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+			Common::ScopedPtr<Common::WriteStream> gzip(Common::wrapCompressedWriteStream(compressed));
+			const byte *data = file.data;
+			uint32 size = file.size;
+			if (file.compress) {
+				gzip->write(file.data, file.size);
+				gzip->finalize();
+				data = compressed->getData() + 10;
+				size = compressed->size() - 18;
+			}
+
+			const uint32 offset = zip.pos();
+			zip.writeUint32LE(0x04034b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(file.compress ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(crc);
+			zip.writeUint32LE(size);
+			zip.writeUint32LE(file.size);
+			zip.writeUint16LE(file.name.size());
+			zip.writeUint16LE(0);
+			zip.writeString(file.name);
+			zip.write(data, size);
+
+			centralDir.writeUint32LE(0x02014b50);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(file.compress ? 8 : 0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(crc);
+			centralDir.writeUint32LE(size);
+			centralDir.writeUint32LE(file.size);
+			centralDir.writeUint16LE(file.name.size());
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(offset);
+			centralDir.writeString(file.name);
+		}
+
+		const uint32 centralDirOffset = zip.pos();
+		zip.write(centralDir.getData(), centralDir.size());
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint32LE(0);
+		zip.writeUint16LE(numFiles);
+		zip.writeUint16LE(numFiles);
+		zip.writeUint32LE(centralDir.size());
+		zip.writeUint32LE(centralDirOffset);
+		zip.writeUint16LE(0);
+
+		return new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES);
+	}
+
+	/** Fill the buffer with data that compresses into many deflate blocks. */
+	static void fillData(byte *data, uint32 size) {
+		uint32 seed = 1;
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = 'a' + ((seed >> 16) & 15);
+		}
+	}
+
+	static bool checkRead(Common::SeekableReadStream &stream, const byte *data, uint32 pos, uint32 size) {
+		byte buffer[4096];
+		assert(size <= sizeof(buffer));
+
+		if (!stream.seek(pos) || stream.pos() != pos)
+			return false;
+		if (stream.read(buffer, size) != size)
+			return false;
+		return memcmp(buffer, data + pos, size) == 0;
+	}
+
+public:
+	void test_streamed_members() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_ZLIB)
+		Common::install_null_g_system();
+
+		const uint32 largeSize = 3 * 1024 * 1024 + 123;
+		byte *large = new byte[largeSize];
+		fillData(large, largeSize);
+		const byte small[] = "A file small enough to be cached";
+
+		const ZipFile files[] = {
+			{ "large.bin", large, largeSize, true, false },
+			{ "stored.bin", large, largeSize, false, false },
+			{ "small.txt", small, sizeof(small), true, false },
+			{ "corrupt.bin", large, largeSize, true, true }
+		};
+
+		Common::Archive *archive = Common::makeZipArchive(createZip(files, ARRAYSIZE(files)));
+		TS_ASSERT(archive);
+		if (!archive) {
+			delete[] large;
+			return;
+		}
+
+		Common::ScopedPtr<Common::SeekableReadStream> smallStream(archive->createReadStreamForMember("small.txt"));
+		TS_ASSERT(smallStream);
+		TS_ASSERT_EQUALS(smallStream->size(), (int64)sizeof(small));
+		TS_ASSERT(checkRead(*smallStream, small, 0, sizeof(small)));
+
+		Common::ScopedPtr<Common::SeekableReadStream> largeStream(archive->createReadStreamForMember("large.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> storedStream(archive->createReadStreamForMember("stored.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> corruptStream(archive->createReadStreamForMember("corrupt.bin"));
+		TS_ASSERT(largeStream);
+		TS_ASSERT(storedStream);
+		TS_ASSERT(corruptStream);
+
+		// The streams have to stay usable after the archive is gone
+		delete archive;
+
+		TS_ASSERT_EQUALS(largeStream->size(), (int64)largeSize);
+		TS_ASSERT_EQUALS(storedStream->size(), (int64)largeSize);
+
+		// Read through the whole file, then jump around in it, which
+		// goes through the restart points set up by the first pass
+		TS_ASSERT(checkRead(*largeStream, large, largeSize - 100, 100));
+
+		uint32 seed = 7;
+		for (int i = 0; i < 50; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = seed % (largeSize - 4096);
+			TS_ASSERT(checkRead(*largeStream, large, pos, 4096));
+			TS_ASSERT(checkRead(*storedStream, large, pos, 4096));
+		}
+
+		TS_ASSERT(checkRead(*largeStream, large, 0, 4096));
+		TS_ASSERT(!largeStream->err());
+
+		// The CRC is checked once a file has been read to its end
+		byte *buffer = new byte[largeSize];
+		TS_ASSERT(storedStream->seek(0));
+		TS_ASSERT_EQUALS(storedStream->read(buffer, largeSize), largeSize);
+		TS_ASSERT(!storedStream->err());
+
+		TS_ASSERT_EQUALS(corruptStream->read(buffer, largeSize / 2), largeSize / 2);
+		TS_ASSERT(!corruptStream->err());
+		TS_ASSERT_EQUALS(corruptStream->read(buffer, largeSize), largeSize - largeSize / 2);
+		TS_ASSERT(corruptStream->err());
+		delete[] buffer;
+
+		delete[] large;
+#endif
+	}
+};
@@ -0,0 +1,278 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/str.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+#include "image/codecs/msvideo1.h"
+#include "image/codecs/qtrle.h"
+#include "image/codecs/rpza.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class ImageCodecsTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	uint32 nextRandom(uint32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 8) % max;
+	}
+
+	uint16 nextColor() {
+		return nextRandom(0x8000);
+	}
+
+	/** The output formats the decoders are tested with, other than their own. */
+	static Graphics::PixelFormat getTestFormat(int i) {
+		switch (i) {
+		case 0:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		case 1:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		default:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+		}
+	}
+
+	/**
+	 * Build an RPZA frame using all the block types. Key frames have no
+	 * skipped blocks.
+	 */
+	Common::SeekableReadStream *createRPZAFrame(int width, int height, bool keyFrame) {
+		Common::MemoryWriteStreamDynamic frame(DisposeAfterUse::NO);
+		frame.writeUint32BE(0);
+
+		int blocksLeft = (width / 4) * (height / 4);
+		while (blocksLeft > 0) {
+			const int numBlocks = MIN<int>(blocksLeft, 1 + nextRandom(32));
+
+			switch (nextRandom(4)) {
+			case 0:
+				if (keyFrame)
+					continue;
+				frame.writeByte(0x80 | (numBlocks - 1));
+				blocksLeft -= numBlocks;
+				break;
+			case 1:
+				frame.writeByte(0xA0 | (numBlocks - 1));
+				frame.writeUint16BE(nextColor());
+				blocksLeft -= numBlocks;
+				break;
+			case 2:
+				frame.writeByte(0xC0 | (numBlocks - 1));
+				frame.writeUint16BE(nextColor());
+				frame.writeUint16BE(nextColor());
+				for (int i = 0; i < numBlocks * 4; i++)
+					frame.writeByte(nextRandom(256));
+				blocksLeft -= numBlocks;
+				break;
+			default:
+				for (int i = 0; i < 16; i++)
+					frame.writeUint16BE(nextColor());
+				blocksLeft--;
+				break;
+			}
+		}
+
+		byte *data = frame.getData();
+		WRITE_BE_UINT32(data, 0xE1000000 | frame.size());
+		return new Common::MemoryReadStream(data, frame.size(), DisposeAfterUse::YES);
+	}
+
+	/** Build a 16-bit Microsoft Video 1 frame using all the block types. */
+	Common::SeekableReadStream *createMSVideo1Frame(int width, int height, bool keyFrame) {
+		Common::MemoryWriteStreamDynamic frame(DisposeAfterUse::NO);
+
+		int blocksLeft = (width / 4) * (height / 4);
+		while (blocksLeft > 0) {
+			switch (nextRandom(4)) {
+			case 0: {
+				if (keyFrame)
+					continue;
+				const int numBlocks = MIN<int>(blocksLeft, 1 + nextRandom(16));
+				frame.writeByte(numBlocks);
+				frame.writeByte(0x84);
+				blocksLeft -= numBlocks;
+				break;
+			}
+			case 1:
+				frame.writeUint16LE(nextColor() | 0x8800);
+				blocksLeft--;
+				break;
+			case 2:
+				frame.writeUint16LE(nextRandom(0x8000));
+				frame.writeUint16LE(nextColor());
+				frame.writeUint16LE(nextColor());
+				blocksLeft--;
+				break;
+			default:
+				frame.writeUint16LE(nextRandom(0x8000));
+				frame.writeUint16LE(nextColor() | 0x8000);
+				for (int i = 0; i < 7; i++)
+					frame.writeUint16LE(nextColor());
+				blocksLeft--;
+				break;
+			}
+		}
+
+		frame.writeUint16LE(0);
+		return new Common::MemoryReadStream(frame.getData(), frame.size(), DisposeAfterUse::YES);
+	}
+
+	/** Build a QuickTime RLE frame of runs and literal pixels. */
+	Common::SeekableReadStream *createQTRLEFrame(int width, int height, int bitsPerPixel) {
+		Common::MemoryWriteStreamDynamic frame(DisposeAfterUse::NO);
+		frame.writeUint32BE(0);
+		frame.writeUint16BE(0);
+
+		const int bytesPerPixel = bitsPerPixel / 8;
+		for (int y = 0; y < height; y++) {
+			frame.writeByte(1);
+
+			int x = 0;
+			while (x < width) {
+				const int count = MIN<int>(width - x, 1 + nextRandom(20));
+				// A run of one pixel would be taken for the end of the line
+				const bool run = count > 1 && nextRandom(2);
+				frame.writeSByte(run ? -count : count);
+				for (int i = 0; i < (run ? 1 : count) * bytesPerPixel; i++)
+					frame.writeByte(nextRandom(256));
+				x += count;
+			}
+
+			frame.writeSByte(-1);
+		}
+
+		byte *data = frame.getData();
+		WRITE_BE_UINT32(data, frame.size());
+		return new Common::MemoryReadStream(data, frame.size(), DisposeAfterUse::YES);
+	}
+
+	Common::SeekableReadStream *createFrame(int codec, int width, int height, bool keyFrame) {
+		switch (codec) {
+		case 0:
+			return createRPZAFrame(width, height, keyFrame);
+		case 1:
+			return createMSVideo1Frame(width, height, keyFrame);
+		default:
+			return createQTRLEFrame(width, height, 8 * codec);
+		}
+	}
+
+	static Image::Codec *createCodec(int codec, int width, int height) {
+		switch (codec) {
+		case 0:
+			return new Image::RPZADecoder(width, height);
+		case 1:
+			return new Image::MSVideo1Decoder(width, height, 16);
+		default:
+			return new Image::QTRLEDecoder(width, height, 8 * codec);
+		}
+	}
+
+	static bool compareSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h || a.format != b.format)
+			return false;
+
+		for (int y = 0; y < a.h; y++)
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+
+		return true;
+	}
+
+public:
+	void test_direct_output_format() {
+		const int width = 64, height = 48;
+		static const int numCodecs = 5;
+
+		for (int codec = 0; codec < numCodecs; codec++) {
+			for (int format = 0; format < 3; format++) {
+				const Graphics::PixelFormat dstFormat = getTestFormat(format);
+				Common::ScopedPtr<Image::Codec> native(createCodec(codec, width, height));
+				Common::ScopedPtr<Image::Codec> direct(createCodec(codec, width, height));
+				TS_ASSERT(direct->setOutputPixelFormat(dstFormat));
+				TS_ASSERT_EQUALS(direct->getPixelFormat(), dstFormat);
+
+				// Decode several frames, so that skipped blocks keep the
+				// contents of the previous frame
+				_seed = codec * 3 + format + 1;
+				for (int frame = 0; frame < 4; frame++) {
+					Common::ScopedPtr<Common::SeekableReadStream> stream(createFrame(codec, width, height, frame == 0));
+
+					const Graphics::Surface *nativeSurface = native->decodeFrame(*stream);
+					stream->seek(0);
+					const Graphics::Surface *directSurface = direct->decodeFrame(*stream);
+					TS_ASSERT(nativeSurface && directSurface);
+					if (!nativeSurface || !directSurface)
+						return;
+
+					Graphics::Surface *converted = nativeSurface->convertTo(dstFormat);
+					TS_ASSERT(compareSurfaces(*converted, *directSurface));
+					converted->free();
+					delete converted;
+				}
+			}
+		}
+	}
+
+	void test_rejected_output_formats() {
+		Image::MSVideo1Decoder msvideo8(64, 48, 8);
+		TS_ASSERT(!msvideo8.setOutputPixelFormat(getTestFormat(0)));
+
+		Image::QTRLEDecoder qtrle8(64, 48, 8);
+		TS_ASSERT(!qtrle8.setOutputPixelFormat(getTestFormat(1)));
+
+		Image::RPZADecoder rpza(64, 48);
+		TS_ASSERT(!rpza.setOutputPixelFormat(Graphics::PixelFormat::createFormatCLUT8()));
+	}
+
+	void test_direct_output_speed() {
+#if BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		const int numFrames = 500;
+
+		const int width = 640, height = 480;
+		const Graphics::PixelFormat dstFormat = getTestFormat(1);
+
+		_seed = 1;
+		Common::ScopedPtr<Common::SeekableReadStream> stream(createRPZAFrame(width, height, true));
+
+		// The old path: decode to RGB555, then convert the whole frame
+		Image::RPZADecoder native(width, height);
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < numFrames; i++) {
+			stream->seek(0);
+			Graphics::Surface *converted = native.decodeFrame(*stream)->convertTo(dstFormat);
+			converted->free();
+			delete converted;
+		}
+		const uint32 convertTime = g_system->getMillis() - start;
+
+		Image::RPZADecoder direct(width, height);
+		direct.setOutputPixelFormat(dstFormat);
+		start = g_system->getMillis();
+		for (int i = 0; i < numFrames; i++) {
+			stream->seek(0);
+			direct.decodeFrame(*stream);
+		}
+		const uint32 directTime = g_system->getMillis() - start;
+
+		TS_TRACE(Common::String::format("RPZA to RGBA8888, %d frames of %dx%d: decode and convert %d ms, direct %d ms", numFrames, width, height, convertTime, directTime).c_str());
+#endif
+	}
+};
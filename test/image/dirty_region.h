@@ -0,0 +1,131 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int nextRandom(int max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	static int countRects(const Common::List<Common::Rect> &rects) {
+		int count = 0;
+		for (Common::List<Common::Rect>::const_iterator it = rects.begin(); it != rects.end(); ++it)
+			count++;
+		return count;
+	}
+
+public:
+	void test_single_rect() {
+		Graphics::DirtyRegion region;
+		region.setBounds(Common::Rect(320, 200));
+		TS_ASSERT(region.isEmpty());
+
+		// A lone rect is returned as it is, not rounded out to tiles
+		region.addRect(Common::Rect(13, 7, 59, 101));
+		Common::List<Common::Rect> rects;
+		region.getRects(rects);
+		TS_ASSERT_EQUALS(countRects(rects), 1);
+		TS_ASSERT_EQUALS(rects.front(), Common::Rect(13, 7, 59, 101));
+
+		region.clear();
+		TS_ASSERT(region.isEmpty());
+		rects.clear();
+		region.getRects(rects);
+		TS_ASSERT(rects.empty());
+	}
+
+	void test_clipping() {
+		Graphics::DirtyRegion region;
+		region.setBounds(Common::Rect(10, 20, 330, 220));
+
+		region.addRect(Common::Rect(-50, -50, 5, 5));
+		TS_ASSERT(region.isEmpty());
+
+		region.addRect(Common::Rect(300, 0, 400, 30));
+		Common::List<Common::Rect> rects;
+		region.getRects(rects);
+		TS_ASSERT_EQUALS(countRects(rects), 1);
+		TS_ASSERT_EQUALS(rects.front(), Common::Rect(300, 20, 330, 30));
+
+		rects.clear();
+		region.addAll();
+		region.getRects(rects);
+		TS_ASSERT_EQUALS(countRects(rects), 1);
+		TS_ASSERT_EQUALS(rects.front(), Common::Rect(10, 20, 330, 220));
+	}
+
+	void test_coalescing() {
+		Graphics::DirtyRegion region;
+		region.setBounds(Common::Rect(640, 480));
+
+		// A block of touching sprites turns into a single rect
+		for (int y = 0; y < 10; y++)
+			for (int x = 0; x < 10; x++)
+				region.addRect(Common::Rect(100 + x * 16, 50 + y * 16, 116 + x * 16, 66 + y * 16));
+
+		Common::List<Common::Rect> rects;
+		region.getRects(rects);
+		TS_ASSERT_EQUALS(countRects(rects), 1);
+		TS_ASSERT_EQUALS(rects.front(), Common::Rect(100, 50, 260, 210));
+
+		// Two separate areas stay apart
+		region.clear();
+		region.addRect(Common::Rect(0, 0, 20, 20));
+		region.addRect(Common::Rect(300, 300, 320, 320));
+		rects.clear();
+		region.getRects(rects);
+		TS_ASSERT_EQUALS(countRects(rects), 2);
+	}
+
+	void test_coverage() {
+		const int width = 200, height = 150;
+		byte marked[height][width];
+		byte covered[height][width];
+
+		_seed = 1;
+		Graphics::DirtyRegion region(3);
+		region.setBounds(Common::Rect(width, height));
+
+		for (int round = 0; round < 100; round++) {
+			memset(marked, 0, sizeof(marked));
+			memset(covered, 0, sizeof(covered));
+			region.clear();
+
+			const int numRects = 1 + nextRandom(30);
+			for (int i = 0; i < numRects; i++) {
+				const int x = nextRandom(width + 40) - 20, y = nextRandom(height + 40) - 20;
+				const Common::Rect r(x, y, x + 1 + nextRandom(60), y + 1 + nextRandom(60));
+				region.addRect(r);
+
+				Common::Rect clipped = r;
+				clipped.clip(Common::Rect(width, height));
+				for (int py = clipped.top; py < clipped.bottom; py++)
+					for (int px = clipped.left; px < clipped.right; px++)
+						marked[py][px] = 1;
+			}
+
+			Common::List<Common::Rect> rects;
+			region.getRects(rects);
+			for (Common::List<Common::Rect>::const_iterator it = rects.begin(); it != rects.end(); ++it) {
+				TS_ASSERT(Common::Rect(width, height).contains(*it));
+				for (int py = it->top; py < it->bottom; py++)
+					for (int px = it->left; px < it->right; px++)
+						covered[py][px]++;
+			}
+
+			// Every marked pixel is covered exactly once
+			for (int py = 0; py < height; py++) {
+				for (int px = 0; px < width; px++) {
+					TS_ASSERT(covered[py][px] <= 1);
+					if (marked[py][px])
+						TS_ASSERT_EQUALS(covered[py][px], 1);
+				}
+			}
+		}
+	}
+};
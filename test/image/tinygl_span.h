@@ -0,0 +1,326 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/str.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
+#endif
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class TinyGLSpanTestSuite : public CxxTest::TestSuite {
+#ifdef USE_TINYGL
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void compareKernels(TinyGL::SpanFill::FillFunc kernel) {
+		uint32 pixelsRef[64], pixels[64];
+		uint zbufRef[64], zbuf[64];
+
+		for (int round = 0; round < 200; round++) {
+			TinyGL::SpanState state;
+			// Real depth values stay far from the sign bit
+			state.z = (nextRandom() & 0x1FFFFFFF) + 0x10000000;
+			state.dzdx = (nextRandom() & 0xFFFF) - 0x8000;
+			state.r = nextRandom() & 0xFFFF;
+			state.g = nextRandom() & 0xFFFF;
+			state.b = nextRandom() & 0xFFFF;
+			state.a = nextRandom() & 0xFFFF;
+			state.drdx = (nextRandom() & 0xFF) - 0x80;
+			state.dgdx = (nextRandom() & 0xFF) - 0x80;
+			state.dbdx = (nextRandom() & 0xFF) - 0x80;
+			state.dadx = (nextRandom() & 0xFF) - 0x80;
+			state.depthMode = (TinyGL::SpanState::DepthMode)(round % 3);
+			state.depthWrite = (round & 4) != 0;
+
+			// Alternate between RGBA8888 and RGB565 like component layouts
+			const bool rgb565 = (round & 8) != 0;
+			state.rLoss = rgb565 ? 3 : 0;
+			state.gLoss = rgb565 ? 2 : 0;
+			state.bLoss = rgb565 ? 3 : 0;
+			state.aLoss = rgb565 ? 8 : 0;
+			state.rShift = rgb565 ? 11 : 24;
+			state.gShift = rgb565 ? 5 : 16;
+			state.bShift = rgb565 ? 0 : 8;
+			state.aShift = 0;
+
+			for (int i = 0; i < 64; i++) {
+				pixelsRef[i] = pixels[i] = nextRandom();
+				// Keep some depth values equal to the span's
+				zbufRef[i] = zbuf[i] = (i % 5 == 0) ? state.z + i * state.dzdx : nextRandom() & 0x3FFFFFFF;
+			}
+
+			const int count = round % 61;
+			TinyGL::SpanFill::fillGeneric(pixelsRef, zbufRef, count, state);
+			kernel(pixels, zbuf, count, state);
+			TS_ASSERT_EQUALS(memcmp(pixelsRef, pixels, sizeof(pixels)), 0);
+			TS_ASSERT_EQUALS(memcmp(zbufRef, zbuf, sizeof(zbuf)), 0);
+		}
+	}
+
+	/** Render a scene of overlapping depth tested, Gouraud shaded triangles. */
+	void renderScene(int numTriangles) {
+		uint32 seed = 1;
+
+		tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		tglClearDepth(1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglEnable(TGL_DEPTH_TEST);
+		tglDepthFunc(TGL_LESS);
+		tglShadeModel(TGL_SMOOTH);
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+
+		tglBegin(TGL_TRIANGLES);
+		for (int i = 0; i < numTriangles * 3; i++) {
+			seed = seed * 1103515245 + 12345;
+			const float x = ((seed >> 8) & 0xFFF) / 2048.0f - 1.0f;
+			seed = seed * 1103515245 + 12345;
+			const float y = ((seed >> 8) & 0xFFF) / 2048.0f - 1.0f;
+			seed = seed * 1103515245 + 12345;
+			const float z = ((seed >> 8) & 0xFFF) / 2048.0f - 1.0f;
+			tglColor3f((i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f);
+			tglVertex3f(x, y, z);
+		}
+		tglEnd();
+	}
+
+	/**
+	 * Render the scene into a framebuffer of the given format, optionally
+	 * clipped like the draw calls of dirty areas are, or drawn in tiles.
+	 */
+	uint32 renderFrames(const Graphics::PixelFormat &format, int numFrames, Graphics::Surface *result, const Common::Rect *scissor = nullptr, bool tiled = false) {
+		TinyGL::ContextHandle *context = TinyGL::createContext(640, 480, format, 256, false, false);
+		if (scissor)
+			TinyGL::gl_get_context()->fb->setScissorRectangle(*scissor);
+		TinyGL::enableTiledRendering(tiled);
+
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < numFrames; i++) {
+			renderScene(300);
+			TinyGL::presentBuffer();
+		}
+		const uint32 time = g_system->getMillis() - start;
+
+		if (result) {
+			Graphics::Surface surface;
+			TinyGL::getSurfaceRef(surface);
+			result->copyFrom(surface);
+		}
+
+		TinyGL::destroyContext(context);
+		return time;
+	}
+
+	/**
+	 * Render a few frames of triangles, quads and blits, with the framebuffer
+	 * drawn as a whole or in tiles on worker threads.
+	 */
+	void renderTiledFrames(bool tiled, bool dirtyRects, Graphics::Surface *result) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		TinyGL::ContextHandle *context = TinyGL::createContext(640, 480, format, 256, false, dirtyRects);
+		// More threads than cores still draw the tiles concurrently
+		TinyGL::enableTiledRendering(tiled, 3);
+		TS_ASSERT_EQUALS(TinyGL::gl_get_context()->_tileContexts.empty(), !tiled);
+
+		Graphics::Surface image;
+		image.create(96, 72, format);
+		for (int y = 0; y < image.h; y++) {
+			for (int x = 0; x < image.w; x++)
+				image.setPixel(x, y, format.ARGBToColor((x + y) % 3 ? 255 : 96, x * 2, y * 3, 200));
+		}
+		TinyGL::BlitImage *blitImage = tglGenBlitImage();
+		tglUploadBlitImage(blitImage, image, 0, false);
+		image.free();
+
+		for (int frame = 0; frame < 3; frame++) {
+			renderScene(100 + frame * 50);
+
+			tglEnable(TGL_BLEND);
+			tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+			tglBlit(blitImage, 100 + frame * 10, 90);
+			// Rotated blits are drawn on the whole framebuffer
+			TinyGL::BlitTransform transform(300, 200 + frame);
+			transform.rotate(30, 48, 36);
+			tglBlit(blitImage, transform);
+			tglDisable(TGL_BLEND);
+
+			tglBegin(TGL_QUADS);
+			for (int i = 0; i < 8; i++) {
+				const float x = i / 4.0f - 1.0f, y = (i % 3) / 3.0f - 0.5f + frame / 20.0f;
+				tglColor3f(i / 8.0f, 1.0f - i / 8.0f, 0.5f);
+				tglVertex3f(x, y, -0.5f);
+				tglVertex3f(x + 0.2f, y, -0.5f);
+				tglVertex3f(x + 0.2f, y + 0.4f, 0.5f);
+				tglVertex3f(x, y + 0.4f, 0.5f);
+			}
+			tglEnd();
+
+			TinyGL::presentBuffer();
+		}
+
+		Graphics::Surface surface;
+		TinyGL::getSurfaceRef(surface);
+		result->copyFrom(surface);
+
+		tglDeleteBlitImage(blitImage);
+		TinyGL::destroyContext(context);
+	}
+#endif
+
+public:
+	void test_span_kernels() {
+#ifdef USE_TINYGL
+		_seed = 1;
+
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			compareKernels(TinyGL::SpanFill::fillSSE2);
+#endif
+
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			compareKernels(TinyGL::SpanFill::fillAVX2);
+#endif
+
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		// NEON is always available on aarch64
+		compareKernels(TinyGL::SpanFill::fillNEON);
+#endif
+#endif
+	}
+
+	void test_span_rendering() {
+#if defined(USE_TINYGL) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// Spans are only filled by SpanFill in 32bpp framebuffers, 24bpp
+		// ones still go through the scalar templates
+		Graphics::Surface spans, scalar;
+		renderFrames(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 1, &spans);
+		renderFrames(Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0), 1, &scalar);
+
+		int differences = 0, background = 0;
+		for (int y = 0; y < spans.h; y++) {
+			for (int x = 0; x < spans.w; x++) {
+				byte r1, g1, b1, r2, g2, b2;
+				spans.format.colorToRGB(spans.getPixel(x, y), r1, g1, b1);
+				scalar.format.colorToRGB(scalar.getPixel(x, y), r2, g2, b2);
+				if (r1 != r2 || g1 != g2 || b1 != b2)
+					differences++;
+				if (!r1 && !g1 && !b1)
+					background++;
+			}
+		}
+
+		TS_ASSERT_EQUALS(differences, 0);
+		TS_ASSERT_LESS_THAN(background, spans.w * spans.h / 2);
+
+		spans.free();
+		scalar.free();
+#endif
+	}
+
+	void test_span_rendering_scissor() {
+#if defined(USE_TINYGL) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const Common::Rect scissor(101, 77, 457, 333);
+		Graphics::Surface spans, scalar;
+		renderFrames(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 1, &spans, &scissor);
+		renderFrames(Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0), 1, &scalar, &scissor);
+
+		int differences = 0, outside = 0, inside = 0;
+		for (int y = 0; y < spans.h; y++) {
+			for (int x = 0; x < spans.w; x++) {
+				byte r1, g1, b1, r2, g2, b2;
+				spans.format.colorToRGB(spans.getPixel(x, y), r1, g1, b1);
+				scalar.format.colorToRGB(scalar.getPixel(x, y), r2, g2, b2);
+				if (r1 != r2 || g1 != g2 || b1 != b2)
+					differences++;
+				if (r1 || g1 || b1) {
+					if (scissor.contains(x, y))
+						inside++;
+					else
+						outside++;
+				}
+			}
+		}
+
+		// Spans cut by the scissor rectangle continue with the colors and
+		// depths the scalar templates have at the same pixels
+		TS_ASSERT_EQUALS(differences, 0);
+		TS_ASSERT_EQUALS(outside, 0);
+		TS_ASSERT_LESS_THAN(scissor.width() * scissor.height() / 2, inside);
+
+		spans.free();
+		scalar.free();
+#endif
+	}
+
+	void test_tiled_rendering() {
+#if defined(USE_TINYGL) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			Graphics::Surface whole, tiles;
+			renderTiledFrames(false, dirtyRects, &whole);
+			renderTiledFrames(true, dirtyRects, &tiles);
+
+			TS_ASSERT_EQUALS(memcmp(whole.getPixels(), tiles.getPixels(), whole.pitch * whole.h), 0);
+
+			whole.free();
+			tiles.free();
+		}
+#endif
+	}
+
+	void test_span_speed() {
+#if defined(USE_TINYGL) && BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		const int numFrames = 100;
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		TinyGL::SpanFill::fillFunc = TinyGL::SpanFill::fillGeneric;
+		const uint32 genericTime = renderFrames(format, numFrames, nullptr);
+
+		// Let SpanFill pick the best kernel for this CPU
+		TinyGL::SpanFill::fillFunc = nullptr;
+		const uint32 simdTime = renderFrames(format, numFrames, nullptr);
+		const uint32 tiledTime = renderFrames(format, numFrames, nullptr, nullptr, true);
+
+		// The scalar templates are only used for other framebuffer formats
+		const uint32 scalarTime = renderFrames(Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0), numFrames, nullptr);
+
+		TS_TRACE(Common::String::format("TinyGL span filling, %d frames: scalar templates %d ms, generic spans %d ms, SIMD spans %d ms, SIMD spans in tiles on %d cores %d ms",
+		                                numFrames, scalarTime, genericTime, simdTime, g_system->getCpuCount(), tiledTime).c_str());
+#endif
+	}
+};
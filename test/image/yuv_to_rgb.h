@@ -0,0 +1,179 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/str.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_row.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum Subsampling {
+		k444,
+		k422,
+		k420
+	};
+
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void fillPlane(byte *plane, int size) {
+		for (int i = 0; i < size; i++) {
+			// Include the extremes, which have to be clipped
+			const byte value = nextRandom();
+			plane[i] = (value < 16) ? 0 : (value > 240) ? 255 : value;
+		}
+	}
+
+	static void convert(Graphics::Surface &dst, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale, const byte *y, const byte *u, const byte *v, int width, int height, int yPitch, int uvPitch) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, y, u, v, width, height, yPitch, uvPitch);
+			break;
+		case k422:
+			YUVToRGBMan.convert422(&dst, scale, y, u, v, width, height, yPitch, uvPitch);
+			break;
+		default:
+			YUVToRGBMan.convert420(&dst, scale, y, u, v, width, height, yPitch, uvPitch);
+			break;
+		}
+	}
+
+	/** Compare a kernel to the per pixel lookup path. */
+	void compareKernel(Graphics::YUVToRGBRow::ConvertFunc kernel) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+
+		// Widths with and without a partial block at the end of each row
+		static const int widths[] = { 2, 38, 64, 70, 522 };
+
+		byte y[600 * 8], u[600 * 8], v[600 * 8];
+		fillPlane(y, sizeof(y));
+		fillPlane(u, sizeof(u));
+		fillPlane(v, sizeof(v));
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			for (int w = 0; w < ARRAYSIZE(widths); w++) {
+				for (int s = 0; s < 3; s++) {
+					for (int scale = 0; scale < 2; scale++) {
+						const int width = widths[w], height = 6;
+						Graphics::Surface ref, result;
+						ref.create(width, height, formats[f]);
+						result.create(width, height, formats[f]);
+
+						Graphics::YUVToRGBRow::convertFunc = Graphics::YUVToRGBRow::convertGeneric;
+						convert(ref, (Subsampling)s, (Graphics::YUVToRGBManager::LuminanceScale)scale, y, u, v, width, height, 600, 300);
+						Graphics::YUVToRGBRow::convertFunc = kernel;
+						convert(result, (Subsampling)s, (Graphics::YUVToRGBManager::LuminanceScale)scale, y, u, v, width, height, 600, 300);
+
+						TS_ASSERT_EQUALS(memcmp(ref.getPixels(), result.getPixels(), ref.pitch * height), 0);
+
+						ref.free();
+						result.free();
+					}
+				}
+			}
+		}
+
+		Graphics::YUVToRGBRow::convertFunc = nullptr;
+	}
+
+public:
+	void test_row_kernels() {
+		_seed = 1;
+
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			compareKernel(Graphics::YUVToRGBRow::convertSSE2);
+#endif
+
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			compareKernel(Graphics::YUVToRGBRow::convertAVX2);
+#endif
+
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		// NEON is always available on aarch64
+		compareKernel(Graphics::YUVToRGBRow::convertNEON);
+#endif
+	}
+
+	void test_conversion_speed() {
+#if BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		const int numFrames = 500;
+
+		const int width = 640, height = 480;
+		byte *y = new byte[width * height];
+		byte *u = new byte[width * height / 4];
+		byte *v = new byte[width * height / 4];
+		_seed = 1;
+		fillPlane(y, width * height);
+		fillPlane(u, width * height / 4);
+		fillPlane(v, width * height / 4);
+
+		Graphics::Surface dst;
+		dst.create(width, height, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+		Graphics::YUVToRGBRow::convertFunc = Graphics::YUVToRGBRow::convertGeneric;
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < numFrames; i++)
+			YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, width, width / 2);
+		const uint32 lookupTime = g_system->getMillis() - start;
+
+		// The null backend reports no CPU features, so pick the kernel here
+		Graphics::YUVToRGBRow::ConvertFunc kernel = Graphics::YUVToRGBRow::convertGeneric;
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			kernel = Graphics::YUVToRGBRow::convertSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			kernel = Graphics::YUVToRGBRow::convertAVX2;
+#endif
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		kernel = Graphics::YUVToRGBRow::convertNEON;
+#endif
+
+		Graphics::YUVToRGBRow::convertFunc = kernel;
+		start = g_system->getMillis();
+		for (int i = 0; i < numFrames; i++)
+			YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, width, width / 2);
+		const uint32 kernelTime = g_system->getMillis() - start;
+
+		TS_TRACE(Common::String::format("YUV420 to RGBA8888, %d frames of %dx%d: lookup %d ms, row kernels %d ms", numFrames, width, height, lookupTime, kernelTime).c_str());
+
+		Graphics::YUVToRGBRow::convertFunc = nullptr;
+		dst.free();
+		delete[] y;
+		delete[] u;
+		delete[] v;
+#endif
+	}
+};
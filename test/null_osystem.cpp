@@ -1,4 +1,5 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_abort
+#define FORBIDDEN_SYMBOL_EXCEPTION_getenv
 
 #define USE_NULL_DRIVER 1
 #define NULL_DRIVER_USE_FOR_TEST 1
@@ -17,6 +18,10 @@ void Common::install_null_g_system() {
 	g_system = OSystem_NULL_create(silenceLogs);
 }
 
+bool Common::benchmarks_enabled() {
+	return getenv("SCUMMVM_BENCHMARKS") != nullptr;
+}
+
 void OSystem_NULL::quit() {
 	abort();
 }
@@ -3,6 +3,8 @@
 namespace Common {
 #if defined(POSIX) || defined(WIN32)
 void install_null_g_system();
+// Whether the slow timing tests were asked for, with SCUMMVM_BENCHMARKS set
+bool benchmarks_enabled();
 #define NULL_OSYSTEM_IS_AVAILABLE 1
 #else
 #define NULL_OSYSTEM_IS_AVAILABLE 0
@@ -0,0 +1,218 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/fs.h"
+#include "common/str.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class BinkTestSuite : public CxxTest::TestSuite {
+#ifdef USE_BINK
+	uint32 _seed;
+
+	int nextRandom(int max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 12) % max;
+	}
+
+	/** Fill a block like the decoder does, with a few coefficients or all of them. */
+	void fillBlock(int32 *block) {
+		memset(block, 0, 64 * sizeof(int32));
+
+		const int count = nextRandom(3) ? 1 + nextRandom(8) : 64;
+		for (int i = 0; i < count; i++)
+			block[nextRandom(64)] = nextRandom(2048) - 1024;
+	}
+
+	void fillPixels(byte *pixels, int size) {
+		for (int i = 0; i < size; i++)
+			pixels[i] = nextRandom(256);
+	}
+
+	struct Kernels {
+		Video::BinkDSP::IDCTFunc idct;
+		Video::BinkDSP::IDCTPutFunc idctPut;
+		Video::BinkDSP::IDCTPutFunc idctAdd;
+		Video::BinkDSP::AddPixelsFunc addPixels;
+
+		Kernels() :
+			idct(Video::BinkDSP::idct), idctPut(Video::BinkDSP::idctPut),
+			idctAdd(Video::BinkDSP::idctAdd), addPixels(Video::BinkDSP::addPixels) {}
+	};
+
+	/** Compare the selected kernels to the generic versions. */
+	void compareKernels() {
+		const Kernels kernels;
+		Video::BinkDSP::initGeneric();
+		const Kernels generic;
+
+		// Blocks are written into a wider plane, with some room around them
+		const int pitch = 24;
+		byte ref[pitch * 10], result[pitch * 10];
+
+		_seed = 1;
+		for (int i = 0; i < 2000; i++) {
+			int32 block[64], refBlock[64], resultBlock[64];
+			fillBlock(block);
+
+			memcpy(refBlock, block, sizeof(block));
+			memcpy(resultBlock, block, sizeof(block));
+			generic.idct(refBlock);
+			kernels.idct(resultBlock);
+			TS_ASSERT_EQUALS(memcmp(refBlock, resultBlock, sizeof(refBlock)), 0);
+
+			fillPixels(ref, sizeof(ref));
+			memcpy(result, ref, sizeof(ref));
+			generic.idctPut(ref + pitch + 8, pitch, block);
+			kernels.idctPut(result + pitch + 8, pitch, block);
+			TS_ASSERT_EQUALS(memcmp(ref, result, sizeof(ref)), 0);
+
+			generic.idctAdd(ref + pitch + 8, pitch, block);
+			kernels.idctAdd(result + pitch + 8, pitch, block);
+			TS_ASSERT_EQUALS(memcmp(ref, result, sizeof(ref)), 0);
+
+			int16 residue[64];
+			for (int j = 0; j < 64; j++)
+				residue[j] = nextRandom(512) - 256;
+			generic.addPixels(ref + pitch + 8, pitch, residue);
+			kernels.addPixels(result + pitch + 8, pitch, residue);
+			TS_ASSERT_EQUALS(memcmp(ref, result, sizeof(ref)), 0);
+		}
+	}
+
+	/** Select the fastest kernels, the null backend reports no CPU features. */
+	static void initBestKernels() {
+		Video::BinkDSP::initGeneric();
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			Video::BinkDSP::initSSE2();
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			Video::BinkDSP::initAVX2();
+#endif
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		Video::BinkDSP::initNEON();
+#endif
+	}
+#endif
+
+public:
+	void test_dsp_kernels() {
+#ifdef USE_BINK
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			Video::BinkDSP::initSSE2();
+			compareKernels();
+		}
+#endif
+
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			Video::BinkDSP::initAVX2();
+			compareKernels();
+		}
+#endif
+
+#if defined(SCUMMVM_NEON) && defined(__aarch64__)
+		// NEON is always available on aarch64
+		Video::BinkDSP::initNEON();
+		compareKernels();
+#endif
+#endif
+	}
+
+	void test_dsp_speed() {
+#if defined(USE_BINK) && BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		const int numBlocks = 2000000;
+
+		int32 blocks[16][64];
+		_seed = 1;
+		for (int i = 0; i < 16; i++)
+			fillBlock(blocks[i]);
+
+		const int pitch = 640;
+		byte *plane = new byte[pitch * 8];
+		fillPixels(plane, pitch * 8);
+
+		uint32 times[2];
+		for (int pass = 0; pass < 2; pass++) {
+			if (pass == 0)
+				Video::BinkDSP::initGeneric();
+			else
+				initBestKernels();
+
+			const uint32 start = g_system->getMillis();
+			for (int i = 0; i < numBlocks; i++) {
+				byte *dest = plane + (i & 63) * 8;
+				if (i & 1)
+					Video::BinkDSP::idctAdd(dest, pitch, blocks[i & 15]);
+				else
+					Video::BinkDSP::idctPut(dest, pitch, blocks[i & 15]);
+			}
+			times[pass] = g_system->getMillis() - start;
+		}
+
+		TS_TRACE(Common::String::format("Bink IDCT, %d blocks: generic %d ms, kernels %d ms", numBlocks, times[0], times[1]).c_str());
+		delete[] plane;
+#endif
+	}
+
+	/**
+	 * Time the decoding of a whole file, if there is one named
+	 * bink_benchmark.bik in the working directory. Nothing is played
+	 * or displayed, the audio packets are only decoded.
+	 */
+	void test_decode_speed() {
+#if defined(USE_BINK) && BENCHMARK_TIME
+		if (!Common::benchmarks_enabled())
+			return;
+
+		Common::install_null_g_system();
+
+		Common::FSNode file("bink_benchmark.bik");
+		if (!file.exists())
+			return;
+
+		initBestKernels();
+
+		Video::BinkDecoder decoder;
+		TS_ASSERT(decoder.loadStream(file.createReadStream()));
+		if (!decoder.isVideoLoaded())
+			return;
+
+		uint32 frames = 0;
+		const uint32 start = g_system->getMillis();
+		while (!decoder.endOfVideo()) {
+			if (!decoder.decodeNextFrame())
+				break;
+			frames++;
+		}
+		const uint32 time = g_system->getMillis() - start;
+
+		TS_TRACE(Common::String::format("Bink decoding, %d frames of %dx%d: %d ms", frames, decoder.getWidth(), decoder.getHeight(), time).c_str());
+		TS_ASSERT_EQUALS(frames, decoder.getFrameCount());
+#endif
+	}
+};
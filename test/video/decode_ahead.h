@@ -0,0 +1,186 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/mutex.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#include "video/video_decoder.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+/**
+ * A video of numbered frames, each filled with its number, which can be
+ * seeked and played in reverse.
+ */
+class NumberedFramesDecoder : public Video::VideoDecoder {
+public:
+	class NumberedFramesTrack : public FixedRateVideoTrack {
+	public:
+		NumberedFramesTrack(int frameCount) : _frameCount(frameCount), _curFrame(-1), _reversed(false), _decodedFrames(0) {
+			_surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		}
+
+		~NumberedFramesTrack() {
+			_surface.free();
+		}
+
+		/** Return the number of frames decoded so far, on any thread. */
+		int getDecodedFrames() const {
+			Common::StackLock lock(_mutex);
+			return _decodedFrames;
+		}
+
+		bool endOfTrack() const override { return _reversed ? _curFrame <= 0 : _curFrame >= _frameCount - 1; }
+		bool isSeekable() const override { return true; }
+
+		bool seek(const Audio::Timestamp &time) override {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		uint16 getWidth() const override { return _surface.w; }
+		uint16 getHeight() const override { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
+		int getCurFrame() const override { return _curFrame; }
+		int getFrameCount() const override { return _frameCount; }
+
+		const Graphics::Surface *decodeNextFrame() override {
+			_curFrame += _reversed ? -1 : 1;
+			memset(_surface.getPixels(), _curFrame, _surface.w * _surface.h);
+
+			Common::StackLock lock(_mutex);
+			_decodedFrames++;
+			return &_surface;
+		}
+
+		bool setReverse(bool reverse) override {
+			_reversed = reverse;
+			return true;
+		}
+
+		bool isReversed() const override { return _reversed; }
+
+	protected:
+		Common::Rational getFrameRate() const override { return 10; }
+
+	private:
+		int _frameCount;
+		int _curFrame;
+		bool _reversed;
+		Graphics::Surface _surface;
+
+		mutable Common::Mutex _mutex;
+		int _decodedFrames;
+	};
+
+	NumberedFramesDecoder(int frameCount) {
+		_track = new NumberedFramesTrack(frameCount);
+		addTrack(_track);
+	}
+
+	~NumberedFramesDecoder() {
+		close();
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) override { return false; }
+
+	NumberedFramesTrack *getNumberedTrack() const { return _track; }
+
+private:
+	NumberedFramesTrack *_track;
+};
+
+#endif
+
+class DecodeAheadTestSuite : public CxxTest::TestSuite {
+#if NULL_OSYSTEM_IS_AVAILABLE
+	/** Let the worker decode frames ahead, until the track has decoded the given number. */
+	static void decodeAheadUntil(NumberedFramesDecoder &decoder, int decodedFrames) {
+		for (int i = 0; i < 1000 && decoder.getNumberedTrack()->getDecodedFrames() < decodedFrames; i++) {
+			decoder.decodeAhead(0);
+			g_system->delayMillis(1);
+		}
+
+		TS_ASSERT_LESS_THAN_EQUALS(decodedFrames, decoder.getNumberedTrack()->getDecodedFrames());
+	}
+
+	static int decodeFrameNumber(NumberedFramesDecoder &decoder) {
+		const Graphics::Surface *frame = decoder.decodeNextFrame();
+		TS_ASSERT(frame);
+		return frame ? *(const byte *)frame->getPixels() : -1;
+	}
+#endif
+
+public:
+	void test_frames_in_order() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		NumberedFramesDecoder decoder(12);
+		TS_ASSERT(decoder.setDecodeAheadDepth(3));
+
+		for (int i = 0; i < 12; i++) {
+			decoder.decodeAhead(0);
+			TS_ASSERT_EQUALS(decodeFrameNumber(decoder), i);
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), i);
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT_EQUALS(decoder.getNumberedTrack()->getDecodedFrames(), 12);
+#endif
+	}
+
+	void test_seek_with_queued_frames() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		NumberedFramesDecoder decoder(20);
+		TS_ASSERT(decoder.setDecodeAheadDepth(4));
+
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 0);
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 1);
+		decodeAheadUntil(decoder, 6);
+
+		// The displayed frame is still the one decoded last by the caller,
+		// while the worker may be busy with the next one
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 1);
+		decoder.decodeAhead(0);
+
+		TS_ASSERT(decoder.seekToFrame(10));
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 10);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 10);
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 11);
+
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 0);
+#endif
+	}
+
+	void test_reverse_with_queued_frames() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		NumberedFramesDecoder decoder(20);
+		TS_ASSERT(decoder.setDecodeAheadDepth(4));
+
+		for (int i = 0; i < 3; i++)
+			TS_ASSERT_EQUALS(decodeFrameNumber(decoder), i);
+		decodeAheadUntil(decoder, 7);
+		decoder.decodeAhead(0);
+
+		// Reversing continues from the displayed frame, not from the ones
+		// decoded ahead
+		TS_ASSERT(decoder.setReverse(true));
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 1);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 1);
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 0);
+		TS_ASSERT(decoder.endOfVideo());
+
+		TS_ASSERT(decoder.setReverse(false));
+		TS_ASSERT_EQUALS(decodeFrameNumber(decoder), 1);
+#endif
+	}
+};
@@ -45,6 +45,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -246,6 +247,8 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr) {
 	_curFrame = -1;
 
+	BinkDSP::init();
+
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
@@ -815,7 +818,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
+	BinkDSP::idct(block);
 
 	int32 *src   = block;
 	byte  *dest1 = ctx.dest;
@@ -945,11 +948,7 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	readResidue(*ctx.video, block, v);
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	BinkDSP::addPixels(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
@@ -960,7 +959,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	BinkDSP::idctPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -981,7 +980,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	BinkDSP::idctAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -1023,9 +1022,11 @@ void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
 		memset(bundle.curDec, v, n);
 		bundle.curDec += n;
 
-	} else
-		while (bundle.curDec < decEnd)
-			*bundle.curDec++ = getHuffmanSymbol(video, bundle.huffman);
+	} else {
+		_huffman[bundle.huffman.index]->getSymbols(*video.bits, bundle.curDec, n);
+		for (; bundle.curDec < decEnd; bundle.curDec++)
+			*bundle.curDec = bundle.huffman.symbols[*bundle.curDec];
+	}
 }
 
 void BinkDecoder::BinkVideoTrack::readMotionValues(VideoFrame &video, Bundle &bundle) {
@@ -1111,11 +1112,14 @@ void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle
 	if (decEnd > bundle.dataEnd)
 		error("Too many pattern values");
 
-	byte v;
+	// Two nibbles per value, decoded in chunks
+	byte nibbles[128];
 	while (bundle.curDec < decEnd) {
-		v  = getHuffmanSymbol(video, bundle.huffman);
-		v |= getHuffmanSymbol(video, bundle.huffman) << 4;
-		*bundle.curDec++ = v;
+		const uint32 count = MIN<uint32>(decEnd - bundle.curDec, ARRAYSIZE(nibbles) / 2);
+		_huffman[bundle.huffman.index]->getSymbols(*video.bits, nibbles, count * 2);
+
+		for (uint32 i = 0; i < count; i++)
+			*bundle.curDec++ = bundle.huffman.symbols[nibbles[i * 2]] | (bundle.huffman.symbols[nibbles[i * 2 + 1]] << 4);
 	}
 }
 
@@ -1410,88 +1414,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-	const int a0 = (src)[s0] + (src)[s4]; \
-	const int a1 = (src)[s0] - (src)[s4]; \
-	const int a2 = (src)[s2] + (src)[s6]; \
-	const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-	const int a4 = (src)[s5] + (src)[s3]; \
-	const int a5 = (src)[s5] - (src)[s3]; \
-	const int a6 = (src)[s1] + (src)[s7]; \
-	const int a7 = (src)[s1] - (src)[s7]; \
-	const int b0 = a4 + a6; \
-	const int b1 = (A3*(a5 + a7)) >> 11; \
-	const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-	const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-	const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-	(dest)[d0] = munge(a0+a2   +b0); \
-	(dest)[d1] = munge(a1+a3-a2+b2); \
-	(dest)[d2] = munge(a1-a3+a2+b3); \
-	(dest)[d3] = munge(a0-a2   -b4); \
-	(dest)[d4] = munge(a0-a2   +b4); \
-	(dest)[d5] = munge(a1-a3+a2-b3); \
-	(dest)[d6] = munge(a1+a3-a2-b2); \
-	(dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int32 *dest, const int32 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
-	int i;
-	int32 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
-	int i;
-	int32 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audioInfo(&audio) {
@@ -330,11 +330,6 @@ private:
 		void readDCS         (VideoFrame &video, Bundle &bundle);
 		void readDCTCoeffs   (VideoFrame &video, int32 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int32 *block);
-		void IDCTPut(DecodeContext &ctx, int32 *block);
-		void IDCTAdd(DecodeContext &ctx, int32 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
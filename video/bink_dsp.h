@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+#include "common/scummsys.h"
+
+namespace Video {
+
+/**
+ * The 8x8 block operations of the Bink video decoder.
+ *
+ * All of them work on 8 bit planes, and results are truncated to 8 bits
+ * rather than clamped, like the original decoder does. The generic versions
+ * are the reference, the SIMD versions have to match them bit for bit.
+ */
+class BinkDSP {
+public:
+	typedef void (*IDCTFunc)(int32 *block);
+	typedef void (*IDCTPutFunc)(byte *dest, int pitch, const int32 *block);
+	typedef void (*AddPixelsFunc)(byte *dest, int pitch, const int16 *block);
+
+	/** Inverse transform the 64 coefficients of @p block in place. */
+	static IDCTFunc idct;
+	/** Inverse transform @p block and store the result to @p dest. */
+	static IDCTPutFunc idctPut;
+	/** Inverse transform @p block and add the result to @p dest. */
+	static IDCTPutFunc idctAdd;
+	/** Add the residue in @p block to @p dest. */
+	static AddPixelsFunc addPixels;
+
+	/**
+	 * Select the fastest versions the CPU supports. This has to be called
+	 * before any of the functions above is used.
+	 */
+	static void init();
+
+	static void initGeneric();
+#ifdef SCUMMVM_NEON
+	static void initNEON();
+#endif
+#ifdef SCUMMVM_SSE2
+	static void initSSE2();
+#endif
+#ifdef SCUMMVM_AVX2
+	static void initAVX2();
+#endif
+};
+
+} // End of namespace Video
+
+#endif
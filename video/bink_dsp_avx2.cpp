@@ -0,0 +1,172 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "video/bink_dsp.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Video {
+
+static FORCEINLINE __m256i avx2_mulShift(__m256i a, int32 c) {
+	return _mm256_srai_epi32(_mm256_mullo_epi32(a, _mm256_set1_epi32(c)), 11);
+}
+
+/** The transform of bink_dsp.cpp, on all eight columns or rows at once. */
+template<bool munge>
+static FORCEINLINE void avx2_transform(__m256i *s) {
+	const __m256i a0 = _mm256_add_epi32(s[0], s[4]);
+	const __m256i a1 = _mm256_sub_epi32(s[0], s[4]);
+	const __m256i a2 = _mm256_add_epi32(s[2], s[6]);
+	const __m256i a3 = avx2_mulShift(_mm256_sub_epi32(s[2], s[6]), 2896);
+	const __m256i a4 = _mm256_add_epi32(s[5], s[3]);
+	const __m256i a5 = _mm256_sub_epi32(s[5], s[3]);
+	const __m256i a6 = _mm256_add_epi32(s[1], s[7]);
+	const __m256i a7 = _mm256_sub_epi32(s[1], s[7]);
+	const __m256i b0 = _mm256_add_epi32(a4, a6);
+	const __m256i b1 = avx2_mulShift(_mm256_add_epi32(a5, a7), 3784);
+	const __m256i b2 = _mm256_add_epi32(_mm256_sub_epi32(avx2_mulShift(a5, -5352), b0), b1);
+	const __m256i b3 = _mm256_sub_epi32(avx2_mulShift(_mm256_sub_epi32(a6, a4), 2896), b2);
+	const __m256i b4 = _mm256_sub_epi32(_mm256_add_epi32(avx2_mulShift(a7, 2217), b3), b1);
+
+	const __m256i c0 = _mm256_add_epi32(a0, a2);
+	const __m256i c1 = _mm256_sub_epi32(_mm256_add_epi32(a1, a3), a2);
+	const __m256i c2 = _mm256_add_epi32(_mm256_sub_epi32(a1, a3), a2);
+	const __m256i c3 = _mm256_sub_epi32(a0, a2);
+
+	s[0] = _mm256_add_epi32(c0, b0);
+	s[1] = _mm256_add_epi32(c1, b2);
+	s[2] = _mm256_add_epi32(c2, b3);
+	s[3] = _mm256_sub_epi32(c3, b4);
+	s[4] = _mm256_add_epi32(c3, b4);
+	s[5] = _mm256_sub_epi32(c2, b3);
+	s[6] = _mm256_sub_epi32(c1, b2);
+	s[7] = _mm256_sub_epi32(c0, b0);
+
+	if (munge) {
+		const __m256i round = _mm256_set1_epi32(0x7F);
+		for (int i = 0; i < 8; i++)
+			s[i] = _mm256_srai_epi32(_mm256_add_epi32(s[i], round), 8);
+	}
+}
+
+static FORCEINLINE void avx2_transpose(__m256i *r) {
+	__m256i t[8], u[8];
+
+	for (int i = 0; i < 8; i += 2) {
+		t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+		t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+	}
+	for (int i = 0; i < 8; i += 4) {
+		u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+		u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+		u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+		u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+	}
+	for (int i = 0; i < 4; i++) {
+		r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+		r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+	}
+}
+
+static FORCEINLINE void avx2_idct(__m256i *r, const int32 *block) {
+	for (int i = 0; i < 8; i++)
+		r[i] = _mm256_loadu_si256((const __m256i *)(block + i * 8));
+
+	// The columns first, then the rows, which are turned into columns too
+	avx2_transform<false>(r);
+	avx2_transpose(r);
+	avx2_transform<true>(r);
+	avx2_transpose(r);
+}
+
+/** Truncate two rows to 8 bits, as 16 bit values. */
+static FORCEINLINE __m256i avx2_rows(__m256i r0, __m256i r1) {
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	const __m256i rows = _mm256_packs_epi32(_mm256_and_si256(r0, mask), _mm256_and_si256(r1, mask));
+	return _mm256_permute4x64_epi64(rows, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/** Store two rows of 16 bit values in the range [0, 255]. */
+static FORCEINLINE void avx2_storeRows(byte *dest, int pitch, __m256i rows) {
+	const __m256i packed = _mm256_packus_epi16(rows, rows);
+	_mm_storel_epi64((__m128i *)dest, _mm256_castsi256_si128(packed));
+	_mm_storel_epi64((__m128i *)(dest + pitch), _mm256_extracti128_si256(packed, 1));
+}
+
+/** Add two rows of 16 bit values to the pixels at @p dest, wrapping around. */
+static FORCEINLINE void avx2_addRows(byte *dest, int pitch, __m256i rows) {
+	const __m128i pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dest), _mm_loadl_epi64((const __m128i *)(dest + pitch)));
+	const __m256i sum = _mm256_add_epi16(_mm256_cvtepu8_epi16(pixels), rows);
+	avx2_storeRows(dest, pitch, _mm256_and_si256(sum, _mm256_set1_epi16(0xFF)));
+}
+
+static void idctAVX2(int32 *block) {
+	__m256i r[8];
+	avx2_idct(r, block);
+
+	for (int i = 0; i < 8; i++)
+		_mm256_storeu_si256((__m256i *)(block + i * 8), r[i]);
+}
+
+static void idctPutAVX2(byte *dest, int pitch, const int32 *block) {
+	__m256i r[8];
+	avx2_idct(r, block);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		avx2_storeRows(dest, pitch, avx2_rows(r[i], r[i + 1]));
+}
+
+static void idctAddAVX2(byte *dest, int pitch, const int32 *block) {
+	__m256i r[8];
+	avx2_idct(r, block);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		avx2_addRows(dest, pitch, avx2_rows(r[i], r[i + 1]));
+}
+
+static void addPixelsAVX2(byte *dest, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2, block += 16)
+		avx2_addRows(dest, pitch, _mm256_loadu_si256((const __m256i *)block));
+}
+
+void BinkDSP::initAVX2() {
+	idct = idctAVX2;
+	idctPut = idctPutAVX2;
+	idctAdd = idctAddAVX2;
+	addPixels = addPixelsAVX2;
+}
+
+} // End of namespace Video
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,181 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "video/bink_dsp.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Video {
+
+static FORCEINLINE int32x4_t neon_mulShift(int32x4_t a, int32 c) {
+	return vshrq_n_s32(vmulq_n_s32(a, c), 11);
+}
+
+/** The transform of bink_dsp.cpp, on four columns or rows at once. */
+template<bool munge>
+static FORCEINLINE void neon_transform(int32x4_t *s) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = neon_mulShift(vsubq_s32(s[2], s[6]), 2896);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = neon_mulShift(vaddq_s32(a5, a7), 3784);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(neon_mulShift(a5, -5352), b0), b1);
+	const int32x4_t b3 = vsubq_s32(neon_mulShift(vsubq_s32(a6, a4), 2896), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(neon_mulShift(a7, 2217), b3), b1);
+
+	const int32x4_t c0 = vaddq_s32(a0, a2);
+	const int32x4_t c1 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t c2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+	const int32x4_t c3 = vsubq_s32(a0, a2);
+
+	s[0] = vaddq_s32(c0, b0);
+	s[1] = vaddq_s32(c1, b2);
+	s[2] = vaddq_s32(c2, b3);
+	s[3] = vsubq_s32(c3, b4);
+	s[4] = vaddq_s32(c3, b4);
+	s[5] = vsubq_s32(c2, b3);
+	s[6] = vsubq_s32(c1, b2);
+	s[7] = vsubq_s32(c0, b0);
+
+	if (munge) {
+		const int32x4_t round = vdupq_n_s32(0x7F);
+		for (int i = 0; i < 8; i++)
+			s[i] = vshrq_n_s32(vaddq_s32(s[i], round), 8);
+	}
+}
+
+static FORCEINLINE void neon_transpose4(int32x4_t &r0, int32x4_t &r1, int32x4_t &r2, int32x4_t &r3) {
+	const int32x4x2_t t01 = vtrnq_s32(r0, r1);
+	const int32x4x2_t t23 = vtrnq_s32(r2, r3);
+	r0 = vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0]));
+	r1 = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+	r2 = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+	r3 = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+}
+
+/** Transpose the 8x8 block held in the left and right halves of its rows. */
+static FORCEINLINE void neon_transpose(int32x4_t *lo, int32x4_t *hi) {
+	neon_transpose4(lo[0], lo[1], lo[2], lo[3]);
+	neon_transpose4(hi[0], hi[1], hi[2], hi[3]);
+	neon_transpose4(lo[4], lo[5], lo[6], lo[7]);
+	neon_transpose4(hi[4], hi[5], hi[6], hi[7]);
+
+	for (int i = 0; i < 4; i++) {
+		const int32x4_t t = hi[i];
+		hi[i] = lo[i + 4];
+		lo[i + 4] = t;
+	}
+}
+
+static FORCEINLINE void neon_idct(int32x4_t *lo, int32x4_t *hi, const int32 *block) {
+	for (int i = 0; i < 8; i++) {
+		lo[i] = vld1q_s32(block + i * 8);
+		hi[i] = vld1q_s32(block + i * 8 + 4);
+	}
+
+	// The columns first, then the rows, which are turned into columns too
+	neon_transform<false>(lo);
+	neon_transform<false>(hi);
+	neon_transpose(lo, hi);
+	neon_transform<true>(lo);
+	neon_transform<true>(hi);
+	neon_transpose(lo, hi);
+}
+
+/** Truncate a row to 8 bits. Narrowing keeps the low bits, which wraps. */
+static FORCEINLINE uint8x8_t neon_row(int32x4_t lo, int32x4_t hi) {
+	const int16x8_t row = vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+	return vmovn_u16(vreinterpretq_u16_s16(row));
+}
+
+static void idctNEON(int32 *block) {
+	int32x4_t lo[8], hi[8];
+	neon_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++) {
+		vst1q_s32(block + i * 8, lo[i]);
+		vst1q_s32(block + i * 8 + 4, hi[i]);
+	}
+}
+
+static void idctPutNEON(byte *dest, int pitch, const int32 *block) {
+	int32x4_t lo[8], hi[8];
+	neon_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, neon_row(lo[i], hi[i]));
+}
+
+static void idctAddNEON(byte *dest, int pitch, const int32 *block) {
+	int32x4_t lo[8], hi[8];
+	neon_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), neon_row(lo[i], hi[i])));
+}
+
+static void addPixelsNEON(byte *dest, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8) {
+		const uint8x8_t residue = vmovn_u16(vreinterpretq_u16_s16(vld1q_s16(block)));
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), residue));
+	}
+}
+
+void BinkDSP::initNEON() {
+	idct = idctNEON;
+	idctPut = idctPutNEON;
+	idctAdd = idctAddNEON;
+	addPixels = addPixelsNEON;
+}
+
+} // End of namespace Video
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
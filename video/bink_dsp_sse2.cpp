@@ -0,0 +1,196 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "video/bink_dsp.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Video {
+
+static FORCEINLINE __m128i sse2_mul(__m128i a, int32 c) {
+	// SSE2 has no 32 bit multiplication keeping the low half, so multiply
+	// the even and odd lanes separately. The low 32 bits of the product
+	// are the same for signed and unsigned operands.
+	const __m128i k = _mm_set1_epi32(c);
+	const __m128i even = _mm_mul_epu32(a, k);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), k);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static FORCEINLINE __m128i sse2_mulShift(__m128i a, int32 c) {
+	return _mm_srai_epi32(sse2_mul(a, c), 11);
+}
+
+/** The transform of bink_dsp.cpp, on four columns or rows at once. */
+template<bool munge>
+static FORCEINLINE void sse2_transform(__m128i *s) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = sse2_mulShift(_mm_sub_epi32(s[2], s[6]), 2896);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = sse2_mulShift(_mm_add_epi32(a5, a7), 3784);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(sse2_mulShift(a5, -5352), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(sse2_mulShift(_mm_sub_epi32(a6, a4), 2896), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(sse2_mulShift(a7, 2217), b3), b1);
+
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+
+	s[0] = _mm_add_epi32(c0, b0);
+	s[1] = _mm_add_epi32(c1, b2);
+	s[2] = _mm_add_epi32(c2, b3);
+	s[3] = _mm_sub_epi32(c3, b4);
+	s[4] = _mm_add_epi32(c3, b4);
+	s[5] = _mm_sub_epi32(c2, b3);
+	s[6] = _mm_sub_epi32(c1, b2);
+	s[7] = _mm_sub_epi32(c0, b0);
+
+	if (munge) {
+		const __m128i round = _mm_set1_epi32(0x7F);
+		for (int i = 0; i < 8; i++)
+			s[i] = _mm_srai_epi32(_mm_add_epi32(s[i], round), 8);
+	}
+}
+
+static FORCEINLINE void sse2_transpose4(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3) {
+	const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/** Transpose the 8x8 block held in the left and right halves of its rows. */
+static FORCEINLINE void sse2_transpose(__m128i *lo, __m128i *hi) {
+	sse2_transpose4(lo[0], lo[1], lo[2], lo[3]);
+	sse2_transpose4(hi[0], hi[1], hi[2], hi[3]);
+	sse2_transpose4(lo[4], lo[5], lo[6], lo[7]);
+	sse2_transpose4(hi[4], hi[5], hi[6], hi[7]);
+
+	for (int i = 0; i < 4; i++) {
+		const __m128i t = hi[i];
+		hi[i] = lo[i + 4];
+		lo[i + 4] = t;
+	}
+}
+
+static FORCEINLINE void sse2_idct(__m128i *lo, __m128i *hi, const int32 *block) {
+	for (int i = 0; i < 8; i++) {
+		lo[i] = _mm_loadu_si128((const __m128i *)(block + i * 8));
+		hi[i] = _mm_loadu_si128((const __m128i *)(block + i * 8 + 4));
+	}
+
+	// The columns first, then the rows, which are turned into columns too
+	sse2_transform<false>(lo);
+	sse2_transform<false>(hi);
+	sse2_transpose(lo, hi);
+	sse2_transform<true>(lo);
+	sse2_transform<true>(hi);
+	sse2_transpose(lo, hi);
+}
+
+/** Truncate a row to 8 bits, as 16 bit values. */
+static FORCEINLINE __m128i sse2_row(__m128i lo, __m128i hi) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	return _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+}
+
+/** Add a row of 16 bit values to the 8 pixels at @p dest, wrapping around. */
+static FORCEINLINE void sse2_addRow(byte *dest, __m128i row) {
+	const __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), _mm_setzero_si128());
+	const __m128i sum = _mm_and_si128(_mm_add_epi16(pixels, row), _mm_set1_epi16(0xFF));
+	_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(sum, sum));
+}
+
+static void idctSSE2(int32 *block) {
+	__m128i lo[8], hi[8];
+	sse2_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++) {
+		_mm_storeu_si128((__m128i *)(block + i * 8), lo[i]);
+		_mm_storeu_si128((__m128i *)(block + i * 8 + 4), hi[i]);
+	}
+}
+
+static void idctPutSSE2(byte *dest, int pitch, const int32 *block) {
+	__m128i lo[8], hi[8];
+	sse2_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch) {
+		const __m128i row = sse2_row(lo[i], hi[i]);
+		_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(row, row));
+	}
+}
+
+static void idctAddSSE2(byte *dest, int pitch, const int32 *block) {
+	__m128i lo[8], hi[8];
+	sse2_idct(lo, hi, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		sse2_addRow(dest, sse2_row(lo[i], hi[i]));
+}
+
+static void addPixelsSSE2(byte *dest, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		sse2_addRow(dest, _mm_loadu_si128((const __m128i *)block));
+}
+
+void BinkDSP::initSSE2() {
+	idct = idctSSE2;
+	idctPut = idctPutSSE2;
+	idctAdd = idctAddSSE2;
+	addPixels = addPixelsSSE2;
+}
+
+} // End of namespace Video
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
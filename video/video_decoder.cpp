@@ -27,9 +27,276 @@
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/threadpool.h"
+
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * Takes the place of the video track of a video decoded ahead in the track list,
+ * so that the queries of VideoDecoder see the frame being displayed rather
+ * than the last one decoded.
+ *
+ * While no frame is queued, the displayed frame is the last one decoded by
+ * the source track, and everything is passed on to it.
+ *
+ * Frames are decoded ahead on a worker thread, one at a time. While a frame is
+ * being decoded there, the worker owns the source track and the packets of the
+ * decoder, so everything which uses their state waits for it first. Only the
+ * properties which do not change while decoding, like the size or the frame
+ * count, are read from the source track in the meantime.
+ */
+class VideoDecoder::DecodeAheadVideoTrack : public VideoDecoder::VideoTrack {
+public:
+	DecodeAheadVideoTrack(VideoDecoder *decoder, VideoTrack *source, uint depth);
+	~DecodeAheadVideoTrack();
+
+	VideoTrack *getSource() const { return _source; }
+
+	/**
+	 * Queue the frame the worker has finished, then start decoding the next
+	 * one into the ring, if there is room for it.
+	 *
+	 * @return whether a frame was started
+	 */
+	bool decodeAhead();
+
+	/** Wait for the frame being decoded on the worker, and queue it. */
+	void finishDecoding();
+
+	/** Drop the queued frames. */
+	void flush() {
+		finishDecoding();
+		_first = _count = 0;
+	}
+
+	/**
+	 * Return the time the source track has to be moved back to, for it to
+	 * continue from the displayed frame, or -1 if no frame is queued.
+	 */
+	Audio::Timestamp getDisplayedEndTime();
+
+	bool endOfTrack() const override { return isDecodingAhead() ? _state.endOfTrack : _source->endOfTrack(); }
+	bool isRewindable() const override { return _source->isRewindable(); }
+	bool rewind() override;
+	bool isSeekable() const override { return _source->isSeekable(); }
+	bool seek(const Audio::Timestamp &time) override;
+	Audio::Timestamp getDuration() const override { return _source->getDuration(); }
+
+	uint16 getWidth() const override { return _source->getWidth(); }
+	uint16 getHeight() const override { return _source->getHeight(); }
+	Graphics::PixelFormat getPixelFormat() const override { return _source->getPixelFormat(); }
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format) override { finishDecoding(); return _source->setOutputPixelFormat(format); }
+	void setCodecAccuracy(Image::CodecAccuracy accuracy) override { finishDecoding(); _source->setCodecAccuracy(accuracy); }
+	int getCurFrame() const override { return isDecodingAhead() ? _state.curFrame : _source->getCurFrame(); }
+	int getFrameCount() const override { return _source->getFrameCount(); }
+	uint32 getNextFrameStartTime() const override { return isDecodingAhead() ? _state.nextFrameStartTime : _source->getNextFrameStartTime(); }
+	const Graphics::Surface *decodeNextFrame() override;
+	const byte *getPalette() const override { _dirtyPalette = false; return _palette; }
+	bool hasDirtyPalette() const override { return _dirtyPalette; }
+	Audio::Timestamp getFrameTime(uint frame) const override { return _source->getFrameTime(frame); }
+	bool setReverse(bool reverse) override;
+	bool isReversed() const override { return _source->isReversed(); }
+	bool canDither() const override { return _source->canDither(); }
+	void setDither(const byte *palette) override { finishDecoding(); _source->setDither(palette); }
+
+protected:
+	void pauseIntern(bool shouldPause) override {
+		finishDecoding();
+		_source->pause(shouldPause);
+	}
+
+private:
+	struct FrameState {
+		int curFrame;
+		uint32 nextFrameStartTime;
+		bool endOfTrack;
+	};
+
+	struct Frame {
+		// State of the source track right after decoding this frame
+		FrameState state;
+		Graphics::Surface surface;
+		bool hasSurface;
+		bool dirtyPalette;
+		byte palette[256 * 3];
+	};
+
+	FrameState getSourceState() const;
+	void decodeFrame(Frame &frame);
+
+	/** Whether frames are queued or being decoded, so that _state is valid. */
+	bool isDecodingAhead() const { return _count || _job.isValid(); }
+
+	VideoDecoder *_decoder;
+	VideoTrack *_source;
+
+	Common::ThreadPool _pool;
+	// The frame being decoded on the worker, which goes after the queued ones
+	Common::Future<void> _job;
+
+	Common::Array<Frame> _frames;
+	uint _first, _count;
+
+	// The displayed frame, whose state is only valid while decoding ahead
+	FrameState _state;
+	Graphics::Surface _surface;
+	mutable bool _dirtyPalette;
+	byte _palette[256 * 3];
+};
+
+VideoDecoder::DecodeAheadVideoTrack::DecodeAheadVideoTrack(VideoDecoder *decoder, VideoTrack *source, uint depth) :
+		_decoder(decoder), _source(source), _pool(1), _first(0), _count(0), _dirtyPalette(false) {
+	assert(depth > 0);
+
+	Frame frame;
+	frame.hasSurface = false;
+	frame.dirtyPalette = false;
+	_frames.resize(depth, frame);
+
+	_state.curFrame = -1;
+	_state.nextFrameStartTime = 0;
+	_state.endOfTrack = false;
+	memset(_palette, 0, sizeof(_palette));
+
+	// Keep the pause state of the track list
+	if (source->isPaused())
+		pause(true);
+}
+
+VideoDecoder::DecodeAheadVideoTrack::~DecodeAheadVideoTrack() {
+	finishDecoding();
+
+	for (uint i = 0; i < _frames.size(); i++)
+		_frames[i].surface.free();
+
+	_surface.free();
+}
+
+VideoDecoder::DecodeAheadVideoTrack::FrameState VideoDecoder::DecodeAheadVideoTrack::getSourceState() const {
+	FrameState state;
+	state.curFrame = _source->getCurFrame();
+	state.nextFrameStartTime = _source->getNextFrameStartTime();
+	state.endOfTrack = _source->endOfTrack();
+	return state;
+}
+
+bool VideoDecoder::DecodeAheadVideoTrack::decodeAhead() {
+	if (_job.isValid()) {
+		if (!_job.isReady())
+			return false;
+
+		finishDecoding();
+	}
+
+	// Reversed playback repositions the track before each frame, so frames
+	// are only decoded ahead while playing forward
+	if (_count == _frames.size() || _source->isReversed() || _source->endOfTrack())
+		return false;
+
+	if (!_count)
+		_state = getSourceState();
+
+	Frame *frame = &_frames[(_first + _count) % _frames.size()];
+	_job = _pool.submit([this, frame]() {
+		decodeFrame(*frame);
+	});
+
+	return true;
+}
+
+void VideoDecoder::DecodeAheadVideoTrack::finishDecoding() {
+	if (!_job.isValid())
+		return;
+
+	_job.wait();
+	_job = Common::Future<void>();
+	_count++;
+}
+
+void VideoDecoder::DecodeAheadVideoTrack::decodeFrame(Frame &frame) {
+	_decoder->readNextPacket();
+	const Graphics::Surface *surface = _source->decodeNextFrame();
+
+	// The source track reuses its surface for the next frame, so keep a copy.
+	// The buffer of each slot is reused as long as the size stays the same.
+	frame.hasSurface = surface != nullptr;
+	if (surface && surface->w > 0 && surface->h > 0) {
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format)
+			frame.surface.create(surface->w, surface->h, surface->format);
+
+		frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+	} else if (surface) {
+		frame.surface.free();
+	}
+
+	const byte *palette = _source->hasDirtyPalette() ? _source->getPalette() : nullptr;
+	frame.dirtyPalette = palette != nullptr;
+	if (palette)
+		memcpy(frame.palette, palette, sizeof(frame.palette));
+
+	frame.state = getSourceState();
+}
+
+Audio::Timestamp VideoDecoder::DecodeAheadVideoTrack::getDisplayedEndTime() {
+	finishDecoding();
+
+	if (!_count)
+		return Audio::Timestamp().addFrames(-1);
+
+	return _source->getFrameTime(_state.curFrame + 1);
+}
+
+const Graphics::Surface *VideoDecoder::DecodeAheadVideoTrack::decodeNextFrame() {
+	finishDecoding();
+
+	// Nothing was decoded ahead, so decode the frame right away
+	if (!_count) {
+		decodeFrame(_frames[_first]);
+		_count++;
+	}
+
+	Frame &frame = _frames[_first];
+	_first = (_first + 1) % _frames.size();
+	_count--;
+
+	_state = frame.state;
+
+	if (frame.dirtyPalette) {
+		memcpy(_palette, frame.palette, sizeof(_palette));
+		_dirtyPalette = true;
+	}
+
+	// Hand out the slot's buffer, the slot takes over the previous one
+	const bool hasSurface = frame.hasSurface;
+	if (hasSurface)
+		SWAP(_surface, frame.surface);
+
+	// Keep the worker busy while the caller shows this frame. Without
+	// worker threads, this waits for the next decodeAhead() call.
+	if (_pool.getNumThreads())
+		decodeAhead();
+
+	return hasSurface ? &_surface : nullptr;
+}
+
+bool VideoDecoder::DecodeAheadVideoTrack::rewind() {
+	flush();
+	return _source->rewind();
+}
+
+bool VideoDecoder::DecodeAheadVideoTrack::seek(const Audio::Timestamp &time) {
+	flush();
+	return _source->seek(time);
+}
+
+bool VideoDecoder::DecodeAheadVideoTrack::setReverse(bool reverse) {
+	// VideoDecoder::setReverse() already moved the source track back
+	flush();
+	return _source->setReverse(reverse);
+}
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -47,6 +314,8 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_canSetDecodeAheadDepth = true;
+	_decodeAheadTrack = nullptr;
 	_videoCodecAccuracy = Image::CodecAccuracy::Default;
 }
 
@@ -54,6 +323,8 @@ void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	destroyDecodeAheadTrack();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -74,6 +345,7 @@ void VideoDecoder::close() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_canSetDecodeAheadDepth = true;
 }
 
 bool VideoDecoder::loadFile(const Common::Path &filename) {
@@ -114,9 +386,19 @@ bool VideoDecoder::needsUpdate() const {
 }
 
 void VideoDecoder::delayMillis(uint msecs) {
-	if (!needsUpdate())
-		g_system->delayMillis(MIN<uint>(msecs, getTimeToNextFrame()));
-	else
+	if (!needsUpdate()) {
+		uint32 delay = MIN<uint>(msecs, getTimeToNextFrame());
+
+		// Use the wait to decode frames ahead of time, or to hand the next
+		// one to the worker
+		if (_decodeAheadTrack) {
+			const uint32 startTime = g_system->getMillis();
+			decodeAhead(delay);
+			delay -= MIN<uint32>(delay, g_system->getMillis() - startTime);
+		}
+
+		g_system->delayMillis(delay);
+	} else
 		g_system->delayMillis(1); /* This is needed to keep the mixer and timers active */
 }
 
@@ -211,8 +493,12 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 	_canSetDefaultFormat = false;
+	_canSetDecodeAheadDepth = false;
 
-	readNextPacket();
+	// The decode-ahead track reads the packets of the frames it decodes. Once the video
+	// track is over, the remaining audio is still read from here.
+	if (!_decodeAheadTrack || !_nextVideoTrack)
+		readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
 	// any frame available for us to display.
@@ -237,6 +523,14 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Reversing starts from the displayed frame, so move the video back to
+	// it from the frames decoded ahead of time
+	if (_decodeAheadTrack && reverse != _decodeAheadTrack->isReversed()) {
+		const Audio::Timestamp time = _decodeAheadTrack->getDisplayedEndTime();
+		if (time >= 0 && !seek(time))
+			return false;
+	}
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -351,6 +645,10 @@ bool VideoDecoder::rewind() {
 	if (isPlaying())
 		stopAudio();
 
+	// Frames decoded ahead of time are from before the rewind
+	if (_decodeAheadTrack)
+		_decodeAheadTrack->flush();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if (!(*it)->rewind())
 			return false;
@@ -385,6 +683,10 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
+	// Frames decoded ahead of time are from before the seek
+	if (_decodeAheadTrack)
+		_decodeAheadTrack->flush();
+
 	// Do the actual seeking
 	if (!seekIntern(time))
 		return false;
@@ -568,6 +870,77 @@ bool VideoDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
 	return result;
 }
 
+bool VideoDecoder::setDecodeAheadDepth(uint depth) {
+	// If a frame was already decoded, we can't set it now.
+	if (!_canSetDecodeAheadDepth)
+		return false;
+
+	destroyDecodeAheadTrack();
+
+	if (depth == 0)
+		return true;
+
+	// Frames can only be decoded ahead for a single video track
+	int videoTrack = -1;
+	for (uint i = 0; i < _tracks.size(); i++) {
+		if (_tracks[i]->getTrackType() == Track::kTrackTypeVideo) {
+			if (videoTrack >= 0)
+				return false;
+
+			videoTrack = i;
+		}
+	}
+
+	if (videoTrack < 0)
+		return false;
+
+	// The source track stays in the list of internal tracks, which is what
+	// subclasses work with
+	_decodeAheadTrack = new DecodeAheadVideoTrack(this, (VideoTrack *)_tracks[videoTrack], depth);
+	_tracks[videoTrack] = _decodeAheadTrack;
+	findNextVideoTrack();
+	return true;
+}
+
+bool VideoDecoder::decodeAhead(uint32 maxMillis) {
+	if (!_decodeAheadTrack)
+		return false;
+
+	const uint32 startTime = g_system->getMillis();
+	bool decoded = false;
+
+	while (_decodeAheadTrack->decodeAhead()) {
+		decoded = true;
+
+		if (g_system->getMillis() - startTime >= maxMillis)
+			break;
+	}
+
+	if (decoded) {
+		_canSetDither = false;
+		_canSetDefaultFormat = false;
+		_canSetDecodeAheadDepth = false;
+	}
+
+	return decoded;
+}
+
+void VideoDecoder::destroyDecodeAheadTrack() {
+	if (!_decodeAheadTrack)
+		return;
+
+	VideoTrack *source = _decodeAheadTrack->getSource();
+	for (uint i = 0; i < _tracks.size(); i++)
+		if (_tracks[i] == _decodeAheadTrack)
+			_tracks[i] = source;
+
+	if (_nextVideoTrack == _decodeAheadTrack)
+		_nextVideoTrack = source;
+
+	delete _decodeAheadTrack;
+	_decodeAheadTrack = nullptr;
+}
+
 void VideoDecoder::setVideoCodecAccuracy(Image::CodecAccuracy accuracy) {
 	_videoCodecAccuracy = accuracy;
 
@@ -1050,6 +1423,9 @@ bool VideoDecoder::hasAudio() const {
 }
 
 void VideoDecoder::eraseTrack(Track *track) {
+	if (_decodeAheadTrack && _decodeAheadTrack->getSource() == track)
+		destroyDecodeAheadTrack();
+
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
 			_externalTracks.remove_at(idx);
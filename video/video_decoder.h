@@ -407,6 +407,44 @@ public:
 	 */
 	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
+	/**
+	 * Decode up to the given number of frames ahead of the one being displayed.
+	 *
+	 * Frames decoded ahead of time are kept in a ring of surfaces, which
+	 * decodeNextFrame() then takes them from, so that a frame that is costly
+	 * to decode does not make playback late. The frames are decoded on a
+	 * worker thread, one at a time: decodeNextFrame() starts the next one,
+	 * and decodeAhead(), which delayMillis() also calls while waiting for the
+	 * next frame, queues the finished one and starts another. While the
+	 * worker decodes a frame, readNextPacket() and the video track run on it,
+	 * so the audio tracks of the video have to take their data through
+	 * thread-safe streams, as the mixer already requires. When the backend
+	 * has no threads, decodeAhead() decodes the frames on the calling thread.
+	 *
+	 * This only works when a single video track is present, which is meant to
+	 * be a FixedRateVideoTrack. Frames are only decoded ahead while playing
+	 * forward, and seeking, rewinding or reversing the video drops them.
+	 *
+	 * This should be called after loadStream(), but before a decodeNextFrame()
+	 * call. This is enforced.
+	 *
+	 * @param depth The number of frames to decode ahead, or 0 to disable
+	 * @return true on success, false otherwise
+	 */
+	bool setDecodeAheadDepth(uint depth);
+
+	/**
+	 * Decode frames ahead of time, until the ring of frames is full or the
+	 * given amount of milliseconds has passed. With a worker thread, this
+	 * only queues the frame it has finished and starts the next one, without
+	 * waiting.
+	 *
+	 * @see setDecodeAheadDepth()
+	 * @param maxMillis The time after which no new frame is started
+	 * @return whether any frame was started
+	 */
+	bool decodeAhead(uint32 maxMillis);
+
 	/**
 	 * Set the accuracy of the video decoder
 	 */
@@ -999,6 +1037,12 @@ private:
 	// Enforcement of not being able to set dither or set the default format
 	bool _canSetDither;
 	bool _canSetDefaultFormat;
+	bool _canSetDecodeAheadDepth;
+
+	// Frames decoded ahead of time, see setDecodeAheadDepth()
+	class DecodeAheadVideoTrack;
+	DecodeAheadVideoTrack *_decodeAheadTrack;
+	void destroyDecodeAheadTrack();
 
 protected:
 	// Internal helper functions